@@ -0,0 +1,130 @@
+#include "MapGenerator.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+
+#include "geom/AABB.hpp"
+
+const char* mapKindName(MapKind kind) {
+  switch (kind) {
+    case MapKind::RandomBoxes:  return "random_boxes";
+    case MapKind::Corridors:    return "corridors";
+    case MapKind::DenseClutter: return "dense_clutter";
+  }
+  return "unknown";
+}
+
+namespace {
+
+void addRandomBoxes(Map& map, const MapGenParams& p, std::mt19937_64& rng) {
+  std::uniform_real_distribution<double> pos(0.0, p.worldSize);
+  std::uniform_real_distribution<double> size(0.3, 3.0);
+
+  for (int i = 0; i < p.obstacleCount; ++i) {
+    const double x = pos(rng);
+    const double y = pos(rng);
+    const double w = size(rng);
+    const double h = size(rng);
+    map.addObstacle(AABB{Vec2{x, y},
+                         Vec2{std::min(x + w, p.worldSize), std::min(y + h, p.worldSize)}});
+  }
+}
+
+// Alternating horizontal and vertical walls on a coarse lattice, each split by
+// a door gap, until the obstacle budget is spent.
+void addCorridors(Map& map, const MapGenParams& p, std::mt19937_64& rng) {
+  const double thickness = 0.4;
+  const double door = 1.5;
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  // Every lane is one wall split into two segments by its door
+  const int lanes = (p.obstacleCount + 1) / 2;
+  const int hLanes = (lanes + 1) / 2;
+  const int vLanes = lanes - hLanes;
+
+  int placed = 0;
+  for (int lane = 0; lane < lanes; ++lane) {
+    const bool horizontal = lane < hLanes;
+    const int idx = horizontal ? lane : lane - hLanes;
+    const int count = horizontal ? hLanes : vLanes;
+    const double c = p.worldSize * static_cast<double>(idx + 1) / static_cast<double>(count + 1);
+
+    const double gap = door + unit(rng) * (p.worldSize - 2.0 * door);
+    const double a0 = 0.0;
+    const double a1 = gap;
+    const double b0 = std::min(p.worldSize, gap + door);
+    const double b1 = p.worldSize;
+
+    for (auto [lo, hi] : {std::pair{a0, a1}, std::pair{b0, b1}}) {
+      if (placed >= p.obstacleCount || hi - lo <= 0.0) continue;
+      if (horizontal) {
+        map.addObstacle(AABB{Vec2{lo, c}, Vec2{hi, c + thickness}});
+      } else {
+        map.addObstacle(AABB{Vec2{c, lo}, Vec2{c + thickness, hi}});
+      }
+      placed++;
+    }
+  }
+}
+
+void addDenseClutter(Map& map, const MapGenParams& p, std::mt19937_64& rng) {
+  // Crates on a jittered lattice covering the whole world
+  std::uniform_real_distribution<double> jitter(-0.2, 0.2);
+  std::uniform_real_distribution<double> size(0.2, 0.8);
+
+  int side = 1;
+  while (side * side < p.obstacleCount) side++;
+  const double pitch = p.worldSize / static_cast<double>(side);
+
+  int placed = 0;
+  for (int iy = 0; iy < side && placed < p.obstacleCount; ++iy) {
+    for (int ix = 0; ix < side && placed < p.obstacleCount; ++ix) {
+      const double cx = (ix + 0.5) * pitch + jitter(rng) * pitch;
+      const double cy = (iy + 0.5) * pitch + jitter(rng) * pitch;
+      const double hs = 0.5 * size(rng) * std::min(1.0, pitch);
+      map.addObstacle(AABB{Vec2{cx - hs, cy - hs}, Vec2{cx + hs, cy + hs}});
+      placed++;
+    }
+  }
+}
+
+Vec2 freePosition(const Map& map, double radius, std::mt19937_64& rng) {
+  const AABB& w = map.worldBounds();
+  std::uniform_real_distribution<double> px(w.min.x + radius, w.max.x - radius);
+  std::uniform_real_distribution<double> py(w.min.y + radius, w.max.y - radius);
+
+  for (int attempt = 0; attempt < 10000; ++attempt) {
+    const Vec2 p{px(rng), py(rng)};
+    if (!map.collidesCircleAt(p, radius)) return p;
+  }
+  return Vec2{px(rng), py(rng)};
+}
+
+} // anonymous namespace
+
+Map MapGenerator::generate(const MapGenParams& params) const {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0, 0}, Vec2{params.worldSize, params.worldSize}});
+
+  std::mt19937_64 rng(params.seed);
+  switch (params.kind) {
+    case MapKind::RandomBoxes:  addRandomBoxes(map, params, rng); break;
+    case MapKind::Corridors:    addCorridors(map, params, rng); break;
+    case MapKind::DenseClutter: addDenseClutter(map, params, rng); break;
+  }
+  return map;
+}
+
+Scene MapGenerator::generateScene(const MapGenParams& params) const {
+  Scene scene;
+  scene.map = generate(params);
+
+  std::mt19937_64 rng(params.seed ^ 0x9e3779b97f4a7c15ULL);
+
+  scene.self.pos = freePosition(scene.map, scene.self.radius, rng);
+  scene.self.facing = Vec2{1, 0};
+  scene.enemy.pos = freePosition(scene.map, scene.enemy.radius, rng);
+  scene.enemy.facing = Vec2{-1, 0};
+  return scene;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "core/Scene.hpp"
+
+// Procedural map families used by the benchmark sweeps.
+enum class MapKind {
+  RandomBoxes,  // uniformly scattered boxes of mixed sizes
+  Corridors,    // long walls with door gaps, like a building floor
+  DenseClutter  // many small crates packed tightly
+};
+
+const char* mapKindName(MapKind kind);
+
+struct MapGenParams {
+  MapKind kind = MapKind::RandomBoxes;
+  int obstacleCount = 64;
+  double worldSize = 50.0;
+  std::uint64_t seed = 1;
+};
+
+// Deterministic for a given parameter set, so runs are comparable across builds.
+class MapGenerator {
+public:
+  Map generate(const MapGenParams& params) const;
+
+  // Scene on the generated map with both agents placed on free positions.
+  Scene generateScene(const MapGenParams& params) const;
+};
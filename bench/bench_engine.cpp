@@ -0,0 +1,552 @@
+// Engine benchmark suite.
+//
+//   bench_engine [--quick] [--out results.json]
+//
+// Runs microbenchmarks of the geometry primitives and analyzers, then sweeps
+// SceneAnalyzer over obstacle count, cellSize, T and visibilitySamples on
+// procedural maps. Results are written as JSON (stdout by default).
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "MapGenerator.hpp"
+#include "analysis/AcquisitionAnalyzer.hpp"
+#include "analysis/BatchAggregator.hpp"
+#include "analysis/EnemyBelief.hpp"
+#include "analysis/ExposureAnalyzer.hpp"
+#include "analysis/MutualVisibilityAnalyzer.hpp"
+#include "analysis/ParameterSweep.hpp"
+#include "analysis/PositionOptimizer.hpp"
+#include "analysis/ReachabilityAnalyzer.hpp"
+#include "analysis/SceneAnalyzer.hpp"
+#include "analysis/VisibilityAnalyzer.hpp"
+#include "core/AllocationStats.hpp"
+#include "core/CoverIndex.hpp"
+#include "core/DistanceField.hpp"
+#include "geom/Raycast.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+// Keeps results observable so the optimiser cannot drop the benchmarked work.
+volatile std::uint64_t gSink = 0;
+
+struct BenchConfig {
+  double minTimeMs = 200.0;
+  int minIterations = 3;
+};
+
+json allocToJson(const AllocationCounters& a) {
+  return {{"allocations", a.allocations}, {"bytes", a.bytes}, {"peak_bytes", a.peakBytes}};
+}
+
+// Repeats `body` until both the time and iteration floors are met.
+// `opsPerCall` lets one call stand for a batch of primitive queries.
+json runBench(const BenchConfig& cfg,
+              const std::string& group,
+              const std::string& name,
+              json params,
+              std::uint64_t opsPerCall,
+              const std::function<std::uint64_t()>& body)
+{
+  using Clock = std::chrono::steady_clock;
+
+  gSink = gSink + body(); // warm-up
+
+  // One call under an allocation scope, so allocation regressions show up
+  // next to timing ones (ENGINE_STATS builds only).
+  json alloc;
+  if (kAllocationTracking) {
+    AllocationScope scope;
+    gSink = gSink + body();
+    alloc = allocToJson(scope.counters());
+  }
+
+  std::uint64_t iterations = 0;
+  const auto start = Clock::now();
+  double elapsedMs = 0.0;
+  while (iterations < static_cast<std::uint64_t>(cfg.minIterations) || elapsedMs < cfg.minTimeMs) {
+    gSink = gSink + body();
+    iterations++;
+    elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+
+  const double ops = static_cast<double>(iterations * opsPerCall);
+  json out;
+  out["group"] = group;
+  out["name"] = name;
+  out["params"] = std::move(params);
+  out["iterations"] = iterations;
+  out["ops"] = iterations * opsPerCall;
+  out["total_ms"] = elapsedMs;
+  out["ns_per_op"] = (elapsedMs * 1e6) / ops;
+  out["ops_per_sec"] = ops / (elapsedMs / 1e3);
+  if (!alloc.is_null()) out["alloc_per_call"] = std::move(alloc);
+
+  std::cerr << group << "/" << name << " " << out["params"].dump()
+            << ": " << out["ns_per_op"].get<double>() << " ns/op\n";
+  return out;
+}
+
+struct Segment { Vec2 a; Vec2 b; };
+
+std::vector<Segment> randomSegments(const AABB& world, int n, std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> px(world.min.x, world.max.x);
+  std::uniform_real_distribution<double> py(world.min.y, world.max.y);
+
+  std::vector<Segment> segs;
+  segs.reserve(n);
+  for (int i = 0; i < n; ++i) segs.push_back({Vec2{px(rng), py(rng)}, Vec2{px(rng), py(rng)}});
+  return segs;
+}
+
+json workToJson(const WorkCounters& w) {
+  return {{"los_queries", w.losQueries}, {"box_tests", w.boxTests},
+          {"collision_queries", w.collisionQueries}};
+}
+
+// Per-stage breakdown of one analysis; empty unless built with ENGINE_STATS.
+json statsToJson(const AnalysisStats& stats) {
+  if (!stats.enabled) return json::object();
+  auto stage = [](const StageStats& st) {
+    return json{{"wall_ms", st.wallMs}, {"work", workToJson(st.work)}, {"alloc", allocToJson(st.alloc)}};
+  };
+  return {{"reachability", stage(stats.reachability)},
+          {"exposure", stage(stats.exposure)},
+          {"visibility", stage(stats.visibility)},
+          {"total_ms", stats.totalMs},
+          {"reachable_cells", stats.reachableCells},
+          {"alloc", allocToJson(stats.alloc)}};
+}
+
+const MapKind kAllKinds[] = {MapKind::RandomBoxes, MapKind::Corridors, MapKind::DenseClutter};
+
+void microBenchmarks(const BenchConfig& cfg, bool quick, json& results) {
+  MapGenerator gen;
+  const int queries = 1024;
+
+  // segmentIntersectsAABB in isolation, against a fixed box
+  {
+    const AABB box{Vec2{20, 20}, Vec2{30, 30}};
+    const auto segs = randomSegments(AABB{Vec2{0,0}, Vec2{50,50}}, queries, 7);
+    results.push_back(runBench(cfg, "micro", "segmentIntersectsAABB", json::object(), queries, [&] {
+      std::uint64_t hits = 0;
+      for (const auto& s : segs) hits += segmentIntersectsAABB(s.a, s.b, box) ? 1 : 0;
+      return hits;
+    }));
+  }
+
+  const std::vector<int> counts = quick ? std::vector<int>{16, 256}
+                                        : std::vector<int>{16, 64, 256, 1024};
+
+  for (MapKind kind : kAllKinds) {
+    for (int count : counts) {
+      MapGenParams mp;
+      mp.kind = kind;
+      mp.obstacleCount = count;
+      const Map map = gen.generate(mp);
+      const auto segs = randomSegments(map.worldBounds(), queries, 11);
+
+      const json params = {{"map", mapKindName(kind)}, {"obstacles", count}};
+
+      results.push_back(runBench(cfg, "micro", "hasLineOfSight", params, queries, [&] {
+        std::uint64_t visible = 0;
+        for (const auto& s : segs) visible += map.hasLineOfSight(s.a, s.b) ? 1 : 0;
+        return visible;
+      }));
+
+      results.push_back(runBench(cfg, "micro", "collidesCircleAt", params, queries, [&] {
+        std::uint64_t hits = 0;
+        for (const auto& s : segs) hits += map.collidesCircleAt(s.a, 0.25) ? 1 : 0;
+        return hits;
+      }));
+
+      // Copies share the map snapshot, so this should not grow with `count`
+      Scene scene;
+      scene.map = map;
+      results.push_back(runBench(cfg, "micro", "Scene copy", params, 1, [&] {
+        const Scene copy = scene;
+        return static_cast<std::uint64_t>(copy.map.obstacles().size());
+      }));
+
+      // The viewer's FOV cone: 61 rays over 90 degrees, range 8, per origin
+      const int fans = 16;
+      const int fanRays = 61;
+      results.push_back(runBench(cfg, "micro", "raycast (per ray)", params, fans * fanRays, [&] {
+        double sum = 0.0;
+        for (int i = 0; i < fans; ++i) {
+          const double base = std::atan2(segs[i].b.y - segs[i].a.y, segs[i].b.x - segs[i].a.x);
+          for (int r = 0; r < fanRays; ++r) {
+            const double a = base - M_PI / 4 + (M_PI / 2) * r / (fanRays - 1);
+            sum += map.raycast(segs[i].a, Vec2{std::cos(a), std::sin(a)}, 8.0).distance;
+          }
+        }
+        return static_cast<std::uint64_t>(sum);
+      }));
+      results.push_back(runBench(cfg, "micro", "fanCast", params, fans * fanRays, [&] {
+        double sum = 0.0;
+        for (int i = 0; i < fans; ++i) {
+          const double base = std::atan2(segs[i].b.y - segs[i].a.y, segs[i].b.x - segs[i].a.x);
+          for (const RayHit& h : map.fanCast(segs[i].a, base - M_PI / 4, base + M_PI / 4, fanRays, 8.0)) {
+            sum += h.distance;
+          }
+        }
+        return static_cast<std::uint64_t>(sum);
+      }));
+
+      const auto sdf = DistanceField::build(map, 0.1);
+      results.push_back(runBench(cfg, "micro", "DistanceField::collidesCircle", params, queries, [&] {
+        std::uint64_t hits = 0;
+        for (const auto& s : segs) hits += sdf->collidesCircle(s.a, 0.25) ? 1 : 0;
+        return hits;
+      }));
+    }
+  }
+
+  // Analyzers on a mid-sized map with a longer window, so each stage has real work
+  for (MapKind kind : kAllKinds) {
+    MapGenParams mp;
+    mp.kind = kind;
+    mp.obstacleCount = 256;
+    Scene scene = gen.generateScene(mp);
+    scene.T = 1.0;
+    scene.cellSize = 0.25;
+
+    const json params = {{"map", mapKindName(kind)}, {"obstacles", mp.obstacleCount},
+                         {"T", scene.T}, {"cellSize", scene.cellSize},
+                         {"visibilitySamples", scene.visibilitySamples}};
+
+    ReachabilityAnalyzer reach;
+    ExposureAnalyzer exposure;
+    VisibilityAnalyzer visibility;
+    const auto reachable = reach.analyze(scene);
+
+    results.push_back(runBench(cfg, "analyzer", "ReachabilityAnalyzer", params, 1, [&] {
+      return static_cast<std::uint64_t>(reach.analyze(scene).reachableSelf.size());
+    }));
+    results.push_back(runBench(cfg, "analyzer", "ExposureAnalyzer", params, 1, [&] {
+      return static_cast<std::uint64_t>(exposure.analyze(scene, reachable.reachableEnemy).losCount);
+    }));
+    results.push_back(runBench(cfg, "analyzer", "ExposureAnalyzer::profile", params, 1, [&] {
+      return static_cast<std::uint64_t>(exposure.profile(scene, reachable.reachableEnemy).pieces.size());
+    }));
+    results.push_back(runBench(cfg, "analyzer", "ExposureAnalyzer x360 facings", params, 1, [&] {
+      Scene turned = scene;
+      std::uint64_t los = 0;
+      for (int deg = 0; deg < 360; ++deg) {
+        const double a = deg * 3.14159265358979323846 / 180.0;
+        turned.self.facing = Vec2{std::cos(a), std::sin(a)};
+        los += static_cast<std::uint64_t>(exposure.analyze(turned, reachable.reachableEnemy).losCount);
+      }
+      return los;
+    }));
+    results.push_back(runBench(cfg, "analyzer", "AcquisitionAnalyzer", params, 1, [&] {
+      return static_cast<std::uint64_t>(AcquisitionAnalyzer().analyze(scene, reachable.reachableEnemy).visibleCount);
+    }));
+    results.push_back(runBench(cfg, "analyzer", "VisibilityAnalyzer", params, 1, [&] {
+      return static_cast<std::uint64_t>(visibility.analyze(scene, scene.self.pos, scene.enemy).visibleCount);
+    }));
+
+    // Self walking straight at the enemy: one sweep vs 200 point samples.
+    {
+      const std::vector<Vec2> path{scene.self.pos, scene.self.pos + (scene.enemy.pos - scene.self.pos) * 0.5};
+      const double speed = scene.self.speed;
+      json swept = runBench(cfg, "analyzer", "VisibilityAnalyzer::sweep", params, 1, [&] {
+        return static_cast<std::uint64_t>(visibility.sweep(scene, path, speed, scene.enemy).events.size());
+      });
+      swept["events"] = visibility.sweep(scene, path, speed, scene.enemy).events.size();
+      results.push_back(swept);
+      results.push_back(runBench(cfg, "analyzer", "VisibilityAnalyzer x200 path points", params, 1, [&] {
+        std::uint64_t visible = 0;
+        for (int i = 0; i < 200; ++i) {
+          const Vec2 p = path[0] + (path[1] - path[0]) * (i / 199.0);
+          visible += static_cast<std::uint64_t>(visibility.analyze(scene, p, scene.enemy).visibleCount);
+        }
+        return visible;
+      }));
+    }
+
+    // Pairwise LoS between the two reachable sets, at a coarser grid so the
+    // brute-force reference stays affordable.
+    {
+      Scene coarse = scene;
+      coarse.cellSize = 0.5;
+      const auto sets = reach.analyze(coarse);
+      json mparams = params;
+      mparams["cellSize"] = coarse.cellSize;
+      const auto pairs = static_cast<std::uint64_t>(sets.reachableSelf.size() * sets.reachableEnemy.size());
+
+      MutualVisibilityAnalyzer mutual;
+      json entry = runBench(cfg, "analyzer", "MutualVisibilityAnalyzer", mparams, 1, [&] {
+        return mutual.analyze(coarse, sets).visiblePairs;
+      });
+      const auto mr = mutual.analyze(coarse, sets);
+      entry["pairs"] = pairs;
+      entry["los_tests"] = mr.losTests;
+      results.push_back(entry);
+
+      if (!quick) {
+        results.push_back(runBench(cfg, "analyzer", "mutual visibility brute force", mparams, 1, [&] {
+          std::uint64_t visible = 0;
+          for (const auto& a : sets.reachableSelf) {
+            for (const auto& b : sets.reachableEnemy) visible += coarse.map.hasLineOfSight(a, b) ? 1 : 0;
+          }
+          return visible;
+        }));
+      }
+    }
+
+    // Approximate modes; the entries record how many draws the tolerance needed.
+    const SamplingTolerance tol;
+    json reachEst = runBench(cfg, "analyzer", "ReachabilityAnalyzer::estimateAreaRatio", params, 1, [&] {
+      return static_cast<std::uint64_t>(reach.estimateAreaRatio(scene, tol).samples);
+    });
+    const auto re = reach.estimateAreaRatio(scene, tol);
+    reachEst["samples"] = re.samples;
+    reachEst["population"] = re.population;
+    reachEst["error_bound"] = re.errorBound;
+    results.push_back(reachEst);
+
+    json visEst = runBench(cfg, "analyzer", "VisibilityAnalyzer::estimate", params, 1, [&] {
+      return static_cast<std::uint64_t>(visibility.estimate(scene, scene.self.pos, scene.enemy, tol).samples);
+    });
+    const auto ve = visibility.estimate(scene, scene.self.pos, scene.enemy, tol);
+    visEst["samples"] = ve.samples;
+    visEst["population"] = ve.population;
+    visEst["error_bound"] = ve.errorBound;
+    results.push_back(visEst);
+  }
+}
+
+// Best-position search over the whole map; the entry also records how many
+// candidates branch-and-bound actually had to score.
+void searchBenchmarks(const BenchConfig& cfg, bool quick, json& results) {
+  MapGenerator gen;
+  PositionOptimizer optimizer;
+
+  for (MapKind kind : kAllKinds) {
+    MapGenParams mp;
+    mp.kind = kind;
+    mp.obstacleCount = 256;
+    Scene scene = gen.generateScene(mp);
+
+    PositionQuery query;
+    query.spacing = quick ? 2.0 : 1.0;
+    query.topK = 5;
+
+    const json params = {{"map", mapKindName(kind)}, {"obstacles", mp.obstacleCount},
+                         {"spacing", query.spacing}, {"topK", query.topK}};
+
+    // Nearest cover: indexed lookup vs. scanning the reachable cells
+    const auto cover = CoverIndex::build(scene.map, scene.self.radius);
+    Scene wide = scene;
+    wide.T = 1.0;
+    results.push_back(runBench(cfg, "search", "CoverIndex::nearestHidden",
+                               {{"map", mapKindName(kind)}, {"obstacles", mp.obstacleCount}, {"T", wide.T}}, 1, [&] {
+      return static_cast<std::uint64_t>(cover->nearestHidden(wide, 1).size());
+    }));
+    results.push_back(runBench(cfg, "search", "reachableSelf LoS scan",
+                               {{"map", mapKindName(kind)}, {"obstacles", mp.obstacleCount}, {"T", wide.T}}, 1, [&] {
+      ReachabilityAnalyzer reach;
+      const auto cells = reach.analyze(wide).reachableSelf;
+      std::uint64_t hidden = 0;
+      for (const auto& c : cells) hidden += wide.map.hasLineOfSight(wide.enemy.pos, c) ? 0 : 1;
+      return hidden;
+    }));
+
+    json entry = runBench(cfg, "search", "PositionOptimizer", params, 1, [&] {
+      return static_cast<std::uint64_t>(optimizer.search(scene, query).evaluated);
+    });
+    const auto res = optimizer.search(scene, query);
+    entry["candidates"] = res.candidates;
+    entry["evaluated"] = res.evaluated;
+    results.push_back(std::move(entry));
+  }
+}
+
+// A 64-tick second of fog-of-war tracking with self strafing, so each tick
+// both spreads the belief and re-tests some visibility.
+void beliefBenchmarks(const BenchConfig& cfg, bool quick, json& results) {
+  MapGenerator gen;
+  const std::vector<double> cells = quick ? std::vector<double>{0.5} : std::vector<double>{1.0, 0.5, 0.25};
+
+  for (MapKind kind : kAllKinds) {
+    for (double cell : cells) {
+      MapGenParams mp;
+      mp.kind = kind;
+      mp.obstacleCount = 256;
+      const Scene scene = gen.generateScene(mp);
+
+      const json params = {{"map", mapKindName(kind)}, {"obstacles", mp.obstacleCount},
+                           {"cellSize", cell}, {"ticks", 64}};
+
+      results.push_back(runBench(cfg, "stream", "EnemyBelief::tick", params, 64, [&] {
+        EnemyBelief belief(scene.map, scene.enemy, cell);
+        belief.observe(scene.enemy.pos);
+        std::uint64_t checks = 0;
+        for (int t = 0; t < 64; ++t) {
+          const Vec2 self = scene.self.pos + Vec2{(t / 8) * 0.25, 0.0};
+          checks += static_cast<std::uint64_t>(belief.tick(1.0 / 64.0, self).losChecks);
+        }
+        return checks;
+      }));
+    }
+  }
+}
+
+// A 64-combination sensitivity grid, swept vs one analyze() per cell.
+void parameterSweepBenchmarks(const BenchConfig& cfg, json& results) {
+  MapGenerator gen;
+  MapGenParams mp;
+  mp.obstacleCount = 256;
+  const Scene base = gen.generateScene(mp);
+
+  SweepAxes axes;
+  axes.T = {0.25, 0.5, 0.75, 1.0};
+  axes.cellSize = {0.5, 0.25};
+  axes.selfSpeed = {3.0, 5.0};
+  axes.enemySpeed = {3.0, 5.0};
+  axes.visibilitySamples = {32, 64};
+  const json params = {{"map", mapKindName(mp.kind)}, {"obstacles", mp.obstacleCount}, {"combinations", 64}};
+
+  ParameterSweep sweep;
+  results.push_back(runBench(cfg, "scene", "ParameterSweep", params, 64, [&] {
+    return static_cast<std::uint64_t>(sweep.run(base, axes).cells.size());
+  }));
+
+  SceneAnalyzer analyzer;
+  results.push_back(runBench(cfg, "scene", "SceneAnalyzer per combination", params, 64, [&] {
+    std::uint64_t n = 0;
+    Scene s = base;
+    for (double t : axes.T)
+      for (double c : axes.cellSize)
+        for (double vs : axes.selfSpeed)
+          for (double ve : axes.enemySpeed)
+            for (int k : axes.visibilitySamples) {
+              s.T = t;
+              s.cellSize = c;
+              s.self.speed = vs;
+              s.enemy.speed = ve;
+              s.visibilitySamples = k;
+              n += analyzer.analyze(s).reachability.reachableSelf.size();
+            }
+    return n;
+  }));
+}
+
+// Folding results into a summary, per result.
+void aggregateBenchmarks(const BenchConfig& cfg, json& results) {
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::vector<AnalysisResult> batch(4096);
+  for (auto& r : batch) {
+    r.reachability.areaRatio = 2.0 * u(rng);
+    r.exposure.width = 8.0 * u(rng);
+    r.visibility.visibleFraction = u(rng);
+  }
+
+  ResultSummary summary;
+  results.push_back(runBench(cfg, "stream", "ResultSummary::add", {{"results", batch.size()}},
+                             batch.size(), [&] {
+    for (const auto& r : batch) summary.add(r);
+    return summary.areaRatio.count();
+  }));
+}
+
+// One-axis-at-a-time sweeps around a base scene, so each curve isolates one
+// scaling parameter.
+void sceneSweeps(const BenchConfig& cfg, bool quick, json& results) {
+  MapGenerator gen;
+  SceneAnalyzer analyzer;
+
+  const std::vector<int> counts = quick ? std::vector<int>{0, 64, 512}
+                                        : std::vector<int>{0, 16, 64, 256, 1024, 4096};
+  const std::vector<double> cellSizes = quick ? std::vector<double>{0.5, 0.1}
+                                              : std::vector<double>{1.0, 0.5, 0.25, 0.1};
+  const std::vector<double> windows = quick ? std::vector<double>{0.3, 2.0}
+                                            : std::vector<double>{0.3, 0.6, 1.0, 2.0};
+  const std::vector<int> samples = quick ? std::vector<int>{16, 256}
+                                         : std::vector<int>{16, 64, 256, 1024};
+
+  for (MapKind kind : kAllKinds) {
+    auto bench = [&](int count, double cellSize, double T, int vis) {
+      MapGenParams mp;
+      mp.kind = kind;
+      mp.obstacleCount = count;
+      Scene scene = gen.generateScene(mp);
+      scene.cellSize = cellSize;
+      scene.T = T;
+      scene.visibilitySamples = vis;
+
+      const json params = {{"map", mapKindName(kind)}, {"obstacles", count},
+                           {"cellSize", cellSize}, {"T", T}, {"visibilitySamples", vis}};
+
+      json entry = runBench(cfg, "scene", "SceneAnalyzer", params, 1, [&] {
+        return static_cast<std::uint64_t>(analyzer.analyze(scene).exposure.losCount);
+      });
+      entry["stats"] = statsToJson(analyzer.analyze(scene).stats);
+      results.push_back(std::move(entry));
+    };
+
+    for (int count : counts)      bench(count, 0.5, 0.3, 64);
+    for (double cs : cellSizes)   bench(256, cs, 0.3, 64);
+    for (double T : windows)      bench(256, 0.5, T, 64);
+    for (int vis : samples)       bench(256, 0.5, 0.3, vis);
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+  bool quick = false;
+  std::string outPath;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--quick") == 0) {
+      quick = true;
+    } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      outPath = argv[++i];
+    } else {
+      std::cerr << "usage: bench_engine [--quick] [--out results.json]\n";
+      return 2;
+    }
+  }
+
+  BenchConfig cfg;
+  if (quick) {
+    cfg.minTimeMs = 20.0;
+    cfg.minIterations = 1;
+  }
+
+  json report;
+  report["schema"] = "fps-bench/1";
+  report["quick"] = quick;
+  report["results"] = json::array();
+
+  microBenchmarks(cfg, quick, report["results"]);
+  searchBenchmarks(cfg, quick, report["results"]);
+  beliefBenchmarks(cfg, quick, report["results"]);
+  aggregateBenchmarks(cfg, report["results"]);
+  parameterSweepBenchmarks(cfg, report["results"]);
+  sceneSweeps(cfg, quick, report["results"]);
+
+  if (outPath.empty()) {
+    std::cout << report.dump(2) << "\n";
+  } else {
+    std::ofstream out(outPath);
+    out << report.dump(2) << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,159 @@
+// Offline replay of a TraceRecorder capture.
+//
+//   trace_replay TRACE [--threads N] [--repeat R]
+//
+// Re-executes every recorded call against the recorded maps, checks that the
+// results still match, and prints per-kind latency percentiles and log2
+// histograms for the recorded and the replayed timings. Calls are handed out
+// to the N replay threads from one shared queue in recorded order.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "core/TraceRecorder.hpp"
+
+namespace {
+
+constexpr int kBuckets = 40; // [2^i, 2^(i+1)) ns
+
+const char* kindName(TraceCall::Kind kind) {
+  switch (kind) {
+    case TraceCall::LineOfSight: return "hasLineOfSight";
+    case TraceCall::Collision: return "collidesCircleAt";
+    case TraceCall::Analyze: return "analyze";
+  }
+  return "?";
+}
+
+int bucketOf(std::uint64_t ns) {
+  int b = 0;
+  while (ns > 1 && b < kBuckets - 1) { ns >>= 1; ++b; }
+  return b;
+}
+
+std::uint64_t percentile(std::vector<std::uint64_t>& v, double q) {
+  if (v.empty()) return 0;
+  const auto k = static_cast<std::size_t>(q * static_cast<double>(v.size() - 1));
+  std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+  return v[k];
+}
+
+// Runs one call; false if its result differs from the recorded one.
+bool replay(const TraceFile& trace, const TraceCall& call) {
+  switch (call.kind) {
+    case TraceCall::LineOfSight:
+      return trace.maps[call.map].hasLineOfSight(call.a, call.b) == call.result;
+    case TraceCall::Collision:
+      return trace.maps[call.map].collidesCircleAt(call.a, call.radius) == call.result;
+    case TraceCall::Analyze: {
+      const AnalysisResult r = SceneAnalyzer().analyze(trace.scenes[call.scene]);
+      return r.reachability.areaRatio == call.metrics[0] &&
+             r.exposure.width == call.metrics[1] &&
+             r.visibility.visibleFraction == call.metrics[2];
+    }
+  }
+  return false;
+}
+
+void printHistogram(const char* label, const std::vector<std::uint64_t>& samples) {
+  std::uint64_t counts[kBuckets] = {};
+  for (std::uint64_t ns : samples) ++counts[bucketOf(ns)];
+  const std::uint64_t peak = *std::max_element(std::begin(counts), std::end(counts));
+  if (peak == 0) return;
+
+  std::cout << "  " << label << ":\n";
+  for (int b = 0; b < kBuckets; ++b) {
+    if (counts[b] == 0) continue;
+    const int bar = static_cast<int>((counts[b] * 40 + peak - 1) / peak);
+    std::cout << "    [" << std::setw(11) << (std::uint64_t{1} << b) << ", "
+              << std::setw(11) << (std::uint64_t{1} << (b + 1)) << ") ns "
+              << std::setw(9) << counts[b] << ' ' << std::string(static_cast<std::size_t>(bar), '#') << '\n';
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+  std::string path;
+  int threads = 1;
+  int repeat = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = std::max(1, std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (path.empty() && argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      path.clear();
+      break;
+    }
+  }
+  if (path.empty()) {
+    std::cerr << "usage: trace_replay TRACE [--threads N] [--repeat R]\n";
+    return 2;
+  }
+
+  TraceFile trace;
+  if (!trace.load(path)) {
+    std::cerr << "cannot read trace: " << path << "\n";
+    return 1;
+  }
+
+  const std::size_t n = trace.calls.size();
+  std::vector<std::uint64_t> replayed(n * static_cast<std::size_t>(repeat));
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::uint64_t> mismatches{0};
+
+  const std::uint64_t wallStart = TraceRecorder::nowNs();
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; ++t) {
+    pool.emplace_back([&] {
+      for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < replayed.size();) {
+        const TraceCall& call = trace.calls[i % n];
+        const std::uint64_t start = TraceRecorder::nowNs();
+        const bool ok = replay(trace, call);
+        replayed[i] = TraceRecorder::nowNs() - start;
+        if (!ok) mismatches.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (auto& th : pool) th.join();
+  const double wallMs = static_cast<double>(TraceRecorder::nowNs() - wallStart) / 1e6;
+
+  std::cout << "trace: " << path << "\n"
+            << "  maps " << trace.maps.size() << ", calls " << n
+            << ", threads " << threads << ", repeat " << repeat << "\n"
+            << "  wall " << std::fixed << std::setprecision(2) << wallMs << " ms, mismatches "
+            << mismatches.load() << "\n\n";
+
+  for (auto kind : {TraceCall::LineOfSight, TraceCall::Collision, TraceCall::Analyze}) {
+    std::vector<std::uint64_t> rec, rep;
+    for (std::size_t i = 0; i < replayed.size(); ++i) {
+      const TraceCall& call = trace.calls[i % n];
+      if (call.kind != kind) continue;
+      if (i < n) rec.push_back(call.durationNs);
+      rep.push_back(replayed[i]);
+    }
+    if (rec.empty()) continue;
+
+    std::cout << kindName(kind) << " (" << rec.size() << " calls)\n";
+    std::cout << "  p50/p90/p99 ns  recorded " << percentile(rec, 0.5) << " / "
+              << percentile(rec, 0.9) << " / " << percentile(rec, 0.99)
+              << "  replayed " << percentile(rep, 0.5) << " / "
+              << percentile(rep, 0.9) << " / " << percentile(rep, 0.99) << "\n";
+    printHistogram("recorded", rec);
+    printHistogram("replayed", rep);
+    std::cout << "\n";
+  }
+  return mismatches.load() == 0 ? 0 : 3;
+}
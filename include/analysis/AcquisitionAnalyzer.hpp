@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+
+#include "analysis/MetricSketch.hpp"
+#include "core/CancellationToken.hpp"
+#include "core/Scene.hpp"
+
+struct AcquisitionOptions {
+  double turnRateDegPerSec = 720.0; // how fast self can swing its aim
+};
+
+struct AcquisitionResult {
+  // Seconds self needs to turn from its facing onto each enemy point passed
+  // in (same order); -1 where self has no line of sight to the point.
+  std::vector<double> turnTime;
+
+  MetricSketch times{0.0, 1.0, 256}; // over visible points; range [0, pi / turn rate)
+  double worstAngle = 0.0;           // radians, in [0, pi]
+  double worstTime = 0.0;            // seconds
+  Vec2 worstPoint;                   // first visible point needing worstAngle
+  int visibleCount = 0;
+  int totalEnemyReachable = 0;
+  bool cancelled = false;
+};
+
+// Crosshair placement: how far self must turn to aim at each enemy position
+// it can see, as an angle and as time at a fixed turn rate.
+//
+// Line of sight from self is tested once per point (all points count, not
+// only those inside the field of view), unless losMask supplies it: pass the
+// mask ExposureAnalyzer::analyze filled for the same points to skip the
+// pass. A mask of the wrong size is ignored. The angle
+// kernel then runs over structure-of-arrays offsets without branches: it
+// compares cosines of the turn angle instead of atan2 angles, so the worst
+// case is a min-reduction, and acos is taken once per visible point for the
+// field.
+class AcquisitionAnalyzer {
+public:
+  AcquisitionResult analyze(const Scene& scene,
+                            const std::vector<Vec2>& enemyReachable,
+                            const AcquisitionOptions& options = {},
+                            const CancellationToken* cancel = nullptr,
+                            const std::vector<unsigned char>* losMask = nullptr) const;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+// Shared pieces of the approximate (early-terminating) analyzer modes.
+//
+// Each sampled quantity comes from a finite population (the N visibility
+// rays, or the lattice points of a movement disk). Samples are drawn without
+// replacement in a low-discrepancy order and the estimate stops as soon as its
+// confidence interval is narrow enough. Drawing the whole population gives
+// the exact answer with a zero-width interval.
+
+struct SamplingTolerance {
+  double halfWidth = 0.05; // stop once the interval is within +/- this of the estimate
+  double z = 1.96;         // normal quantile of the confidence level (1.96 ~ 95%)
+  int minSamples = 8;      // per population, before stopping is considered
+};
+
+struct SampledEstimate {
+  double value = 0.0;
+  double lower = 0.0;
+  double upper = 0.0;
+  double errorBound = 0.0; // max(value - lower, upper - value)
+  int samples = 0;         // draws made (collision or LoS tests)
+  int population = 0;      // draws the exact answer needs
+  bool cancelled = false;
+};
+
+// Wilson score interval for `hits` of `n` draws without replacement from
+// `population`; z is shrunk by the finite-population correction.
+void wilsonInterval(int hits, int n, int population, double z, double& lower, double& upper);
+
+// Stride s, coprime to n and close to n / golden ratio, so i -> (i * s) % n
+// visits 0..n-1 once each with every prefix spread over the whole range.
+int goldenStride(int n);
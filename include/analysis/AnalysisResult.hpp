@@ -5,6 +5,7 @@
 #include "analysis/ReachabilityAnalyzer.hpp"
 #include "analysis/ExposureAnalyzer.hpp"
 #include "analysis/VisibilityAnalyzer.hpp"
+#include "analysis/AnalysisStats.hpp"
 
 struct AnalysisResult {
   ReachabilityResult reachability;
@@ -12,4 +13,8 @@ struct AnalysisResult {
   VisibilityResult visibility;
 
   std::vector<std::string> explanations; // at least 2: mechanical + factual
+
+  AnalysisStats stats; // populated only in ENGINE_STATS builds
+
+  bool cancelled = false; // metrics are incomplete and must be discarded
 };
@@ -0,0 +1,28 @@
+#pragma once
+#include "core/AllocationStats.hpp"
+#include "core/EngineStats.hpp"
+
+struct StageStats {
+  double wallMs = 0.0;
+  WorkCounters work;
+  AllocationCounters alloc; // peak includes what the stage leaves in the result
+};
+
+// Filled by SceneAnalyzer only in FPS_ENGINE_STATS builds; otherwise left
+// zeroed with enabled == false.
+struct AnalysisStats {
+  bool enabled = false;
+
+  StageStats reachability;
+  StageStats exposure;
+  StageStats visibility;
+  double totalMs = 0.0;
+
+  int reachableCells = 0; // self + enemy
+
+  AllocationCounters alloc; // whole analyze(), explanations included
+
+  WorkCounters totalWork() const {
+    return reachability.work + exposure.work + visibility.work;
+  }
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "analysis/AnalysisResult.hpp"
+#include "analysis/SceneAnalyzer.hpp"
+#include "core/CancellationToken.hpp"
+#include "core/Scene.hpp"
+
+// Runs SceneAnalyzer on a dedicated thread for interactive callers.
+//
+// submit() hands over a scene snapshot and cancels whatever job is in flight,
+// so only the newest snapshot is ever finished. Completed results are
+// published under a lock and picked up with poll(); until then the caller
+// keeps showing its previous result.
+class AnalysisWorker {
+public:
+  AnalysisWorker();
+  ~AnalysisWorker();
+
+  AnalysisWorker(const AnalysisWorker&) = delete;
+  AnalysisWorker& operator=(const AnalysisWorker&) = delete;
+
+  void submit(Scene scene);
+
+  // Newest finished result not yet returned by poll(), if any.
+  std::optional<AnalysisResult> poll();
+
+  // True while a submitted snapshot has not been published yet.
+  bool pending() const;
+
+  // Blocks until every submitted snapshot has been published (tests, shutdown).
+  void waitIdle();
+
+private:
+  void run();
+
+  SceneAnalyzer analyzer_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+
+  std::optional<Scene> queued_;
+  std::shared_ptr<CancellationToken> inFlight_;
+  std::uint64_t submitted_ = 0;
+  std::uint64_t published_ = 0;
+
+  std::optional<AnalysisResult> ready_;
+  bool stop_ = false;
+
+  std::thread thread_;
+};
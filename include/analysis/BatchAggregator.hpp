@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis/AnalysisResult.hpp"
+#include "analysis/MetricSketch.hpp"
+
+// Distribution of each headline metric over many AnalysisResults.
+struct ResultSummary {
+  MetricSketch areaRatio{0.0, 4.0, 512};
+  MetricSketch exposureWidth{0.0, 32.0, 512};
+  MetricSketch visibleFraction{0.0, 1.0, 512};
+  MetricSketch totalMs{0.0, 100.0, 512}; // only results with stats enabled
+  MetricSketch peakKb{0.0, 4096.0, 512}; // per-analysis heap peak; stats only
+  std::uint64_t allocations = 0;         // summed over results with stats
+  std::uint64_t allocatedBytes = 0;
+  std::uint64_t cancelled = 0;           // counted, not sketched
+
+  void add(const AnalysisResult& result);
+  void merge(const ResultSummary& other);
+};
+
+// Streaming aggregation for batch runs: results are folded into summaries as
+// they arrive instead of being kept.
+//
+// Each worker thread owns one shard and adds to it without synchronisation;
+// once the workers are done, total() and byMap() merge the shards. Memory is
+// one ResultSummary (a few KB) per shard and map id, whatever the number of
+// results.
+class BatchAggregator {
+public:
+  class Shard {
+  public:
+    // `mapId` groups results for byMap(); empty means ungrouped.
+    void add(const AnalysisResult& result, const std::string& mapId = {});
+
+  private:
+    friend class BatchAggregator;
+    ResultSummary all_;
+    std::unordered_map<std::string, ResultSummary> byMap_;
+  };
+
+  explicit BatchAggregator(int shards);
+
+  int shards() const { return static_cast<int>(shards_.size()); }
+
+  // Shard i must be used by one thread at a time.
+  Shard& shard(int i) { return *shards_[static_cast<std::size_t>(i)]; }
+
+  // Call only while no shard is being added to.
+  ResultSummary total() const;
+  std::map<std::string, ResultSummary> byMap() const;
+
+private:
+  // Separately allocated, so shards on different threads do not share
+  // cache lines.
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+#include "core/Scene.hpp"
+
+struct DuelOptions {
+  int rollouts = 100000;
+  int subSteps = 16;             // LoS checks per fight window T
+
+  double selfReaction = 0.20;    // seconds from first mutual sight to shot
+  double enemyReaction = 0.20;
+  double reactionJitter = 0.05;  // each reaction drawn uniformly in +/- this
+  double tradeWindow = 0.05;     // shots closer than this count as a trade
+
+  std::uint64_t seed = 1;
+  int threads = 0;               // 0 = hardware concurrency
+};
+
+struct DuelResult {
+  int rollouts = 0;
+  int selfWins = 0;
+  int enemyWins = 0;
+  int trades = 0;
+  int noContact = 0;
+  int unresolved = 0; // contact, but neither shot landed
+
+  double selfWinRate = 0.0;
+  double enemyWinRate = 0.0;
+  double tradeRate = 0.0;
+  double noContactRate = 0.0;
+  double unresolvedRate = 0.0;
+  double meanContactTime = 0.0; // over rollouts with contact
+};
+
+// Monte Carlo peek duel on top of the static metrics.
+//
+// Each rollout moves both agents in a straight line, at constant velocity
+// over the window T, from their position to a destination drawn from their
+// ReachabilityAnalyzer set, and checks mutual LoS at every sub-step. At first
+// sight each side fires after its (jittered) reaction time. A shot lands only
+// if it is fired within T and the agents, still moving, see each other at
+// that moment. The earlier landing shot wins unless both land within
+// tradeWindow of each other; if neither lands the rollout is unresolved.
+//
+// Random numbers come from a counter-based generator keyed by (seed, rollout),
+// so results are bit-identical for any thread count. Rollouts are advanced in
+// lanes through Map::hasLineOfSightBatch.
+class DuelSimulator {
+public:
+  DuelResult simulate(const Scene& scene, const DuelOptions& options = {}) const;
+};
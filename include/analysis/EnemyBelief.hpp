@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "core/Agent.hpp"
+#include "core/Map.hpp"
+
+struct BeliefTick {
+  int spreadSteps = 0;     // one-cell diffusion steps applied this tick
+  int losChecks = 0;       // new cell visibility tests (the rest were cached)
+  double prunedMass = 0.0; // probability that self would have seen the enemy
+  bool contradiction = false; // everything was pruned; belief reset to uniform
+};
+
+// Fog-of-war belief over where an unseen enemy is.
+//
+// Holds an occupancy probability per grid cell (cells whose centre collides
+// with the enemy's radius never hold mass). Each tick:
+//  1. spread: speed * dt worth of one-cell lazy random-walk steps; mass only
+//     moves between free 4-neighbours, so it never crosses an obstacle and
+//     its support never outruns the enemy's speed;
+//  2. prune: cells whose centre has line of sight from self are zeroed (had
+//     the enemy been there, self would see it) and the rest renormalized.
+//
+// Both passes work on flat, halo-padded float arrays with branch-free inner
+// loops the compiler can vectorize. Cell visibility from self is computed with
+// Map::hasLineOfSightBatch only for cells that hold mass, and cached until
+// self moves.
+class EnemyBelief {
+public:
+  EnemyBelief(const Map& map, const Agent& enemy, double cellSize);
+
+  // Enemy seen at p: all mass on its cell (or the nearest free one).
+  void observe(const Vec2& p);
+  void resetUniform();
+
+  BeliefTick tick(double dt, const Vec2& selfPos);
+
+  int cols() const { return nx_; }
+  int rows() const { return ny_; }
+  double cellSize() const { return cell_; }
+  Vec2 cellCenter(int ix, int iy) const;
+
+  double probability(int ix, int iy) const { return p_[index(ix, iy)]; }
+  double probabilityAt(const Vec2& p) const;
+  double totalMass() const;
+  Vec2 mean() const;
+
+private:
+  // Interior cell (ix, iy) in the padded arrays.
+  std::size_t index(int ix, int iy) const {
+    return static_cast<std::size_t>(iy + 1) * stride_ + static_cast<std::size_t>(ix + 1);
+  }
+  void spreadStep();
+  int updateVisibility(const Vec2& selfPos);
+  void normalize();
+
+  Map map_;
+  Agent enemy_;
+  double cell_;
+  int nx_ = 0;
+  int ny_ = 0;
+  std::size_t stride_ = 0; // nx_ + 2
+
+  std::vector<float> p_;        // probabilities, zero halo
+  std::vector<float> scratch_;
+  std::vector<float> free_;     // 1 for free cells, 0 for blocked and halo
+  std::vector<float> keep_;     // share that stays put: 1 - w * (free neighbours)
+  std::vector<std::uint8_t> seen_; // 0 unknown, 1 hidden, 2 visible from lastSelf_
+  std::vector<float> hiddenMask_;  // 0 where seen_ == 2, else 1
+  Vec2 lastSelf_;
+  bool haveSelf_ = false;
+  double carry_ = 0.0;             // fractional cells of movement not yet spent
+};
@@ -1,14 +1,60 @@
 #pragma once
+#include <vector>
+#include "core/CancellationToken.hpp"
 #include "core/Scene.hpp"
 
 struct ExposureResult {
   double width = 0.0;
+  int losCount = 0; // visible enemy points inside self's field of view
+
+  int totalEnemyReachable = 0;
+  bool cancelled = false;
+};
+
+// Exposure width as a function of self's facing angle (radians, atan2
+// convention). The width has period pi; it is piecewise sinusoidal, changing
+// form only when the facing is parallel to an edge of the convex hull of
+// the visible enemy points, so one piece per hull edge describes all angles.
+struct ExposureProfile {
+  struct Piece {
+    double start = 0.0; // facing angle where the piece begins
+    double end = 0.0;   // exclusive; the last piece ends at pieces[0].start + pi
+    Vec2 span;          // hull extreme minus hull minimum; width = span . perp(facing)
+  };
+
+  struct FacingWidth {
+    double angle = 0.0;
+    double width = 0.0;
+  };
+
+  std::vector<Piece> pieces;
+  std::vector<Vec2> hull; // visible enemy points' convex hull, CCW
   int losCount = 0;
   int totalEnemyReachable = 0;
+  bool cancelled = false;
+
+  // Same value analyze() gives with self.facing at this angle and a full
+  // 360-degree field of view; the profile ignores Scene::fovDegrees.
+  double widthAt(double facingAngle) const;
+
+  FacingWidth narrowest() const;
+  FacingWidth widest() const;
 };
 
 class ExposureAnalyzer {
 public:
+  // When losMask is given it receives self -> point LoS for every enemy
+  // point (1 = visible), tested before the field-of-view cut, for callers
+  // such as AcquisitionAnalyzer that need all of them. A cancelled run
+  // leaves it empty, so a consumer checking the size tests LoS itself.
   ExposureResult analyze(const Scene& scene,
-                         const std::vector<Vec2>& enemyReachable) const;
+                         const std::vector<Vec2>& enemyReachable,
+                         const CancellationToken* cancel = nullptr,
+                         std::vector<unsigned char>* losMask = nullptr) const;
+
+  // Widths for every facing at once: LoS to each enemy point is tested
+  // once, then the hull is swept with rotating calipers.
+  ExposureProfile profile(const Scene& scene,
+                          const std::vector<Vec2>& enemyReachable,
+                          const CancellationToken* cancel = nullptr) const;
 };
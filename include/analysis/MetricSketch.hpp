@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Constant-memory summary of a stream of values: count, mean, variance,
+// min, max and approximate quantiles.
+//
+// Moments use Welford's update, and merge() uses Chan et al.'s pairwise
+// combination, so sketches filled on separate threads and merged give the
+// same answers as one sketch fed everything (up to rounding). Quantiles come
+// from a fixed-bucket histogram over [lo, hi) with under/overflow counts;
+// inside the range they are accurate to one bucket width, outside it they are
+// interpolated towards min / max.
+class MetricSketch {
+public:
+  explicit MetricSketch(double lo = 0.0, double hi = 1.0, int buckets = 256);
+
+  void add(double v);
+
+  // False (and nothing merged) if the histogram layouts differ.
+  bool merge(const MetricSketch& other);
+
+  std::uint64_t count() const { return count_; }
+  double mean() const { return mean_; }
+  double variance() const; // population variance
+  double stddev() const;
+  double min() const { return min_; }
+  double max() const { return max_; }
+
+  // q in [0, 1]; 0 when empty.
+  double quantile(double q) const;
+
+  double lo() const { return lo_; }
+  double hi() const { return hi_; }
+  int buckets() const { return static_cast<int>(counts_.size()); }
+
+private:
+  double lo_;
+  double hi_;
+  double scale_; // buckets / (hi - lo)
+
+  std::uint64_t count_ = 0;
+  double mean_ = 0.0;
+  double m2_ = 0.0;
+  double min_ = 0.0;
+  double max_ = 0.0;
+
+  std::uint64_t under_ = 0;
+  std::uint64_t over_ = 0;
+  std::vector<std::uint64_t> counts_;
+};
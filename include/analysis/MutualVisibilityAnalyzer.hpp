@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+#include "analysis/ReachabilityAnalyzer.hpp"
+#include "core/CancellationToken.hpp"
+#include "core/Scene.hpp"
+
+struct MutualVisibilityOptions {
+  // Weight each position by the share of the window left after reaching it,
+  // 1 - dist / (speed * T), and each pair by the product of its two weights.
+  bool weightByArrival = false;
+  int leafSize = 16; // points per cluster below which pairs are tested one by one
+  int threads = 0;   // 0 = hardware concurrency
+};
+
+struct MutualVisibilityResult {
+  double fraction = 0.0;           // (weighted) share of pairs with LoS
+  std::uint64_t pairs = 0;         // |reachableSelf| x |reachableEnemy|
+  std::uint64_t visiblePairs = 0;  // unweighted
+  std::uint64_t losTests = 0;      // pairs that needed an exact segment test
+  std::uint64_t culledVisible = 0; // pairs settled visible by cluster bounds
+  std::uint64_t culledBlocked = 0; // pairs settled blocked by cluster bounds
+  bool cancelled = false;
+};
+
+// Share of (self-reachable, enemy-reachable) position pairs with line of sight.
+//
+// Both point sets are split into k-d clusters. A cluster pair is settled
+// without per-pair tests when no obstacle touches the convex hull of the two
+// cluster boxes (every pair visible), or when one obstacle blocks all 16
+// corner-to-corner segments (every pair blocked: the points whose segment to a
+// fixed end crosses a box form a convex set). Mixed pairs split the larger
+// cluster and pass down only the obstacles that touched their hull, so leaf
+// pairs run exact segment tests against a handful of boxes. The counts match
+// a brute-force |A| x |B| Map::hasLineOfSight pass exactly.
+class MutualVisibilityAnalyzer {
+public:
+  MutualVisibilityResult analyze(const Scene& scene,
+                                 const ReachabilityResult& reach,
+                                 const MutualVisibilityOptions& options = {},
+                                 const CancellationToken* cancel = nullptr) const;
+};
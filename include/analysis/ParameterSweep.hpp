@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "core/CancellationToken.hpp"
+#include "core/Scene.hpp"
+
+// Values to try for each scene parameter; an empty axis keeps the base
+// scene's value.
+struct SweepAxes {
+  std::vector<double> T;
+  std::vector<double> cellSize;
+  std::vector<double> selfSpeed;
+  std::vector<double> enemySpeed;
+  std::vector<int> visibilitySamples;
+};
+
+// SceneAnalyzer's metrics for one parameter combination.
+struct SweepCell {
+  double areaRatio = 0.0;
+  int reachableSelf = 0;
+  int reachableEnemy = 0;
+  double exposureWidth = 0.0;
+  int losCount = 0;
+  double visibleFraction = 0.0;
+  int visibleCount = 0;
+};
+
+// Dense tensor over the cartesian product, T varying slowest.
+struct SweepResult {
+  std::vector<double> T;
+  std::vector<double> cellSize;
+  std::vector<double> selfSpeed;
+  std::vector<double> enemySpeed;
+  std::vector<int> visibilitySamples;
+
+  std::vector<SweepCell> cells;
+  bool cancelled = false;
+
+  std::size_t index(std::size_t iT, std::size_t iCell, std::size_t iSelf,
+                    std::size_t iEnemy, std::size_t iSamples) const {
+    return (((iT * cellSize.size() + iCell) * selfSpeed.size() + iSelf) * enemySpeed.size() + iEnemy)
+           * visibilitySamples.size() + iSamples;
+  }
+  const SweepCell& at(std::size_t iT, std::size_t iCell, std::size_t iSelf,
+                      std::size_t iEnemy, std::size_t iSamples) const {
+    return cells[index(iT, iCell, iSelf, iEnemy, iSamples)];
+  }
+};
+
+// Evaluates every combination of the axes around one base scene, with the
+// same answers as running SceneAnalyzer on each.
+//
+// Work is shared along the axes it does not depend on. For each cellSize,
+// the lattice around each agent is collision-tested once out to the largest
+// speed * T, and the enemy's free points are LoS-tested from self once.
+// Points are sorted by distance, so the reachable set for any radius is a
+// prefix: counts, LoS counts and the projection extent that gives exposure
+// width are prefix sums / minima / maxima. Visibility depends only on
+// visibilitySamples and is computed once per value.
+class ParameterSweep {
+public:
+  SweepResult run(const Scene& base,
+                  const SweepAxes& axes,
+                  const CancellationToken* cancel = nullptr) const;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+
+#include "core/CancellationToken.hpp"
+#include "core/Scene.hpp"
+#include "geom/AABB.hpp"
+
+// score = area * areaRatio + exposure * exposureWidth + visibility * visibleFraction
+// Weights may be negative (e.g. to penalise a wide exposure).
+struct ScoreWeights {
+  double area = 1.0;
+  double exposure = 0.0;
+  double visibility = 1.0;
+};
+
+struct PositionQuery {
+  ScoreWeights weights;
+  int topK = 5;
+
+  // Candidate lattice for self. A zero spacing uses scene.cellSize; an empty
+  // region (min == max) uses the world bounds.
+  double spacing = 0.0;
+  AABB region{Vec2{0,0}, Vec2{0,0}};
+
+  // 0 keeps scene.self.facing; N > 0 also tries N evenly spaced facings
+  // (angle 2*pi*i/N) at every position and keeps the best one.
+  int facingSamples = 0;
+
+  // Quadtree nodes with at most this many lattice points are scored exactly.
+  int leafSize = 4;
+};
+
+struct PositionCandidate {
+  Vec2 pos;
+  Vec2 facing;
+  double score = 0.0;
+  double areaRatio = 0.0;
+  double exposureWidth = 0.0;
+  double visibleFraction = 0.0;
+};
+
+struct PositionSearchResult {
+  std::vector<PositionCandidate> best; // descending score, at most topK
+  int candidates = 0;                  // collision-free lattice points
+  int evaluated = 0;                   // of those, scored exactly
+  int nodesVisited = 0;
+  int nodesPruned = 0;
+  bool cancelled = false;
+};
+
+// Finds the self positions with the highest weighted score against the fixed
+// enemy, without scoring every candidate.
+//
+// Candidates are split in a quadtree and searched best-bound-first. Each node
+// gets a cheap upper bound on the score of any point in it:
+//  - areaRatio: the lattice count of the full movement disk (as if no obstacle
+//    were in reach) over the enemy's reachable count;
+//  - visibleFraction / exposureWidth: a target sample or enemy cell is dropped
+//    only when a single obstacle shadows it from all four node corners, which
+//    (the shadow of a box being convex) hides it from the whole node.
+// Nodes whose bound cannot beat the current k-th best are discarded. Scores
+// of the returned positions are exactly SceneAnalyzer's metrics for a scene
+// with self moved there.
+class PositionOptimizer {
+public:
+  PositionSearchResult search(const Scene& scene,
+                              const PositionQuery& query = {},
+                              const CancellationToken* cancel = nullptr) const;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <functional>
+
+#include "analysis/AnalysisResult.hpp"
+#include "core/Scene.hpp"
+
+// Resolution used for one refinement step.
+struct ProgressiveLevel {
+  int level = -1;            // -1: nothing finished before the deadline
+  double cellSize = 0.0;
+  int visibilitySamples = 0;
+};
+
+struct ProgressiveOptions {
+  double coarseCellSize = 1.0;     // first level; halved each step down to scene.cellSize
+  int coarseVisibilitySamples = 8; // first level; doubled each step up to scene.visibilitySamples
+
+  // Each level is expected to cost about this many times the previous one.
+  // A level that would not fit in the remaining budget is not started.
+  double expectedGrowth = 4.0;
+};
+
+struct ProgressiveResult {
+  AnalysisResult result;     // best finished level (empty if level.level == -1)
+  ProgressiveLevel level;
+  bool reachedTarget = false; // final level used the scene's own cellSize and samples
+};
+
+// Runs SceneAnalyzer coarse-to-fine until the scene's own resolution is
+// reached or the deadline passes, reporting each finished level through the
+// callback. The level in flight at the deadline is cancelled and discarded.
+class ProgressiveAnalyzer {
+public:
+  using Clock = std::chrono::steady_clock;
+  using LevelCallback = std::function<void(const AnalysisResult&, const ProgressiveLevel&)>;
+
+  ProgressiveResult analyze(const Scene& scene,
+                            Clock::time_point deadline,
+                            const ProgressiveOptions& options = {},
+                            const LevelCallback& onLevel = {}) const;
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include "analysis/AdaptiveSampling.hpp"
+#include "core/CancellationToken.hpp"
 #include "core/Scene.hpp"
 #include "geom/Vec2.hpp"
 
@@ -9,9 +11,19 @@ struct ReachabilityResult {
   std::vector<Vec2> reachableSelf;
   std::vector<Vec2> reachableEnemy;
   double areaRatio = 0.0;
+  bool cancelled = false;
 };
 
 class ReachabilityAnalyzer {
 public:
-  ReachabilityResult analyze(const Scene& scene) const;
+  ReachabilityResult analyze(const Scene& scene,
+                             const CancellationToken* cancel = nullptr) const;
+
+  // Approximate areaRatio without the point lists. Lattice points of both
+  // movement disks are collision-tested in golden-stride order; each disk's
+  // free fraction gets a Wilson interval and the ratio interval is derived
+  // from those. `tol.halfWidth` is absolute, in units of areaRatio.
+  SampledEstimate estimateAreaRatio(const Scene& scene,
+                                    const SamplingTolerance& tol,
+                                    const CancellationToken* cancel = nullptr) const;
 };
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "analysis/AnalysisResult.hpp"
+#include "core/CancellationToken.hpp"
 #include "core/Scene.hpp"
 
 class SceneAnalyzer {
 public:
-  AnalysisResult analyze(const Scene& scene) const;
+  // With a token, returns early (result.cancelled == true) once it fires.
+  AnalysisResult analyze(const Scene& scene,
+                         const CancellationToken* cancel = nullptr) const;
 };
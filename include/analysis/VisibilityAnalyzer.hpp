@@ -1,10 +1,35 @@
 #pragma once
+#include <vector>
+
+#include "analysis/AdaptiveSampling.hpp"
+#include "core/CancellationToken.hpp"
 #include "core/Scene.hpp"
 
 struct VisibilityResult {
   double visibleFraction = 0.0; // [0,1]
   int visibleCount = 0;
   int sampleCount = 0;
+  bool cancelled = false;
+};
+
+// Visible fraction changes along a path; the fraction holds from `time`
+// until the next event.
+struct VisibilityEvent {
+  double time = 0.0;       // seconds from the start of the path
+  Vec2 position;           // shooter position at that time
+  double visibleFraction = 0.0;
+};
+
+struct SweptVisibilityResult {
+  std::vector<VisibilityEvent> events; // time order; events[0].time == 0
+  double duration = 0.0;               // path length / speed
+  double firstVisibleTime = -1.0;      // first time any sample is visible, -1 if never
+  double firstFullTime = -1.0;         // first time every sample is visible, -1 if never
+  double visibleTime = 0.0;            // total time with visibleFraction > 0
+  int sampleCount = 0;
+  bool cancelled = false;
+
+  double fractionAt(double time) const;
 };
 
 class VisibilityAnalyzer {
@@ -12,5 +37,26 @@ public:
   // shooter -> target circle visibility
   VisibilityResult analyze(const Scene& scene,
                            const Vec2& shooterPos,
-                           const Agent& target) const;
+                           const Agent& target,
+                           const CancellationToken* cancel = nullptr) const;
+
+  // Approximate visibleFraction: the same visibilitySamples rays, cast in
+  // golden-stride order until the interval meets `tol`.
+  SampledEstimate estimate(const Scene& scene,
+                           const Vec2& shooterPos,
+                           const Agent& target,
+                           const SamplingTolerance& tol,
+                           const CancellationToken* cancel = nullptr) const;
+
+  // analyze() for every point of the polyline `path` walked at `speed`, in
+  // one pass. For each rim sample, the shadow of each obstacle (the points
+  // whose segment to the sample crosses the box) is convex, an intersection
+  // of at most four half-planes, so it cuts each path segment in a single
+  // interval. The complement of those intervals, within the world bounds, is
+  // when that sample is visible.
+  SweptVisibilityResult sweep(const Scene& scene,
+                              const std::vector<Vec2>& path,
+                              double speed,
+                              const Agent& target,
+                              const CancellationToken* cancel = nullptr) const;
 };
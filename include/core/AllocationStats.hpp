@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+
+#include "core/EngineStats.hpp"
+
+// Heap accounting for ENGINE_STATS builds. There, the engine replaces the
+// global operator new / delete with versions that tally, per thread, the
+// allocations made, the bytes requested and the bytes still live. Every
+// container and string is counted, including the ostringstreams behind
+// explanations; nothing needs a custom allocator. Without ENGINE_STATS the
+// standard operators are used and every count stays zero.
+//
+// Memory freed on a thread other than the one that allocated it lowers that
+// other thread's live count, so peaks are per thread and only exact for work
+// that frees its own memory.
+
+constexpr bool kAllocationTracking = FPS_ENGINE_STATS != 0;
+
+struct AllocationCounters {
+  std::uint64_t allocations = 0;
+  std::uint64_t bytes = 0;     // requested by those allocations
+  std::uint64_t peakBytes = 0; // most bytes live at once, above the scope's starting point
+};
+
+// Counts the calling thread's allocations between construction and
+// counters(). Scopes nest; an inner scope's peak still counts toward the
+// outer one.
+class AllocationScope {
+public:
+  AllocationScope();
+  ~AllocationScope();
+
+  AllocationScope(const AllocationScope&) = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+
+  AllocationCounters counters() const;
+
+private:
+  std::uint64_t allocations_ = 0;
+  std::uint64_t bytes_ = 0;
+  std::int64_t live_ = 0;
+  std::int64_t outerPeak_ = 0;
+};
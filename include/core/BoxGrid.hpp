@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+
+#include "geom/AABB.hpp"
+#include "geom/Vec2.hpp"
+
+// Uniform buckets of box indices over a region. Every box is listed in each
+// bucket its bounds touch; boxes reaching past the region are clamped into
+// the edge buckets, so nothing is ever dropped. The grid stores indices only:
+// queries take the same box list it was built from.
+class BoxGrid {
+public:
+  BoxGrid(const std::vector<AABB>& boxes, const AABB& region, double bucketSize);
+
+  // Exact distance from p to the nearest box (infinity when there are none),
+  // searching buckets in growing rings around p.
+  double nearest(const std::vector<AABB>& boxes, const Vec2& p) const;
+
+  struct Hit {
+    double distance;
+    int index; // -1 when nothing is hit
+  };
+
+  // Nearest box along origin + t * dirUnit for tStart <= t < maxRange, walking
+  // the buckets the ray crosses inside the region (origin must lie in it).
+  // Ties go to the lower index. Boxes only reached outside the region are not
+  // seen; callers test those themselves.
+  Hit raycast(const std::vector<AABB>& boxes, const Vec2& origin, const Vec2& dirUnit,
+              double tStart, double maxRange) const;
+
+private:
+  int clampX(double x) const;
+  int clampY(double y) const;
+  const std::vector<int>& bucket(int x, int y) const {
+    return buckets_[static_cast<size_t>(y) * nx_ + x];
+  }
+
+  AABB region_;
+  double size_;
+  int nx_ = 1;
+  int ny_ = 1;
+  std::vector<std::vector<int>> buckets_;
+};
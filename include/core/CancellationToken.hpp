@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Cooperative cancellation flag. Analyzers poll it inside their sampling loops
+// and return early with `cancelled` set; partial results must not be used.
+//
+// A token can also carry a wall-clock deadline, after which it reports
+// cancelled on its own. The clock is only read when a deadline is set, and
+// then only on one poll in kDeadlineStride of a run of polls of this token on
+// one thread, so hot loops can poll freely. A thread's first poll of a token,
+// including after it polled another one, always reads the clock, so how soon
+// an expired deadline shows does not depend on other tokens. Once the
+// deadline has passed the token latches cancelled and every later poll is a
+// single flag load.
+class CancellationToken {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr unsigned kDeadlineStride = 64;
+
+  void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  void setDeadline(Clock::time_point deadline) {
+    const std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      deadline.time_since_epoch()).count();
+    // 0 is reserved for "no deadline"
+    deadlineNs_.store(ns > 0 ? ns : 1, std::memory_order_relaxed);
+  }
+
+  bool cancelled() const {
+    if (cancelled_.load(std::memory_order_relaxed)) return true;
+
+    const std::int64_t deadline = deadlineNs_.load(std::memory_order_relaxed);
+    if (deadline == 0) return false;
+
+    // Stride counter for the token this thread polled last.
+    thread_local std::uint64_t lastToken = 0;
+    thread_local unsigned polls = 0;
+    if (lastToken != id_) {
+      lastToken = id_;
+      polls = 0;
+    }
+    if (polls++ % kDeadlineStride != 0) return false;
+
+    const bool expired = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now().time_since_epoch()).count() >= deadline;
+    if (expired) cancelled_.store(true, std::memory_order_relaxed);
+    return expired;
+  }
+
+private:
+  static inline std::atomic<std::uint64_t> nextId_{1};
+
+  mutable std::atomic<bool> cancelled_{false}; // also latched by an expired deadline
+  std::atomic<std::int64_t> deadlineNs_{0};    // 0 = no deadline
+  const std::uint64_t id_ = nextId_.fetch_add(1, std::memory_order_relaxed); // never reused, unlike addresses
+};
+
+inline bool isCancelled(const CancellationToken* token) {
+  return token != nullptr && token->cancelled();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "geom/Vec2.hpp"
+
+class Map;
+struct Scene;
+
+struct CoverPoint {
+  Vec2 pos;
+  int obstacle = -1;     // index of the box it hugs
+  double distance = 0.0; // from the query origin (query results only)
+};
+
+// Candidate cover spots hugging obstacle edges and corners, in a 2D k-d tree.
+//
+// Points run around each box offset by the agent radius (plus a hair, so they
+// are collision-free), at most `spacing` apart along every edge, with one
+// diagonal point past each corner. Points that collide with other geometry
+// or fall outside the world are dropped.
+//
+// nearestHidden() walks the tree outward from the origin and returns the
+// first k points that the viewpoint cannot see, so a "where do I break LoS"
+// query costs a handful of LoS tests instead of one per reachable cell.
+class CoverIndex {
+public:
+  static std::shared_ptr<const CoverIndex> build(const Map& map, double agentRadius, double spacing = 0.5);
+
+  // build(), cached on the map's snapshot.
+  static std::shared_ptr<const CoverIndex> cached(const Map& map, double agentRadius, double spacing = 0.5);
+
+  const std::vector<CoverPoint>& points() const { return points_; }
+
+  // Up to k points within maxDistance of `from` (straight line) with no LoS
+  // from `viewpoint`, nearest first. `map` must be the one the index was built on.
+  std::vector<CoverPoint> nearestHidden(const Map& map, const Vec2& from, const Vec2& viewpoint,
+                                        double maxDistance, int k) const;
+
+  // Cover for scene.self against scene.enemy within the fight window:
+  // maxDistance = self.speed * T, the same disk ReachabilityAnalyzer samples.
+  std::vector<CoverPoint> nearestHidden(const Scene& scene, int k) const;
+
+private:
+  CoverIndex() = default;
+  void buildTree(int lo, int hi);
+
+  std::vector<CoverPoint> points_; // reordered into k-d tree layout
+  std::vector<unsigned char> axis_; // split axis per node (median of its range)
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "geom/AABB.hpp"
+#include "geom/Vec2.hpp"
+
+class Map;
+
+// Signed Euclidean distance to the map's obstacles, sampled on a regular grid
+// over the world bounds (positive outside obstacles, negative inside).
+//
+// Outside values are exact distances to the nearest box. Inside values are
+// the distance to the nearest free sample, which never overstates the true
+// depth, so every stored sample is <= the true signed distance. Queries use
+// the 1-Lipschitz bound max_i(d_i - |p - c_i|) over the surrounding samples,
+// which keeps that guarantee between samples: collision tests may report a
+// near miss as a hit (within about one sample spacing) but never miss a
+// real overlap, and sphere-traced rays never pass through an obstacle.
+//
+// Collision here is true circle-vs-box overlap. Map::collidesCircleAt inflates
+// boxes by the radius on both axes, which is more conservative at corners.
+class DistanceField {
+public:
+  static std::shared_ptr<const DistanceField> build(const Map& map, double resolution);
+
+  // build(), cached on the map's snapshot: every scene sharing the geometry
+  // shares one field, and an edit to the map starts afresh.
+  static std::shared_ptr<const DistanceField> cached(const Map& map, double resolution);
+
+  double resolution() const { return h_; }
+  int nodesX() const { return nx_; }
+  int nodesY() const { return ny_; }
+  const AABB& bounds() const { return bounds_; }
+
+  // Lower bound on the signed distance at p. Points outside the world bounds
+  // report -1 (blocked), matching Map's out-of-bounds convention.
+  double distance(const Vec2& p) const;
+
+  // Conservative test for a circle of any radius: one lookup.
+  bool collidesCircle(const Vec2& center, double radius) const {
+    return distance(center) < radius;
+  }
+
+  // Sphere-traced ray from origin along dirUnit. Returns the distance to the
+  // first surface closer than `hitEpsilon`, or maxRange if nothing is hit
+  // before the ray leaves the world or reaches maxRange.
+  double raycast(const Vec2& origin, const Vec2& dirUnit, double maxRange,
+                 double hitEpsilon = 1e-4) const;
+
+private:
+  DistanceField() = default;
+
+  double sample(int ix, int iy) const { return values_[static_cast<size_t>(iy) * nx_ + ix]; }
+
+  AABB bounds_;
+  double h_ = 1.0;
+  int nx_ = 0;
+  int ny_ = 0;
+  std::vector<float> values_; // rounded toward -inf so the bound stays conservative
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+// Opt-in work counters. Configure with -DENGINE_STATS=ON to define
+// FPS_ENGINE_STATS=1; otherwise every ENGINE_STAT_ADD compiles to nothing.
+#ifndef FPS_ENGINE_STATS
+#define FPS_ENGINE_STATS 0
+#endif
+
+struct WorkCounters {
+  std::uint64_t losQueries = 0;
+  std::uint64_t boxTests = 0;        // obstacle boxes examined by LoS and collision queries
+  std::uint64_t collisionQueries = 0;
+
+  WorkCounters operator-(const WorkCounters& o) const {
+    return {losQueries - o.losQueries, boxTests - o.boxTests, collisionQueries - o.collisionQueries};
+  }
+  WorkCounters operator+(const WorkCounters& o) const {
+    return {losQueries + o.losQueries, boxTests + o.boxTests, collisionQueries + o.collisionQueries};
+  }
+};
+
+// Running totals for the calling thread. They only grow; callers measure a
+// region by differencing snapshots taken before and after it.
+inline WorkCounters& threadWorkCounters() {
+  thread_local WorkCounters counters;
+  return counters;
+}
+
+#if FPS_ENGINE_STATS
+#define ENGINE_STAT_ADD(field, n) (threadWorkCounters().field += (n))
+#else
+#define ENGINE_STAT_ADD(field, n) ((void)0)
+#endif
@@ -1,31 +1,94 @@
 #pragma once
+#include <memory>
+#include <string>
 #include <vector>
+#include "core/MapSnapshot.hpp"
 #include "geom/AABB.hpp"
 #include "geom/Vec2.hpp"
 
+class VisibilityMatrix;
+
+// First obstacle along a ray, or the end of the ray when none is hit.
+struct RayHit {
+  double distance = 0.0; // from the origin; maxRange on a miss, 0 if the origin is inside a box
+  int obstacle = -1;     // index into Map::obstacles(), -1 on a miss
+  Vec2 point;            // origin + direction * distance
+};
+
+// Copy-on-write handle to a shared MapSnapshot: copies are cheap and share
+// geometry and derived structures until one of them is edited.
 class Map {
 public:
-  Map() = default;
+  Map();
+  explicit Map(std::shared_ptr<const MapSnapshot> snapshot);
 
-  void setWorldBounds(const AABB& bounds) { worldBounds_ = bounds; }
-  const AABB& worldBounds() const { return worldBounds_; }
+  void setWorldBounds(const AABB& bounds) { edit().worldBounds_ = bounds; }
+  const AABB& worldBounds() const { return snap_->worldBounds(); }
 
-  void addObstacle(const AABB& aabb) { obstacles_.push_back(aabb); }
-  const std::vector<AABB>& obstacles() const { return obstacles_; }
+  void addObstacle(const AABB& aabb) { edit().obstacles_.push_back(aabb); }
+  const std::vector<AABB>& obstacles() const { return snap_->obstacles(); }
 
-  bool inBounds(const Vec2& p) const { return worldBounds_.contains(p); }
+  bool inBounds(const Vec2& p) const { return worldBounds().contains(p); }
 
+  // Answered from the attached visibility matrix when both points are free cell
+  // centres of it; exact segment-vs-AABB tests otherwise.
   bool hasLineOfSight(const Vec2& from, const Vec2& to) const;
 
+  // hasLineOfSight for n segments (ax[i], ay[i]) -> (bx[i], by[i]) given as
+  // structure-of-arrays; writes 1/0 to visible[i]. Same answers as the scalar
+  // call, but obstacles are walked once for the whole batch.
+  void hasLineOfSightBatch(const double* ax, const double* ay,
+                           const double* bx, const double* by,
+                           int n, unsigned char* visible) const;
+
   bool collidesCircleAt(const Vec2& center, double radius) const;
 
+  // Nearest obstacle along origin + t * dirUnit, 0 <= t <= maxRange. World
+  // bounds do not stop the ray. On maps with many boxes and an origin inside
+  // the world, the ray walks a grid of box buckets cached on the snapshot and
+  // stops at the first bucket that contains its hit; otherwise every box is
+  // tested. Both give the same answer, ties going to the lower index.
+  RayHit raycast(const Vec2& origin, const Vec2& dirUnit, double maxRange) const;
+
+  // `rays` raycasts from one origin at angles evenly spaced from startAngle
+  // to endAngle inclusive (radians, atan2 convention). Same hits as calling
+  // raycast() per angle. Where raycast() walks the grid, so does every ray;
+  // on small maps, obstacles out of range or outside the fan are dropped
+  // once, and each ray walks the rest nearest first and stops at the first
+  // box that cannot beat its current hit.
+  std::vector<RayHit> fanCast(const Vec2& origin, double startAngle, double endAngle,
+                              int rays, double maxRange) const;
+
+  // Precomputed cell-to-cell LoS for this exact geometry. A matrix built for
+  // other bounds or obstacles is refused (false, map unchanged); null
+  // detaches. Any edit below detaches it, since it would no longer match.
+  bool setVisibilityMatrix(std::shared_ptr<const VisibilityMatrix> pvs);
+  const std::shared_ptr<const VisibilityMatrix>& visibilityMatrix() const { return pvs_; }
+
+  // The geometry this handle currently shares.
+  const std::shared_ptr<const MapSnapshot>& snapshot() const { return snap_; }
+
+  // Cached on the snapshot; see MapSnapshot::derived.
+  template <class T, class Build>
+  std::shared_ptr<const T> derived(const std::string& key, Build&& build) const {
+    return snap_->derived<T>(key, std::forward<Build>(build));
+  }
+
     // Editor helpers (viewer needs to mutate obstacles)
-  std::vector<AABB>& obstaclesMutable() { return obstacles_; }
-  void removeObstacle(size_t i) { obstacles_.erase(obstacles_.begin() + i); }
-  void setObstacle(size_t i, const AABB& b) { obstacles_[i] = b; }
+  void setObstacles(std::vector<AABB> boxes) { edit().obstacles_ = std::move(boxes); }
+  void removeObstacle(size_t i) { auto& obs = edit().obstacles_; obs.erase(obs.begin() + i); }
+  void setObstacle(size_t i, const AABB& b) { edit().obstacles_[i] = b; }
 
 
 private:
-  AABB worldBounds_{Vec2{0,0}, Vec2{10,10}};
-  std::vector<AABB> obstacles_;
+  // Untraced bodies of hasLineOfSight / collidesCircleAt.
+  bool lineOfSight(const Vec2& from, const Vec2& to) const;
+  bool collidesCircle(const Vec2& center, double radius) const;
+
+  // Snapshot safe to modify: cloned first if shared, derived caches dropped.
+  MapSnapshot& edit();
+
+  std::shared_ptr<const MapSnapshot> snap_;
+  bool ownsSnapshot_ = true; // false for snapshots handed in from outside; always cloned on edit
+  std::shared_ptr<const VisibilityMatrix> pvs_;
 };
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include "core/Map.hpp"
+
+// What a simplification pass did to the obstacle set.
+struct SimplifyReport {
+  std::size_t obstaclesBefore = 0;
+  std::size_t obstaclesAfter = 0;
+  std::size_t containedRemoved = 0; // boxes fully inside another box
+  std::size_t merged = 0;           // boxes absorbed into a neighbour sharing an edge span
+
+  double reductionFactor() const {
+    return (obstaclesAfter > 0)
+      ? static_cast<double>(obstaclesBefore) / static_cast<double>(obstaclesAfter)
+      : 1.0;
+  }
+};
+
+// Preprocessing pass that rewrites a map's obstacles into a smaller set with the
+// same union: contained boxes are dropped, and boxes that share an exact span on
+// one axis and touch or overlap on the other are fused. Because the union is
+// unchanged and inflation distributes over such merges, hasLineOfSight and
+// collidesCircleAt give the same answers before and after.
+class MapSimplifier {
+public:
+  SimplifyReport simplify(Map& map) const;
+};
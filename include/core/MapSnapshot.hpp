@@ -0,0 +1,65 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "geom/AABB.hpp"
+
+// Immutable map geometry shared by reference between Map handles.
+//
+// Copying a Map (and so a Scene) copies a pointer to one of these; the first
+// edit through a handle that shares it clones the geometry first. Structures
+// derived from the geometry are cached on the snapshot, so every scene that
+// shares it also shares them, and are dropped with it.
+class MapSnapshot {
+public:
+  MapSnapshot(const AABB& worldBounds, std::vector<AABB> obstacles)
+    : worldBounds_(worldBounds), obstacles_(std::move(obstacles)) {}
+
+  MapSnapshot(const MapSnapshot&) = delete;
+  MapSnapshot& operator=(const MapSnapshot&) = delete;
+
+  const AABB& worldBounds() const { return worldBounds_; }
+  const std::vector<AABB>& obstacles() const { return obstacles_; }
+
+  // Structure derived from this geometry under `key` (which must encode any
+  // build parameters, e.g. "sdf:0.1"). `build()` runs once, on first request;
+  // concurrent callers for the same key wait for it and share the result
+  // read-only. The cache lock only guards finding the key's slot, so builds
+  // for other keys run in parallel and a build may request other keys. If
+  // build() throws, the next request retries.
+  template <class T, class Build>
+  std::shared_ptr<const T> derived(const std::string& key, Build&& build) const {
+    std::shared_ptr<Slot> slot;
+    {
+      std::lock_guard<std::mutex> lock(derivedMutex_);
+      auto& entry = derived_[key];
+      if (!entry) entry = std::make_shared<Slot>();
+      slot = entry;
+    }
+    std::call_once(slot->once, [&] { slot->value = std::shared_ptr<const T>(build()); });
+    return std::static_pointer_cast<const T>(slot->value);
+  }
+
+  std::size_t derivedCount() const {
+    std::lock_guard<std::mutex> lock(derivedMutex_);
+    return derived_.size();
+  }
+
+private:
+  friend class Map; // edits a snapshot in place while it is the only owner
+
+  AABB worldBounds_;
+  std::vector<AABB> obstacles_;
+
+  struct Slot {
+    std::once_flag once;
+    std::shared_ptr<const void> value; // written once, under `once`
+  };
+
+  mutable std::mutex derivedMutex_;
+  mutable std::unordered_map<std::string, std::shared_ptr<Slot>> derived_;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <cmath>
 #include "core/Map.hpp"
 #include "core/Agent.hpp"
 
@@ -10,4 +11,16 @@ struct Scene {
   double T{0.30};
   double cellSize{0.5};
   int visibilitySamples{64};
+  double fovDegrees{360.0}; // self's field of view, centred on its facing
 };
+
+// True when `offset` (from the viewer) lies within fovDegrees / 2 of the
+// facing direction, edges included. Exposure uses this to skip enemy points
+// self is not looking at; the viewer draws the same cone.
+inline bool inFieldOfView(const Vec2& facingUnit, double fovDegrees, const Vec2& offset) {
+  if (fovDegrees >= 360.0) return true;
+  const double len = offset.norm();
+  if (len == 0.0) return true;
+  const double halfRad = fovDegrees * (3.14159265358979323846 / 360.0);
+  return facingUnit.dot(offset) >= std::cos(halfRad) * len;
+}
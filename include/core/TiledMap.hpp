@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "geom/AABB.hpp"
+#include "geom/Vec2.hpp"
+
+class Map;
+struct TileEntry;
+
+// Map storage split into fixed-size square tiles, loaded on demand from disk.
+//
+// The file written by write() holds a small header and tile directory; open()
+// reads only those. A tile's obstacles (each box is listed in every tile it
+// overlaps) are read the first time a query reaches it and indexed in a
+// bucket grid. At most `maxResidentTiles` stay in memory; the least recently
+// used tile is dropped beyond that.
+//
+// Queries may run on many threads. A resident tile is found under a shared
+// lock and its use is stamped atomically, so hits never wait on each other.
+// A miss reserves the tile's slot under the exclusive lock and reads the file
+// after releasing it (positioned reads, no shared stream); other threads
+// asking for that tile wait for that one read, and other tiles load in
+// parallel. A tile that cannot be read (the file was truncated or became
+// unreadable after open()) makes the query throw std::runtime_error and is
+// not cached, so a later query reads it again.
+//
+// Queries have the same answers as Map's but only read the tiles under the
+// segment, or under the disk's bounding square. For analyzers, extract() cuts
+// a regular Map around the area of interest.
+class TiledMap {
+public:
+  // Tiles `map` at `tileSize`. The file uses native byte order.
+  static bool write(const std::string& path, const Map& map, double tileSize);
+
+  // Returns nullptr if the file is missing or malformed.
+  static std::shared_ptr<TiledMap> open(const std::string& path, int maxResidentTiles = 64);
+
+  ~TiledMap();
+
+  const AABB& worldBounds() const { return worldBounds_; }
+  bool inBounds(const Vec2& p) const { return worldBounds_.contains(p); }
+
+  double tileSize() const { return tileSize_; }
+  int tilesX() const { return tilesX_; }
+  int tilesY() const { return tilesY_; }
+
+  bool hasLineOfSight(const Vec2& from, const Vec2& to) const;
+  bool collidesCircleAt(const Vec2& center, double radius) const;
+
+  // Map whose world bounds are `area` (clipped to the world), holding every
+  // obstacle that overlaps `area` grown by `padding`. Pad by the largest agent
+  // radius so collision tests near the edge still see boxes just outside it.
+  Map extract(const AABB& area, double padding = 0.0) const;
+
+  int residentTiles() const;
+  std::uint64_t tileLoads() const;
+
+private:
+  struct Tile;
+
+  // A resident (or loading) tile.
+  struct Slot {
+    std::shared_future<std::shared_ptr<const Tile>> tile;
+    std::atomic<std::uint64_t> lastUse{0};
+  };
+
+  TiledMap() = default;
+
+  std::shared_ptr<const Tile> tile(int tx, int ty) const;
+  std::shared_ptr<const Tile> loadTile(int index) const;
+  bool readAt(std::uint64_t offset, void* dst, std::size_t bytes) const;
+
+  AABB worldBounds_;
+  double tileSize_ = 1.0;
+  int tilesX_ = 0;
+  int tilesY_ = 0;
+  std::vector<TileEntry> directory_;
+
+  std::string path_; // reopened per tile read where there is no pread
+  int fd_ = -1;
+
+  int maxResident_ = 64;
+  mutable std::shared_mutex mutex_; // guards resident_
+  mutable std::unordered_map<int, std::shared_ptr<Slot>> resident_;
+  mutable std::atomic<std::uint64_t> clock_{0}; // use stamps
+  mutable std::atomic<std::uint64_t> loads_{0};
+};
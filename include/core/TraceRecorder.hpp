@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/Map.hpp"
+#include "core/Scene.hpp"
+
+// Opt-in capture of engine calls for offline replay.
+//
+// While recording, SceneAnalyzer::analyze, Map::hasLineOfSight and
+// Map::collidesCircleAt append their inputs, result and wall time to a
+// buffer owned by the calling thread. That path takes no lock and does no
+// I/O: full buffers, and every buffer at stop(), are handed to a writer
+// thread through a lock-free queue and land in the trace file as one chunk.
+// Each thread keeps its own map-id table and writes a map snapshot into its
+// stream the first time it uses it; the reader merges the copies.
+// Calls made from inside a recorded analyze() are not recorded separately,
+// since replaying the analyze() reproduces them.
+//
+// When not recording, the cost is one relaxed atomic load per call.
+class TraceRecorder {
+public:
+  // False if already recording or the file cannot be created.
+  static bool start(const std::string& path);
+
+  // Waits for traced calls in flight on other threads, flushes every
+  // thread's buffer and closes the file. Calls that start after it are not
+  // recorded.
+  static bool stop();
+
+  static bool recording() { return recording_.load(std::memory_order_relaxed); }
+
+  // Monotonic nanoseconds, for call timing.
+  static std::uint64_t nowNs();
+
+  static void lineOfSight(const Map& map, const Vec2& from, const Vec2& to, bool visible,
+                          std::uint64_t startNs, std::uint64_t endNs);
+  static void collision(const Map& map, const Vec2& center, double radius, bool hit,
+                        std::uint64_t startNs, std::uint64_t endNs);
+
+  // RAII around one analyze(): suppresses nested records, then records the
+  // scene with the metrics that finish() was given.
+  class AnalyzeScope {
+  public:
+    explicit AnalyzeScope(const Scene& scene);
+    ~AnalyzeScope();
+    void finish(double areaRatio, double exposureWidth, double visibleFraction);
+
+  private:
+    const Scene* scene_ = nullptr; // null when not recording or nested
+    bool counted_ = false;         // holds a nesting level
+    bool finished_ = false;        // cancelled runs are not recorded
+    std::uint64_t start_ = 0;
+    double metrics_[3] = {0.0, 0.0, 0.0};
+  };
+
+private:
+  static inline std::atomic<bool> recording_{false};
+};
+
+// Contents of a trace file, for replay.
+struct TraceCall {
+  enum Kind : std::uint8_t { LineOfSight = 1, Collision = 2, Analyze = 3 };
+
+  Kind kind = LineOfSight;
+  std::uint32_t thread = 0;  // recording thread, numbered from 0 (a thread may inherit an exited one's number)
+  std::uint32_t map = 0;     // index into TraceFile::maps
+  std::uint64_t startNs = 0; // since start()
+  std::uint32_t durationNs = 0;
+
+  Vec2 a, b;          // LoS endpoints; a = centre for collisions
+  double radius = 0.0;
+  bool result = false;
+
+  std::uint32_t scene = 0;       // index into TraceFile::scenes (Analyze)
+  double metrics[3] = {0, 0, 0}; // areaRatio, exposureWidth, visibleFraction (Analyze)
+};
+
+struct TraceFile {
+  std::vector<Map> maps;
+  std::vector<Scene> scenes; // map member already points at maps[...]
+  std::vector<TraceCall> calls; // per thread in call order; threads interleaved by chunk
+
+  // False if the file is missing, truncated or not a trace.
+  bool load(const std::string& path);
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "geom/Vec2.hpp"
+
+class Map;
+struct PvsHeader;
+
+// Precomputed cell-to-cell line-of-sight (potentially visible set) for a static
+// map at a fixed cell size.
+//
+// Cells are laid out on a grid anchored at the world's min corner; a cell is
+// "free" when its centre does not collide with the map at the build radius.
+// Row i lists the free cells visible from free cell i as sorted run-length
+// spans. The whole structure lives in one flat buffer with the same layout as
+// the file written by save(), so load() can memory-map it without parsing.
+class VisibilityMatrix {
+public:
+  struct Span {
+    std::uint32_t start;
+    std::uint32_t length;
+  };
+
+  // Exact: every entry comes from Map::hasLineOfSight between cell centres.
+  static std::shared_ptr<const VisibilityMatrix> build(const Map& map,
+                                                       double cellSize,
+                                                       double agentRadius = 0.0);
+
+  // Returns nullptr if the file is missing or malformed; every table index is
+  // range-checked on load. The file uses native byte order and is meant for
+  // the machine that wrote it.
+  static std::shared_ptr<const VisibilityMatrix> load(const std::string& path);
+  bool save(const std::string& path) const;
+
+  // Whether this matrix was built for map's exact world bounds and obstacles
+  // (compared through a hash stored in the header).
+  bool builtFor(const Map& map) const;
+
+  double cellSize() const;
+  int cols() const;
+  int rows() const;
+  int freeCount() const;
+  std::size_t spanCount() const;
+  std::size_t byteSize() const { return size_; }
+
+  Vec2 cellCenter(int freeCell) const;
+
+  // Free cell whose centre is p (within a tiny tolerance), or -1.
+  int freeCellAt(const Vec2& p) const;
+
+  bool visible(int fromCell, int toCell) const;
+
+  // Bit i set when free cell i is visible from `fromCell`; 64 cells per word.
+  std::vector<std::uint64_t> rowMask(int fromCell) const;
+
+  // popcount(row(fromCell) & targets) without expanding the row.
+  int countVisible(int fromCell, const std::vector<std::uint64_t>& targets) const;
+
+private:
+  VisibilityMatrix(std::shared_ptr<const void> storage, const unsigned char* data, std::size_t size);
+  bool bind();
+  bool validate(std::size_t cells) const;
+
+  std::shared_ptr<const void> storage_; // owns the buffer or the mapping
+  const unsigned char* data_ = nullptr;
+  std::size_t size_ = 0;
+
+  const PvsHeader* header_ = nullptr;
+  const std::int32_t* cellToFree_ = nullptr;
+  const std::uint32_t* freeToCell_ = nullptr;
+  const std::uint32_t* rowOffsets_ = nullptr;
+  const Span* spans_ = nullptr;
+};
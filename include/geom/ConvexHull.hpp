@@ -0,0 +1,34 @@
+#pragma once
+#include "geom/Vec2.hpp"
+#include <algorithm>
+#include <vector>
+
+// z of (a - o) x (b - o); > 0 when o -> a -> b turns counter-clockwise.
+inline double cross(const Vec2& o, const Vec2& a, const Vec2& b) {
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// Andrew's monotone chain. Counter-clockwise, no repeated or collinear points;
+// fewer than 3 points come back as the distinct inputs.
+inline std::vector<Vec2> convexHull(std::vector<Vec2> pts) {
+  std::sort(pts.begin(), pts.end(), [](const Vec2& a, const Vec2& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  });
+  pts.erase(std::unique(pts.begin(), pts.end(), [](const Vec2& a, const Vec2& b) {
+    return a.x == b.x && a.y == b.y;
+  }), pts.end());
+  if (pts.size() < 3) return pts;
+
+  std::vector<Vec2> hull(2 * pts.size());
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < pts.size(); ++i) {
+    while (k >= 2 && cross(hull[k - 2], hull[k - 1], pts[i]) <= 0.0) --k;
+    hull[k++] = pts[i];
+  }
+  for (std::size_t i = pts.size() - 1, lower = k + 1; i-- > 0;) {
+    while (k >= lower && cross(hull[k - 2], hull[k - 1], pts[i]) <= 0.0) --k;
+    hull[k++] = pts[i];
+  }
+  hull.resize(k - 1);
+  return hull;
+}
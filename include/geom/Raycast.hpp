@@ -1,6 +1,9 @@
 #pragma once
 #include "geom/AABB.hpp"
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
 
 // Segment (p0->p1) intersects AABB (including boundaries).
 inline bool segmentIntersectsAABB(const Vec2& p0, const Vec2& p1, const AABB& b) {
@@ -34,3 +37,60 @@ inline bool segmentIntersectsAABB(const Vec2& p0, const Vec2& p1, const AABB& b)
 
   return true;
 }
+
+// Distance along the ray ro + t * rdUnit (t >= 0) to the first point of b:
+// 0 when ro is inside b, infinity when the ray misses it.
+inline double rayIntersectAABB(const Vec2& ro, const Vec2& rdUnit, const AABB& b) {
+  const double inf = std::numeric_limits<double>::infinity();
+
+  double tmin = 0.0;
+  double tmax = inf;
+
+  auto slab = [&](double roC, double rdC, double minC, double maxC) -> bool {
+    if (std::abs(rdC) < 1e-12) {
+      return roC >= minC && roC <= maxC;
+    }
+    double t1 = (minC - roC) / rdC;
+    double t2 = (maxC - roC) / rdC;
+    if (t1 > t2) std::swap(t1, t2);
+    tmin = std::max(tmin, t1);
+    tmax = std::min(tmax, t2);
+    return tmin <= tmax;
+  };
+
+  if (!slab(ro.x, rdUnit.x, b.min.x, b.max.x)) return inf;
+  if (!slab(ro.y, rdUnit.y, b.min.y, b.max.y)) return inf;
+  return tmin;
+}
+
+// Batched segmentIntersectsAABB over structure-of-arrays segments
+// (ax[i], ay[i]) -> (bx[i], by[i]): sets hit[i] to 1 when segment i touches b,
+// leaves it unchanged otherwise. Same arithmetic as the scalar test, written
+// without data-dependent branches so the loop vectorises.
+inline void segmentsIntersectAABB(const double* ax, const double* ay,
+                                  const double* bx, const double* by,
+                                  int n, const AABB& b, unsigned char* hit) {
+  for (int i = 0; i < n; ++i) {
+    const double dx = bx[i] - ax[i];
+    const double dy = by[i] - ay[i];
+
+    double tmin = 0.0;
+    double tmax = 1.0;
+    bool ok = true;
+
+    auto update = [&](double p, double q) {
+      const bool parallel = std::abs(p) < 1e-12;
+      ok = ok && (!parallel || q >= 0.0);
+      const double t = q / (parallel ? 1.0 : p);
+      tmin = (!parallel && p < 0.0) ? std::max(tmin, t) : tmin;
+      tmax = (!parallel && p > 0.0) ? std::min(tmax, t) : tmax;
+    };
+
+    update(-dx, ax[i] - b.min.x);
+    update( dx, b.max.x - ax[i]);
+    update(-dy, ay[i] - b.min.y);
+    update( dy, b.max.y - ay[i]);
+
+    hit[i] = static_cast<unsigned char>(hit[i] | (ok && tmin <= tmax));
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "analysis/AnalysisResult.hpp"
+#include "analysis/BatchAggregator.hpp"
+#include "core/Scene.hpp"
+
+// JSON form of maps, scenes and results.
+//
+//   map:   {"bounds": [minX, minY, maxX, maxY], "obstacles": [[minX, minY, maxX, maxY], ...]}
+//   agent: {"pos": [x, y], "facing": [x, y], "radius": r, "speed": v}
+//   scene: {"map": map, "self": agent, "enemy": agent,
+//           "T": t, "cell_size": c, "visibility_samples": n, "fov_degrees": f}
+//
+// Missing scalar fields keep the struct defaults; facings are normalized on
+// load. Malformed input throws nlohmann::json::exception.
+namespace SceneIO {
+
+using json = nlohmann::json;
+
+json mapToJson(const Map& map);
+Map mapFromJson(const json& j);
+
+json agentToJson(const Agent& agent);
+Agent agentFromJson(const json& j);
+
+json sceneToJson(const Scene& scene);
+
+// Without a "map" key the scene uses `fallbackMap` (a cheap snapshot copy).
+Scene sceneFromJson(const json& j, const Map* fallbackMap = nullptr);
+
+json resultToJson(const AnalysisResult& result);
+
+// {"count", "mean", "stddev", "min", "max", "p50", "p90", "p99"}
+json sketchToJson(const MetricSketch& sketch);
+// {"area_ratio": sketch, "exposure_width": ..., "visible_fraction": ...,
+//  "cancelled": n}, plus "total_ms", "peak_kb", "allocations" and
+//  "allocated_bytes" when any result carried stats.
+json summaryToJson(const ResultSummary& summary);
+
+// File helpers; load throws on a missing file as well as on bad JSON.
+Scene loadScene(const std::string& path);
+bool saveScene(const std::string& path, const Scene& scene);
+
+} // namespace SceneIO
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "core/Map.hpp"
+#include "server/ThreadPool.hpp"
+
+// Long-lived analysis service that keeps maps loaded between requests.
+//
+// Requests and responses are NDJSON: one JSON object per line. Every response
+// echoes the request's "id" and carries "ok" (with "error" when false).
+//
+//   {"id": 1, "op": "load_map", "map_id": "m", "map": {...},
+//    "pvs_cell_size": 0.5, "pvs_radius": 0.25}      -> {"obstacles": n, "pvs": true}
+//   {"id": 2, "op": "analyze", "map_id": "m", "scene": {...}} -> {"result": {...}}
+//   {"id": 3, "op": "drop_map", "map_id": "m"}
+//   {"id": 4, "op": "stats"}                        -> {"maps": n, "requests": n}
+//   {"id": 5, "op": "shutdown"}
+//
+// "op" defaults to "analyze". An analyze request may carry its own "map"
+// inside the scene instead of a "map_id". Loaded maps are shared snapshots,
+// so their derived structures (the optional visibility matrix, and anything
+// cached through Map::derived) are built once and reused by every request.
+//
+// serve() reads each connection on its own thread and hands requests to a
+// thread pool as they arrive, so analyze responses may come back out of
+// order. Any other op is an ordering point for its connection: it starts
+// once the connection's earlier requests are done, and later ones wait for
+// it. On shutdown, serve() stops accepting and reading, waits for every
+// accepted request to send its reply, and then closes the connections.
+// A connection whose unfinished line grows past kMaxLineBytes gets an
+// "ok": false reply once its earlier requests are answered, and is closed.
+class AnalysisServer {
+public:
+  static constexpr std::size_t kMaxLineBytes = std::size_t{4} << 20;
+
+  explicit AnalysisServer(int threads = 0); // 0 = hardware concurrency
+  ~AnalysisServer();
+
+  AnalysisServer(const AnalysisServer&) = delete;
+  AnalysisServer& operator=(const AnalysisServer&) = delete;
+
+  // One request line to one response line (no trailing newline). Thread-safe.
+  std::string handle(const std::string& line);
+
+  // Listens on a Unix domain socket until stop() or a "shutdown" request.
+  // Returns false if the socket cannot be set up (always on Windows).
+  bool serve(const std::string& socketPath);
+  void stop() { stopping_ = true; }
+  bool stopping() const { return stopping_; }
+
+  int loadedMaps() const;
+
+private:
+  ThreadPool pool_;
+
+  mutable std::shared_mutex mapsMutex_;
+  std::unordered_map<std::string, Map> maps_;
+
+  std::atomic<std::uint64_t> requests_{0};
+  std::atomic<bool> stopping_{false};
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+
+#include "core/Map.hpp"
+
+struct BatchOptions {
+  int processes = 0;        // worker processes; 0 = hardware concurrency
+  double pvsCellSize = 0.0; // > 0: build a visibility matrix for the map once, before forking
+  double pvsRadius = 0.0;
+  std::string pvsPath;      // existing matrix file for the map; used instead of building one (run() fails if built for another map)
+};
+
+struct BatchReport {
+  int scenes = 0;         // non-blank input lines
+  int failed = 0;         // output lines with "ok": false
+  int processes = 0;      // workers started
+  int crashedWorkers = 0; // exited abnormally; their unfinished scenes count as failed
+  std::string error;      // set when the batch could not run at all
+
+  bool ok() const { return error.empty(); }
+};
+
+// Analyzes a file of scenes with a pool of forked worker processes.
+//
+// The input has one scene JSON object per line, as in SceneIO; scenes
+// without a "map" use the runner's map. The output has one line per scene,
+// in input order, shaped like an AnalysisServer reply:
+//
+//   {"id": ..., "ok": true, "result": {...}}   ("id" echoed when the scene has one)
+//   {"id": ..., "ok": false, "error": "..."}
+//
+// The parent records the byte offset of every scene line while counting
+// them. Worker w seeks straight to its contiguous share of the scenes and
+// writes its replies to OUT.part<w>; once every worker has exited, the parts
+// are concatenated into OUT and removed. A worker that crashes only loses its
+// own unfinished scenes, which are reported as errors carrying the scene's
+// "id".
+//
+// Workers inherit the map from the parent. The visibility matrix, when there
+// is one, is saved to a file and memory-mapped by each worker, so all of
+// them read one copy from the page cache. Without fork (Windows) the scenes
+// run in this process.
+class BatchRunner {
+public:
+  explicit BatchRunner(Map map, BatchOptions options = {});
+
+  BatchReport run(const std::string& scenesPath, const std::string& outPath) const;
+
+private:
+  Map map_;
+  BatchOptions options_;
+};
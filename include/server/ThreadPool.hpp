@@ -0,0 +1,37 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a FIFO of tasks.
+class ThreadPool {
+public:
+  explicit ThreadPool(int threads = 0); // 0 = hardware concurrency
+  ~ThreadPool();                        // finishes queued tasks, then joins
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void submit(std::function<void()> task);
+
+  // Blocks until the queue is empty and no task is running.
+  void waitIdle();
+
+  int size() const { return static_cast<int>(workers_.size()); }
+
+private:
+  void run();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  std::deque<std::function<void()>> tasks_;
+  std::size_t running_ = 0;
+  bool stop_ = false;
+
+  std::vector<std::thread> workers_;
+};
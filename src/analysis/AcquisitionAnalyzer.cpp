@@ -0,0 +1,85 @@
+#include "analysis/AcquisitionAnalyzer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kHidden = 2.0; // cosine sentinel above any real value
+
+} // anonymous namespace
+
+AcquisitionResult AcquisitionAnalyzer::analyze(const Scene& scene,
+                                               const std::vector<Vec2>& enemyReachable,
+                                               const AcquisitionOptions& options,
+                                               const CancellationToken* cancel,
+                                               const std::vector<unsigned char>* losMask) const {
+  AcquisitionResult out;
+  const int n = static_cast<int>(enemyReachable.size());
+  out.totalEnemyReachable = n;
+
+  const double rate = std::max(options.turnRateDegPerSec, 1e-9) * kPi / 180.0; // rad/s
+  out.times = MetricSketch(0.0, kPi / rate, 256);
+  if (n == 0) return out;
+
+  const Vec2 self = scene.self.pos;
+  const Vec2 f = scene.self.facing.normalized();
+
+  // LoS pass, unless the caller already ran it
+  std::vector<unsigned char> tested;
+  if (!losMask || losMask->size() != static_cast<std::size_t>(n)) {
+    tested.resize(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) {
+      if ((i & 255) == 0 && isCancelled(cancel)) {
+        out.cancelled = true;
+        return out;
+      }
+      tested[i] = scene.map.hasLineOfSight(self, enemyReachable[i]) ? 1 : 0;
+    }
+    losMask = &tested;
+  }
+  const std::vector<unsigned char>& visible = *losMask;
+
+  // Cosine of the turn angle per point; kHidden where there is no LoS. A
+  // point on top of self needs no turn.
+  std::vector<double> dx(static_cast<std::size_t>(n)), dy(static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    dx[i] = enemyReachable[i].x - self.x;
+    dy[i] = enemyReachable[i].y - self.y;
+  }
+  std::vector<double> cosine(static_cast<std::size_t>(n));
+  double worstCos = kHidden;
+  int visibleCount = 0;
+  for (int i = 0; i < n; ++i) {
+    const double len = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+    const double dot = f.x * dx[i] + f.y * dy[i];
+    double c = len > 0.0 ? dot / len : 1.0;
+    c = std::min(1.0, std::max(-1.0, c));
+    c = visible[i] ? c : kHidden;
+    cosine[i] = c;
+    worstCos = std::min(worstCos, c);
+    visibleCount += visible[i];
+  }
+  out.visibleCount = visibleCount;
+
+  // Field and distribution
+  out.turnTime.resize(static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    if (cosine[i] == kHidden) {
+      out.turnTime[i] = -1.0;
+      continue;
+    }
+    const double t = std::acos(cosine[i]) / rate;
+    out.turnTime[i] = t;
+    out.times.add(t);
+  }
+
+  if (visibleCount > 0) {
+    const int worst = static_cast<int>(std::find(cosine.begin(), cosine.end(), worstCos) - cosine.begin());
+    out.worstAngle = std::acos(worstCos);
+    out.worstTime = out.worstAngle / rate;
+    out.worstPoint = enemyReachable[worst];
+  }
+  return out;
+}
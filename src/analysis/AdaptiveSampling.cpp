@@ -0,0 +1,40 @@
+#include "analysis/AdaptiveSampling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+void wilsonInterval(int hits, int n, int population, double z, double& lower, double& upper) {
+  if (n <= 0) {
+    lower = 0.0;
+    upper = 1.0;
+    return;
+  }
+  const double p = static_cast<double>(hits) / n;
+  if (population > 1 && n >= population) {
+    lower = upper = p;
+    return;
+  }
+  if (population > 1) {
+    z *= std::sqrt(static_cast<double>(population - n) / static_cast<double>(population - 1));
+  }
+
+  const double z2 = z * z;
+  const double denom = 1.0 + z2 / n;
+  const double centre = (p + z2 / (2.0 * n)) / denom;
+  const double half = z * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denom;
+  lower = std::max(0.0, centre - half);
+  upper = std::min(1.0, centre + half);
+}
+
+int goldenStride(int n) {
+  if (n <= 2) return 1;
+  const double invPhi = 0.6180339887498949;
+  const int target = std::max(1, static_cast<int>(std::lround(n * invPhi)));
+  for (int d = 0; d < n; ++d) {
+    for (int s : {target - d, target + d}) {
+      if (s >= 1 && s < n && std::gcd(s, n) == 1) return s;
+    }
+  }
+  return 1;
+}
@@ -0,0 +1,76 @@
+#include "analysis/AnalysisWorker.hpp"
+
+#include <utility>
+
+AnalysisWorker::AnalysisWorker()
+  : thread_([this] { run(); }) {}
+
+AnalysisWorker::~AnalysisWorker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    if (inFlight_) inFlight_->cancel();
+  }
+  wake_.notify_all();
+  thread_.join();
+}
+
+void AnalysisWorker::submit(Scene scene) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_ = std::move(scene);
+    submitted_++;
+    // The running job is stale now; let it bail out at its next check.
+    if (inFlight_) inFlight_->cancel();
+  }
+  wake_.notify_one();
+}
+
+std::optional<AnalysisResult> AnalysisWorker::poll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::optional<AnalysisResult> out = std::move(ready_);
+  ready_.reset();
+  return out;
+}
+
+bool AnalysisWorker::pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return published_ != submitted_;
+}
+
+void AnalysisWorker::waitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return published_ == submitted_ || stop_; });
+}
+
+void AnalysisWorker::run() {
+  while (true) {
+    Scene scene;
+    std::uint64_t generation = 0;
+    auto token = std::make_shared<CancellationToken>();
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stop_ || queued_.has_value(); });
+      if (stop_) return;
+
+      scene = std::move(*queued_);
+      queued_.reset();
+      generation = submitted_;
+      inFlight_ = token;
+    }
+
+    AnalysisResult result = analyzer_.analyze(scene, token.get());
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      inFlight_.reset();
+      // Only publish if nothing newer arrived while we were computing.
+      if (!result.cancelled && generation == submitted_) {
+        ready_ = std::move(result);
+        published_ = generation;
+      }
+    }
+    idle_.notify_all();
+  }
+}
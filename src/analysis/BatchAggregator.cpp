@@ -0,0 +1,54 @@
+#include "analysis/BatchAggregator.hpp"
+
+#include <algorithm>
+
+void ResultSummary::add(const AnalysisResult& result) {
+  if (result.cancelled) {
+    cancelled++;
+    return;
+  }
+  areaRatio.add(result.reachability.areaRatio);
+  exposureWidth.add(result.exposure.width);
+  visibleFraction.add(result.visibility.visibleFraction);
+  if (result.stats.enabled) {
+    totalMs.add(result.stats.totalMs);
+    peakKb.add(static_cast<double>(result.stats.alloc.peakBytes) / 1024.0);
+    allocations += result.stats.alloc.allocations;
+    allocatedBytes += result.stats.alloc.bytes;
+  }
+}
+
+void ResultSummary::merge(const ResultSummary& other) {
+  areaRatio.merge(other.areaRatio);
+  exposureWidth.merge(other.exposureWidth);
+  visibleFraction.merge(other.visibleFraction);
+  totalMs.merge(other.totalMs);
+  peakKb.merge(other.peakKb);
+  allocations += other.allocations;
+  allocatedBytes += other.allocatedBytes;
+  cancelled += other.cancelled;
+}
+
+void BatchAggregator::Shard::add(const AnalysisResult& result, const std::string& mapId) {
+  all_.add(result);
+  if (!mapId.empty()) byMap_[mapId].add(result);
+}
+
+BatchAggregator::BatchAggregator(int shards) {
+  shards_.reserve(static_cast<std::size_t>(std::max(1, shards)));
+  for (int i = 0; i < std::max(1, shards); ++i) shards_.push_back(std::make_unique<Shard>());
+}
+
+ResultSummary BatchAggregator::total() const {
+  ResultSummary out;
+  for (const auto& s : shards_) out.merge(s->all_);
+  return out;
+}
+
+std::map<std::string, ResultSummary> BatchAggregator::byMap() const {
+  std::map<std::string, ResultSummary> out;
+  for (const auto& s : shards_) {
+    for (const auto& [id, summary] : s->byMap_) out[id].merge(summary);
+  }
+  return out;
+}
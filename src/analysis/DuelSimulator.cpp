@@ -0,0 +1,206 @@
+#include "analysis/DuelSimulator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "analysis/ReachabilityAnalyzer.hpp"
+
+namespace {
+
+constexpr int kLanes = 64; // rollouts advanced together
+
+// Counter-based RNG: a splitmix64 finaliser over (seed, rollout, draw), so any
+// draw of any rollout can be produced without replaying a sequential stream.
+std::uint64_t mix(std::uint64_t z) {
+  z += 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+double uniform01(std::uint64_t seed, std::uint64_t rollout, std::uint64_t draw) {
+  const std::uint64_t bits = mix(mix(seed ^ mix(rollout)) + draw);
+  return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0); // [0, 1)
+}
+
+struct Tally {
+  std::int64_t selfWins = 0;
+  std::int64_t enemyWins = 0;
+  std::int64_t trades = 0;
+  std::int64_t noContact = 0;
+  std::int64_t unresolved = 0;
+  std::int64_t contactSteps = 0; // integer so the merge is order-independent
+};
+
+struct Lanes {
+  double sx0[kLanes], sy0[kLanes], sdx[kLanes], sdy[kLanes];
+  double ex0[kLanes], ey0[kLanes], edx[kLanes], edy[kLanes];
+  double ax[kLanes], ay[kLanes], bx[kLanes], by[kLanes];
+  double selfShot[kLanes], enemyShot[kLanes];
+  unsigned char visible[kLanes];
+  unsigned char selfLands[kLanes], enemyLands[kLanes];
+  int contact[kLanes];
+};
+
+// Whether each lane's shot, fired `reaction[l]` seconds after its contact
+// sub-step, lands: it must leave inside the window T, with the two agents
+// (still moving along their paths) in sight of each other at that moment.
+void landShots(const Scene& scene, int S, int count, const double* reaction, Lanes& L, unsigned char* lands) {
+  double f[kLanes];
+  for (int l = 0; l < count; ++l) {
+    f[l] = L.contact[l] < 0 ? 2.0 : static_cast<double>(L.contact[l]) / S + reaction[l] / scene.T;
+    const double g = std::min(f[l], 1.0);
+    L.ax[l] = L.sx0[l] + L.sdx[l] * g;
+    L.ay[l] = L.sy0[l] + L.sdy[l] * g;
+    L.bx[l] = L.ex0[l] + L.edx[l] * g;
+    L.by[l] = L.ey0[l] + L.edy[l] * g;
+  }
+  scene.map.hasLineOfSightBatch(L.ax, L.ay, L.bx, L.by, count, lands);
+  for (int l = 0; l < count; ++l) lands[l] = static_cast<unsigned char>(lands[l] && f[l] <= 1.0);
+}
+
+void runBlock(const Scene& scene,
+              const std::vector<Vec2>& selfDest,
+              const std::vector<Vec2>& enemyDest,
+              const DuelOptions& opt,
+              int first, int count,
+              Lanes& L, Tally& tally)
+{
+  const auto seed = opt.seed;
+  const int S = std::max(1, opt.subSteps);
+
+  for (int l = 0; l < count; ++l) {
+    const auto r = static_cast<std::uint64_t>(first + l);
+    const auto si = std::min(selfDest.size() - 1,
+                             static_cast<std::size_t>(uniform01(seed, r, 0) * selfDest.size()));
+    const auto ei = std::min(enemyDest.size() - 1,
+                             static_cast<std::size_t>(uniform01(seed, r, 1) * enemyDest.size()));
+
+    L.sx0[l] = scene.self.pos.x;
+    L.sy0[l] = scene.self.pos.y;
+    L.sdx[l] = selfDest[si].x - scene.self.pos.x;
+    L.sdy[l] = selfDest[si].y - scene.self.pos.y;
+    L.ex0[l] = scene.enemy.pos.x;
+    L.ey0[l] = scene.enemy.pos.y;
+    L.edx[l] = enemyDest[ei].x - scene.enemy.pos.x;
+    L.edy[l] = enemyDest[ei].y - scene.enemy.pos.y;
+
+    L.selfShot[l]  = opt.selfReaction  + opt.reactionJitter * (2.0 * uniform01(seed, r, 2) - 1.0);
+    L.enemyShot[l] = opt.enemyReaction + opt.reactionJitter * (2.0 * uniform01(seed, r, 3) - 1.0);
+    L.contact[l] = -1;
+  }
+
+  for (int k = 0; k <= S; ++k) {
+    const double f = static_cast<double>(k) / static_cast<double>(S);
+
+    for (int l = 0; l < count; ++l) {
+      L.ax[l] = L.sx0[l] + L.sdx[l] * f;
+      L.ay[l] = L.sy0[l] + L.sdy[l] * f;
+      L.bx[l] = L.ex0[l] + L.edx[l] * f;
+      L.by[l] = L.ey0[l] + L.edy[l] * f;
+    }
+
+    scene.map.hasLineOfSightBatch(L.ax, L.ay, L.bx, L.by, count, L.visible);
+
+    bool open = false;
+    for (int l = 0; l < count; ++l) {
+      const bool firstSight = (L.contact[l] < 0) && L.visible[l];
+      L.contact[l] = firstSight ? k : L.contact[l];
+      open = open || (L.contact[l] < 0);
+    }
+    if (!open) break;
+  }
+
+  landShots(scene, S, count, L.selfShot, L, L.selfLands);
+  landShots(scene, S, count, L.enemyShot, L, L.enemyLands);
+
+  for (int l = 0; l < count; ++l) {
+    if (L.contact[l] < 0) {
+      tally.noContact++;
+      continue;
+    }
+    tally.contactSteps += L.contact[l];
+
+    // Sight is mutual, so both clocks start at the same sub-step; the first
+    // shot that lands wins, and two landing shots within tradeWindow trade.
+    const bool selfLands = L.selfLands[l] != 0;
+    const bool enemyLands = L.enemyLands[l] != 0;
+    const double gap = L.selfShot[l] - L.enemyShot[l];
+    if (!selfLands && !enemyLands) tally.unresolved++;
+    else if (selfLands && enemyLands && std::abs(gap) <= opt.tradeWindow) tally.trades++;
+    else if (selfLands && (!enemyLands || gap < 0.0)) tally.selfWins++;
+    else tally.enemyWins++;
+  }
+}
+
+} // anonymous namespace
+
+DuelResult DuelSimulator::simulate(const Scene& scene, const DuelOptions& options) const {
+  DuelResult out;
+  out.rollouts = std::max(0, options.rollouts);
+  if (out.rollouts == 0) return out;
+
+  ReachabilityAnalyzer reach;
+  const auto sets = reach.analyze(scene);
+
+  // An agent with nowhere to go simply holds position.
+  std::vector<Vec2> selfDest = sets.reachableSelf;
+  std::vector<Vec2> enemyDest = sets.reachableEnemy;
+  if (selfDest.empty()) selfDest.push_back(scene.self.pos);
+  if (enemyDest.empty()) enemyDest.push_back(scene.enemy.pos);
+
+  const int blocks = (out.rollouts + kLanes - 1) / kLanes;
+  const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+  const int threads = std::clamp(options.threads > 0 ? options.threads : static_cast<int>(hw), 1, blocks);
+
+  std::vector<Tally> tallies(threads);
+  std::atomic<int> nextBlock{0};
+
+  auto worker = [&](int t) {
+    auto lanes = std::make_unique<Lanes>();
+    for (int b = nextBlock.fetch_add(1); b < blocks; b = nextBlock.fetch_add(1)) {
+      const int first = b * kLanes;
+      const int count = std::min(kLanes, out.rollouts - first);
+      runBlock(scene, selfDest, enemyDest, options, first, count, *lanes, tallies[t]);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+  worker(0);
+  for (auto& th : pool) th.join();
+
+  Tally total;
+  for (const auto& t : tallies) {
+    total.selfWins += t.selfWins;
+    total.enemyWins += t.enemyWins;
+    total.trades += t.trades;
+    total.noContact += t.noContact;
+    total.unresolved += t.unresolved;
+    total.contactSteps += t.contactSteps;
+  }
+
+  out.selfWins = static_cast<int>(total.selfWins);
+  out.enemyWins = static_cast<int>(total.enemyWins);
+  out.trades = static_cast<int>(total.trades);
+  out.noContact = static_cast<int>(total.noContact);
+  out.unresolved = static_cast<int>(total.unresolved);
+
+  const double n = static_cast<double>(out.rollouts);
+  out.selfWinRate = out.selfWins / n;
+  out.enemyWinRate = out.enemyWins / n;
+  out.tradeRate = out.trades / n;
+  out.noContactRate = out.noContact / n;
+  out.unresolvedRate = out.unresolved / n;
+
+  const std::int64_t contacts = out.rollouts - total.noContact;
+  if (contacts > 0) {
+    const double dt = scene.T / static_cast<double>(std::max(1, options.subSteps));
+    out.meanContactTime = static_cast<double>(total.contactSteps) * dt / static_cast<double>(contacts);
+  }
+  return out;
+}
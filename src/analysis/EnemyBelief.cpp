@@ -0,0 +1,222 @@
+#include "analysis/EnemyBelief.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Share of a cell's mass sent to each free neighbour per step. At 1/5 a cell
+// with four free neighbours keeps an equal share, and values stay >= 0.
+constexpr float kMove = 0.2f;
+
+constexpr std::uint8_t kUnknown = 0;
+constexpr std::uint8_t kHidden = 1;
+constexpr std::uint8_t kVisible = 2;
+
+constexpr int kBatch = 256; // cells per hasLineOfSightBatch call
+
+} // anonymous namespace
+
+EnemyBelief::EnemyBelief(const Map& map, const Agent& enemy, double cellSize)
+  : map_(map), enemy_(enemy), cell_(cellSize) {
+  const AABB& w = map_.worldBounds();
+  nx_ = std::max(1, static_cast<int>(std::ceil((w.max.x - w.min.x) / cell_)));
+  ny_ = std::max(1, static_cast<int>(std::ceil((w.max.y - w.min.y) / cell_)));
+  stride_ = static_cast<std::size_t>(nx_) + 2;
+
+  const std::size_t padded = stride_ * (static_cast<std::size_t>(ny_) + 2);
+  p_.assign(padded, 0.0f);
+  scratch_.assign(padded, 0.0f);
+  free_.assign(padded, 0.0f);
+  keep_.assign(padded, 1.0f);
+  seen_.assign(padded, kUnknown);
+  hiddenMask_.assign(padded, 1.0f);
+
+  for (int iy = 0; iy < ny_; ++iy) {
+    for (int ix = 0; ix < nx_; ++ix) {
+      free_[index(ix, iy)] = map_.collidesCircleAt(cellCenter(ix, iy), enemy_.radius) ? 0.0f : 1.0f;
+    }
+  }
+  for (int iy = 0; iy < ny_; ++iy) {
+    for (int ix = 0; ix < nx_; ++ix) {
+      const std::size_t i = index(ix, iy);
+      const float n = free_[i - 1] + free_[i + 1] + free_[i - stride_] + free_[i + stride_];
+      keep_[i] = 1.0f - kMove * n;
+    }
+  }
+
+  resetUniform();
+}
+
+Vec2 EnemyBelief::cellCenter(int ix, int iy) const {
+  const AABB& w = map_.worldBounds();
+  return Vec2{w.min.x + (ix + 0.5) * cell_, w.min.y + (iy + 0.5) * cell_};
+}
+
+void EnemyBelief::resetUniform() {
+  p_ = free_;
+  carry_ = 0.0;
+  normalize();
+}
+
+void EnemyBelief::observe(const Vec2& p) {
+  const AABB& w = map_.worldBounds();
+  int bx = std::clamp(static_cast<int>(std::floor((p.x - w.min.x) / cell_)), 0, nx_ - 1);
+  int by = std::clamp(static_cast<int>(std::floor((p.y - w.min.y) / cell_)), 0, ny_ - 1);
+
+  if (free_[index(bx, by)] == 0.0f) {
+    // Reported inside geometry (e.g. hugging a wall): snap to the nearest free cell.
+    double best = std::numeric_limits<double>::infinity();
+    for (int iy = 0; iy < ny_; ++iy) {
+      for (int ix = 0; ix < nx_; ++ix) {
+        if (free_[index(ix, iy)] == 0.0f) continue;
+        const double d = dist(cellCenter(ix, iy), p);
+        if (d < best) { best = d; bx = ix; by = iy; }
+      }
+    }
+    if (best == std::numeric_limits<double>::infinity()) return; // no free cell at all
+  }
+
+  std::fill(p_.begin(), p_.end(), 0.0f);
+  p_[index(bx, by)] = 1.0f;
+  carry_ = 0.0;
+}
+
+void EnemyBelief::spreadStep() {
+  // Mass conserving: a free cell keeps keep_[i] of its mass and sends kMove to
+  // each free neighbour; blocked cells and the halo hold and receive nothing.
+  const std::size_t s = stride_;
+  const float* p = p_.data();
+  const float* keep = keep_.data();
+  const float* mask = free_.data();
+  float* out = scratch_.data();
+
+  for (int iy = 0; iy < ny_; ++iy) {
+    const std::size_t row = static_cast<std::size_t>(iy + 1) * s + 1;
+    for (std::size_t i = row; i < row + static_cast<std::size_t>(nx_); ++i) {
+      const float in = p[i - 1] + p[i + 1] + p[i - s] + p[i + s];
+      out[i] = mask[i] * (keep[i] * p[i] + kMove * in);
+    }
+  }
+  p_.swap(scratch_);
+}
+
+int EnemyBelief::updateVisibility(const Vec2& selfPos) {
+  if (!haveSelf_ || selfPos.x != lastSelf_.x || selfPos.y != lastSelf_.y) {
+    std::fill(seen_.begin(), seen_.end(), kUnknown);
+    std::fill(hiddenMask_.begin(), hiddenMask_.end(), 1.0f);
+    lastSelf_ = selfPos;
+    haveSelf_ = true;
+  }
+
+  // Only cells that hold mass need an answer; the rest wait until they do.
+  double ax[kBatch], ay[kBatch], bx[kBatch], by[kBatch];
+  std::size_t idx[kBatch];
+  unsigned char visible[kBatch];
+  int pending = 0;
+  int checks = 0;
+
+  auto flush = [&] {
+    map_.hasLineOfSightBatch(ax, ay, bx, by, pending, visible);
+    for (int k = 0; k < pending; ++k) {
+      seen_[idx[k]] = visible[k] ? kVisible : kHidden;
+      hiddenMask_[idx[k]] = visible[k] ? 0.0f : 1.0f;
+    }
+    checks += pending;
+    pending = 0;
+  };
+
+  for (int iy = 0; iy < ny_; ++iy) {
+    for (int ix = 0; ix < nx_; ++ix) {
+      const std::size_t i = index(ix, iy);
+      if (p_[i] <= 0.0f || seen_[i] != kUnknown) continue;
+
+      const Vec2 c = cellCenter(ix, iy);
+      ax[pending] = selfPos.x;
+      ay[pending] = selfPos.y;
+      bx[pending] = c.x;
+      by[pending] = c.y;
+      idx[pending] = i;
+      if (++pending == kBatch) flush();
+    }
+  }
+  if (pending > 0) flush();
+  return checks;
+}
+
+void EnemyBelief::normalize() {
+  double total = 0.0;
+  for (float v : p_) total += v;
+  if (total <= 0.0) return;
+  const float inv = static_cast<float>(1.0 / total);
+  for (float& v : p_) v *= inv;
+}
+
+BeliefTick EnemyBelief::tick(double dt, const Vec2& selfPos) {
+  BeliefTick out;
+
+  // 1) Spread: one step moves mass at most one cell, so spend whole cells of
+  // movement only and carry the remainder into the next tick.
+  carry_ += std::max(0.0, enemy_.speed * dt) / cell_;
+  out.spreadSteps = static_cast<int>(std::floor(carry_));
+  carry_ -= out.spreadSteps;
+  for (int k = 0; k < out.spreadSteps; ++k) spreadStep();
+
+  // 2) Prune what self can see.
+  out.losChecks = updateVisibility(selfPos);
+
+  double pruned = 0.0, kept = 0.0;
+  const float* mask = hiddenMask_.data();
+  float* p = p_.data();
+  for (std::size_t i = 0; i < p_.size(); ++i) {
+    const float before = p[i];
+    p[i] = before * mask[i];
+    pruned += before - p[i];
+    kept += p[i];
+  }
+  if (pruned + kept > 0.0) out.prunedMass = pruned / (pruned + kept);
+
+  if (kept > 0.0) {
+    normalize();
+    return out;
+  }
+
+  // Self sees every cell the enemy could be in, yet does not see the enemy:
+  // the model was wrong, so start over from anywhere self cannot see.
+  out.contradiction = true;
+  p_ = free_;
+  out.losChecks += updateVisibility(selfPos);
+  for (std::size_t i = 0; i < p_.size(); ++i) p_[i] *= hiddenMask_[i];
+  normalize();
+  if (totalMass() <= 0.0) resetUniform();
+  return out;
+}
+
+double EnemyBelief::probabilityAt(const Vec2& p) const {
+  const AABB& w = map_.worldBounds();
+  if (!w.contains(p)) return 0.0;
+  const int ix = std::clamp(static_cast<int>(std::floor((p.x - w.min.x) / cell_)), 0, nx_ - 1);
+  const int iy = std::clamp(static_cast<int>(std::floor((p.y - w.min.y) / cell_)), 0, ny_ - 1);
+  return probability(ix, iy);
+}
+
+double EnemyBelief::totalMass() const {
+  double total = 0.0;
+  for (float v : p_) total += v;
+  return total;
+}
+
+Vec2 EnemyBelief::mean() const {
+  double sx = 0.0, sy = 0.0, total = 0.0;
+  for (int iy = 0; iy < ny_; ++iy) {
+    for (int ix = 0; ix < nx_; ++ix) {
+      const double v = p_[index(ix, iy)];
+      const Vec2 c = cellCenter(ix, iy);
+      sx += v * c.x;
+      sy += v * c.y;
+      total += v;
+    }
+  }
+  return (total > 0.0) ? Vec2{sx / total, sy / total} : Vec2{};
+}
@@ -1,11 +1,17 @@
 #include "analysis/ExposureAnalyzer.hpp"
+#include "geom/ConvexHull.hpp"
 #include "geom/Vec2.hpp"
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 ExposureResult ExposureAnalyzer::analyze(const Scene& scene,
-                                         const std::vector<Vec2>& enemyReachable) const {
+                                         const std::vector<Vec2>& enemyReachable,
+                                         const CancellationToken* cancel,
+                                         std::vector<unsigned char>* losMask) const {
   ExposureResult out;
   out.totalEnemyReachable = static_cast<int>(enemyReachable.size());
+  if (losMask) losMask->assign(enemyReachable.size(), 0);
   if (enemyReachable.empty()) return out;
 
   const Vec2 f = scene.self.facing.normalized();
@@ -14,8 +20,23 @@ ExposureResult ExposureAnalyzer::analyze(const Scene& scene,
   double minS = std::numeric_limits<double>::infinity();
   double maxS = -std::numeric_limits<double>::infinity();
 
-  for (const auto& p : enemyReachable) {
-    if (!scene.map.hasLineOfSight(scene.self.pos, p)) continue;
+  for (std::size_t i = 0; i < enemyReachable.size(); ++i) {
+    if (isCancelled(cancel)) {
+      out.cancelled = true;
+      if (losMask) losMask->clear(); // never hand on a half-filled mask
+      return out;
+    }
+
+    // With a mask every point needs its LoS; without one the FOV test
+    // goes first and saves the LoS tests behind self.
+    const Vec2& p = enemyReachable[i];
+    if (losMask) {
+      (*losMask)[i] = scene.map.hasLineOfSight(scene.self.pos, p) ? 1 : 0;
+      if (!(*losMask)[i] || !inFieldOfView(f, scene.fovDegrees, p - scene.self.pos)) continue;
+    } else {
+      if (!inFieldOfView(f, scene.fovDegrees, p - scene.self.pos)) continue;
+      if (!scene.map.hasLineOfSight(scene.self.pos, p)) continue;
+    }
 
     out.losCount++;
     const double s = (p - scene.self.pos).dot(axis);
@@ -26,3 +47,114 @@ ExposureResult ExposureAnalyzer::analyze(const Scene& scene,
   if (out.losCount > 0) out.width = (maxS - minS);
   return out;
 }
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double modPi(double a) {
+  a = std::fmod(a, kPi);
+  return a < 0.0 ? a + kPi : a;
+}
+
+Vec2 axisAt(double facingAngle) {
+  return perp(Vec2{std::cos(facingAngle), std::sin(facingAngle)});
+}
+
+} // anonymous namespace
+
+double ExposureProfile::widthAt(double facingAngle) const {
+  if (pieces.empty()) return 0.0;
+  double t = modPi(facingAngle);
+  if (t < pieces.front().start) t += kPi;
+  auto it = std::upper_bound(pieces.begin(), pieces.end(), t,
+                             [](double v, const Piece& p) { return v < p.start; });
+  const Piece& p = *(it == pieces.begin() ? it : it - 1);
+  return std::max(0.0, p.span.dot(axisAt(t)));
+}
+
+ExposureProfile::FacingWidth ExposureProfile::narrowest() const {
+  // Each piece is a non-negative arc of a sinusoid, so concave: its minimum
+  // is at an end.
+  FacingWidth best{0.0, pieces.empty() ? 0.0 : std::numeric_limits<double>::infinity()};
+  for (const auto& p : pieces) {
+    const double w = widthAt(p.start);
+    if (w < best.width) best = {modPi(p.start), w};
+  }
+  return best;
+}
+
+ExposureProfile::FacingWidth ExposureProfile::widest() const {
+  FacingWidth best;
+  for (const auto& p : pieces) {
+    // Peak where perp(facing) is parallel to span, if inside the piece.
+    double peak = modPi(std::atan2(p.span.y, p.span.x) - kPi / 2);
+    if (peak < p.start) peak += kPi;
+    for (double t : {p.start, p.end, peak}) {
+      if (t < p.start || t > p.end) continue;
+      const double w = std::max(0.0, p.span.dot(axisAt(t)));
+      if (w > best.width) best = {modPi(t), w};
+    }
+  }
+  return best;
+}
+
+ExposureProfile ExposureAnalyzer::profile(const Scene& scene,
+                                          const std::vector<Vec2>& enemyReachable,
+                                          const CancellationToken* cancel) const {
+  ExposureProfile out;
+  out.totalEnemyReachable = static_cast<int>(enemyReachable.size());
+
+  std::vector<Vec2> seen;
+  for (const auto& p : enemyReachable) {
+    if (isCancelled(cancel)) {
+      out.cancelled = true;
+      return out;
+    }
+    if (scene.map.hasLineOfSight(scene.self.pos, p)) seen.push_back(p);
+  }
+  out.losCount = static_cast<int>(seen.size());
+
+  // Points relative to self, as analyze() projects them.
+  for (auto& p : seen) p = p - scene.self.pos;
+  out.hull = convexHull(std::move(seen));
+  const std::size_t h = out.hull.size();
+  if (h < 2) {
+    if (h == 1) out.pieces.push_back({0.0, kPi, Vec2{}});
+    for (auto& p : out.hull) p = p + scene.self.pos;
+    return out;
+  }
+
+  // The extreme pair changes when the facing is parallel to a hull edge.
+  std::vector<double> breaks;
+  breaks.reserve(h);
+  for (std::size_t i = 0; i < h; ++i) {
+    const Vec2 e = out.hull[(i + 1) % h] - out.hull[i];
+    breaks.push_back(modPi(std::atan2(e.y, e.x)));
+  }
+  std::sort(breaks.begin(), breaks.end());
+  breaks.erase(std::unique(breaks.begin(), breaks.end(),
+                           [](double a, double b) { return b - a < 1e-12; }), breaks.end());
+
+  // Rotating calipers: both extreme vertices advance CCW as the facing turns.
+  std::size_t hi = 0, lo = 0;
+  for (std::size_t j = 0; j < breaks.size(); ++j) {
+    const double start = breaks[j];
+    const double end = (j + 1 < breaks.size()) ? breaks[j + 1] : breaks[0] + kPi;
+    const Vec2 axis = axisAt(0.5 * (start + end));
+
+    if (j == 0) {
+      for (std::size_t i = 1; i < h; ++i) {
+        if (out.hull[i].dot(axis) > out.hull[hi].dot(axis)) hi = i;
+        if (out.hull[i].dot(axis) < out.hull[lo].dot(axis)) lo = i;
+      }
+    } else {
+      while (out.hull[(hi + 1) % h].dot(axis) > out.hull[hi].dot(axis)) hi = (hi + 1) % h;
+      while (out.hull[(lo + 1) % h].dot(axis) < out.hull[lo].dot(axis)) lo = (lo + 1) % h;
+    }
+    out.pieces.push_back({start, end, out.hull[hi] - out.hull[lo]});
+  }
+
+  for (auto& p : out.hull) p = p + scene.self.pos;
+  return out;
+}
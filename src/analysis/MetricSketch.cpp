@@ -0,0 +1,94 @@
+#include "analysis/MetricSketch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+MetricSketch::MetricSketch(double lo, double hi, int buckets)
+  : lo_(lo), hi_(hi > lo ? hi : lo + 1.0), counts_(static_cast<std::size_t>(std::max(1, buckets)), 0) {
+  scale_ = static_cast<double>(counts_.size()) / (hi_ - lo_);
+}
+
+void MetricSketch::add(double v) {
+  if (std::isnan(v)) return;
+
+  if (count_ == 0) {
+    min_ = max_ = v;
+  } else {
+    min_ = std::min(min_, v);
+    max_ = std::max(max_, v);
+  }
+  count_++;
+  const double delta = v - mean_;
+  mean_ += delta / static_cast<double>(count_);
+  m2_ += delta * (v - mean_);
+
+  if (v < lo_) {
+    under_++;
+  } else if (v >= hi_) {
+    over_++;
+  } else {
+    const auto b = static_cast<std::size_t>((v - lo_) * scale_);
+    counts_[std::min(b, counts_.size() - 1)]++;
+  }
+}
+
+bool MetricSketch::merge(const MetricSketch& other) {
+  if (other.lo_ != lo_ || other.hi_ != hi_ || other.counts_.size() != counts_.size()) return false;
+  if (other.count_ == 0) return true;
+  if (count_ == 0) {
+    *this = other;
+    return true;
+  }
+
+  const double na = static_cast<double>(count_);
+  const double nb = static_cast<double>(other.count_);
+  const double n = na + nb;
+  const double delta = other.mean_ - mean_;
+  mean_ += delta * nb / n;
+  m2_ += other.m2_ + delta * delta * na * nb / n;
+  count_ += other.count_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+
+  under_ += other.under_;
+  over_ += other.over_;
+  for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+  return true;
+}
+
+double MetricSketch::variance() const {
+  return count_ > 0 ? m2_ / static_cast<double>(count_) : 0.0;
+}
+
+double MetricSketch::stddev() const {
+  return std::sqrt(variance());
+}
+
+double MetricSketch::quantile(double q) const {
+  if (count_ == 0) return 0.0;
+  q = std::clamp(q, 0.0, 1.0);
+  if (q == 0.0) return min_;
+  if (q == 1.0) return max_;
+
+  // Rank in [0, count); find the bucket holding it and interpolate.
+  const double rank = q * static_cast<double>(count_);
+  auto within = [&](double lower, double upper, double seen, std::uint64_t n) {
+    const double t = (rank - seen) / static_cast<double>(n);
+    return std::clamp(lower + t * (upper - lower), min_, max_);
+  };
+
+  double seen = 0.0;
+  if (rank < seen + static_cast<double>(under_)) return within(min_, lo_, seen, under_);
+  seen += static_cast<double>(under_);
+
+  const double width = (hi_ - lo_) / static_cast<double>(counts_.size());
+  for (std::size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] == 0) continue;
+    if (rank < seen + static_cast<double>(counts_[i])) {
+      const double lower = lo_ + width * static_cast<double>(i);
+      return within(lower, lower + width, seen, counts_[i]);
+    }
+    seen += static_cast<double>(counts_[i]);
+  }
+  return over_ > 0 ? within(hi_, max_, seen, over_) : max_;
+}
@@ -0,0 +1,313 @@
+#include "analysis/MutualVisibilityAnalyzer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "geom/ConvexHull.hpp"
+#include "geom/Raycast.hpp"
+
+namespace {
+
+struct Cluster {
+  AABB bounds;
+  int begin = 0;
+  int end = 0;
+  int left = -1; // children, -1 for leaves
+  int right = -1;
+  double weight = 0.0;
+
+  int size() const { return end - begin; }
+  bool leaf() const { return left < 0; }
+};
+
+struct ClusterTree {
+  std::vector<Vec2> points;
+  std::vector<double> weights;
+  std::vector<Cluster> nodes; // nodes[0] is the root
+
+  ClusterTree(const std::vector<Vec2>& pts, const Vec2& start, double reach,
+              bool byArrival, int leafSize)
+    : points(pts) {
+    if (points.empty()) return;
+    build(0, static_cast<int>(points.size()), std::max(1, leafSize));
+    weights.resize(points.size(), 1.0);
+    if (byArrival && reach > 0.0) {
+      for (std::size_t i = 0; i < points.size(); ++i) {
+        weights[i] = std::max(0.0, 1.0 - dist(points[i], start) / reach);
+      }
+    }
+    sumWeights(0);
+  }
+
+  int build(int begin, int end, int leafSize) {
+    const int id = static_cast<int>(nodes.size());
+    nodes.push_back({});
+    AABB b{points[begin], points[begin]};
+    for (int i = begin + 1; i < end; ++i) {
+      b.min.x = std::min(b.min.x, points[i].x);
+      b.min.y = std::min(b.min.y, points[i].y);
+      b.max.x = std::max(b.max.x, points[i].x);
+      b.max.y = std::max(b.max.y, points[i].y);
+    }
+    nodes[id].bounds = b;
+    nodes[id].begin = begin;
+    nodes[id].end = end;
+    if (end - begin <= leafSize) return id;
+
+    const bool splitX = (b.max.x - b.min.x) >= (b.max.y - b.min.y);
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(points.begin() + begin, points.begin() + mid, points.begin() + end,
+                     [splitX](const Vec2& p, const Vec2& q) { return splitX ? p.x < q.x : p.y < q.y; });
+    const int l = build(begin, mid, leafSize);
+    const int r = build(mid, end, leafSize);
+    nodes[id].left = l;
+    nodes[id].right = r;
+    return id;
+  }
+
+  double sumWeights(int id) {
+    Cluster& c = nodes[id];
+    if (c.leaf()) {
+      for (int i = c.begin; i < c.end; ++i) c.weight += weights[i];
+    } else {
+      c.weight = sumWeights(c.left) + sumWeights(c.right);
+    }
+    return c.weight;
+  }
+};
+
+struct Tally {
+  double visibleWeight = 0.0;
+  std::uint64_t visiblePairs = 0;
+  std::uint64_t losTests = 0;
+  std::uint64_t culledVisible = 0;
+  std::uint64_t culledBlocked = 0;
+};
+
+void corners(const AABB& b, Vec2 out[4]) {
+  out[0] = b.min;
+  out[1] = Vec2{b.max.x, b.min.y};
+  out[2] = b.max;
+  out[3] = Vec2{b.min.x, b.max.y};
+}
+
+// Obstacles from `candidates` that touch the convex hull of both boxes. Any
+// segment between the boxes lies in that hull, so only these can block one.
+std::vector<int> obstaclesInHull(const Map& map, const std::vector<int>& candidates,
+                                 const AABB& a, const AABB& b) {
+  std::vector<Vec2> pts(8);
+  corners(a, pts.data());
+  corners(b, pts.data() + 4);
+  const AABB box{Vec2{std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)},
+                 Vec2{std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y)}};
+  const std::vector<Vec2> hull = convexHull(std::move(pts));
+  constexpr double kEps = 1e-9;
+
+  std::vector<int> out;
+  for (int k : candidates) {
+    const AABB& ob = map.obstacles()[static_cast<std::size_t>(k)];
+    if (ob.min.x > box.max.x + kEps || ob.max.x < box.min.x - kEps ||
+        ob.min.y > box.max.y + kEps || ob.max.y < box.min.y - kEps) continue;
+
+    // Separating axis among the hull's edge normals? (Degenerate hulls keep
+    // every box that overlaps their bounds.)
+    Vec2 oc[4];
+    corners(ob, oc);
+    bool separated = false;
+    for (std::size_t i = 0; hull.size() >= 3 && i < hull.size() && !separated; ++i) {
+      const Vec2& p = hull[i];
+      const Vec2& q = hull[(i + 1) % hull.size()];
+      separated = true;
+      for (const Vec2& c : oc) {
+        if (cross(p, q, c) >= -kEps) { separated = false; break; }
+      }
+    }
+    if (!separated) out.push_back(k);
+  }
+  return out;
+}
+
+// One obstacle crosses all 16 corner-to-corner segments.
+bool allBlocked(const Map& map, const std::vector<int>& candidates, const AABB& a, const AABB& b) {
+  Vec2 ca[4], cb[4];
+  corners(a, ca);
+  corners(b, cb);
+  for (int k : candidates) {
+    const AABB& ob = map.obstacles()[static_cast<std::size_t>(k)];
+    bool all = true;
+    for (int i = 0; i < 4 && all; ++i) {
+      for (int j = 0; j < 4 && all; ++j) all = segmentIntersectsAABB(ca[i], cb[j], ob);
+    }
+    if (all) return true;
+  }
+  return false;
+}
+
+struct Context {
+  const Map& map;
+  const ClusterTree& self;
+  const ClusterTree& enemy;
+  const CancellationToken* cancel;
+};
+
+// Settles the pair into the tally if its bounds allow; otherwise returns
+// false with `blockers` set to the obstacles that can still matter.
+bool settle(const Context& ctx, const Cluster& a, const Cluster& b,
+            const std::vector<int>& candidates, std::vector<int>& blockers, Tally& t) {
+  const auto pairs = static_cast<std::uint64_t>(a.size()) * static_cast<std::uint64_t>(b.size());
+  blockers = obstaclesInHull(ctx.map, candidates, a.bounds, b.bounds);
+  if (blockers.empty()) {
+    t.visibleWeight += a.weight * b.weight;
+    t.visiblePairs += pairs;
+    t.culledVisible += pairs;
+    return true;
+  }
+  if (allBlocked(ctx.map, blockers, a.bounds, b.bounds)) {
+    t.culledBlocked += pairs;
+    return true;
+  }
+  return false;
+}
+
+// Same answers as Map::hasLineOfSight: reachable points are in bounds, and
+// only `blockers` can cross the segment.
+void exactPairs(const Context& ctx, const Cluster& a, const Cluster& b,
+                const std::vector<int>& blockers, Tally& t) {
+  const auto& obstacles = ctx.map.obstacles();
+  for (int i = a.begin; i < a.end; ++i) {
+    for (int j = b.begin; j < b.end; ++j) {
+      t.losTests++;
+      const Vec2& p = ctx.self.points[i];
+      const Vec2& q = ctx.enemy.points[j];
+      bool clear = true;
+      for (int k : blockers) {
+        if (segmentIntersectsAABB(p, q, obstacles[static_cast<std::size_t>(k)])) { clear = false; break; }
+      }
+      if (clear) {
+        t.visiblePairs++;
+        t.visibleWeight += ctx.self.weights[i] * ctx.enemy.weights[j];
+      }
+    }
+  }
+}
+
+// Splits the cluster with more points. False when both are leaves.
+bool split(const Context& ctx, int ia, int ib, std::pair<int, int> out[2]) {
+  const Cluster& a = ctx.self.nodes[ia];
+  const Cluster& b = ctx.enemy.nodes[ib];
+  if (a.leaf() && b.leaf()) return false;
+  if (!a.leaf() && (b.leaf() || a.size() >= b.size())) {
+    out[0] = {a.left, ib};
+    out[1] = {a.right, ib};
+  } else {
+    out[0] = {ia, b.left};
+    out[1] = {ia, b.right};
+  }
+  return true;
+}
+
+struct Task {
+  int a;
+  int b;
+  std::vector<int> candidates;
+};
+
+void evaluate(const Context& ctx, int ia, int ib, const std::vector<int>& candidates, Tally& t) {
+  const Cluster& a = ctx.self.nodes[ia];
+  const Cluster& b = ctx.enemy.nodes[ib];
+  std::vector<int> blockers;
+  if (settle(ctx, a, b, candidates, blockers, t)) return;
+  if (isCancelled(ctx.cancel)) return;
+
+  std::pair<int, int> children[2];
+  if (!split(ctx, ia, ib, children)) {
+    exactPairs(ctx, a, b, blockers, t);
+    return;
+  }
+  evaluate(ctx, children[0].first, children[0].second, blockers, t);
+  evaluate(ctx, children[1].first, children[1].second, blockers, t);
+}
+
+} // anonymous namespace
+
+MutualVisibilityResult MutualVisibilityAnalyzer::analyze(const Scene& scene,
+                                                         const ReachabilityResult& reach,
+                                                         const MutualVisibilityOptions& options,
+                                                         const CancellationToken* cancel) const {
+  MutualVisibilityResult out;
+  out.pairs = static_cast<std::uint64_t>(reach.reachableSelf.size()) *
+              static_cast<std::uint64_t>(reach.reachableEnemy.size());
+  if (out.pairs == 0) return out;
+
+  const ClusterTree self(reach.reachableSelf, scene.self.pos, scene.self.speed * scene.T,
+                         options.weightByArrival, options.leafSize);
+  const ClusterTree enemy(reach.reachableEnemy, scene.enemy.pos, scene.enemy.speed * scene.T,
+                          options.weightByArrival, options.leafSize);
+  const Context ctx{scene.map, self, enemy, cancel};
+
+  // Expand the top of the pair tree serially until there is enough
+  // independent work to spread over the threads.
+  const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+  const int threads = std::max(1, options.threads > 0 ? options.threads : static_cast<int>(hw));
+
+  std::vector<int> all(scene.map.obstacles().size());
+  for (std::size_t k = 0; k < all.size(); ++k) all[k] = static_cast<int>(k);
+
+  Tally serial;
+  std::vector<Task> frontier;
+  frontier.push_back({0, 0, std::move(all)});
+  std::vector<Task> tasks;
+  while (!frontier.empty() && frontier.size() + tasks.size() < static_cast<std::size_t>(8 * threads)) {
+    std::vector<Task> next;
+    for (auto& task : frontier) {
+      std::vector<int> blockers;
+      if (settle(ctx, self.nodes[task.a], enemy.nodes[task.b], task.candidates, blockers, serial)) continue;
+      std::pair<int, int> children[2];
+      if (split(ctx, task.a, task.b, children)) {
+        next.push_back({children[0].first, children[0].second, blockers});
+        next.push_back({children[1].first, children[1].second, std::move(blockers)});
+      } else {
+        tasks.push_back(std::move(task));
+      }
+    }
+    frontier = std::move(next);
+  }
+  for (auto& task : frontier) tasks.push_back(std::move(task));
+
+  const int workers = std::clamp(static_cast<int>(tasks.size()), 1, threads);
+  std::vector<Tally> tallies(workers);
+  std::atomic<std::size_t> nextTask{0};
+
+  auto worker = [&](int w) {
+    for (std::size_t i = nextTask.fetch_add(1); i < tasks.size(); i = nextTask.fetch_add(1)) {
+      if (isCancelled(cancel)) return;
+      evaluate(ctx, tasks[i].a, tasks[i].b, tasks[i].candidates, tallies[w]);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int w = 1; w < workers; ++w) pool.emplace_back(worker, w);
+  worker(0);
+  for (auto& th : pool) th.join();
+
+  if (isCancelled(cancel)) {
+    out.cancelled = true;
+    return out;
+  }
+
+  tallies.push_back(serial);
+  double visibleWeight = 0.0;
+  for (const auto& t : tallies) {
+    visibleWeight += t.visibleWeight;
+    out.visiblePairs += t.visiblePairs;
+    out.losTests += t.losTests;
+    out.culledVisible += t.culledVisible;
+    out.culledBlocked += t.culledBlocked;
+  }
+
+  const double totalWeight = self.nodes[0].weight * enemy.nodes[0].weight;
+  out.fraction = totalWeight > 0.0 ? visibleWeight / totalWeight : 0.0;
+  return out;
+}
@@ -0,0 +1,150 @@
+#include "analysis/ParameterSweep.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "analysis/VisibilityAnalyzer.hpp"
+
+namespace {
+
+template <class T>
+std::vector<T> axisOr(const std::vector<T>& axis, T fallback) {
+  return axis.empty() ? std::vector<T>{fallback} : axis;
+}
+
+// Free lattice points around `center` sorted by distance, so that the
+// reachable set for radius r is the prefix with dist <= r.
+struct RadialLattice {
+  std::vector<double> dist; // ascending
+
+  // Number of points within r.
+  int within(double r) const {
+    return static_cast<int>(std::upper_bound(dist.begin(), dist.end(), r) - dist.begin());
+  }
+};
+
+// The candidate points ReachabilityAnalyzer would test for radius maxR, in
+// the same arithmetic, that do not collide.
+std::vector<std::pair<double, Vec2>> freeLattice(const Map& map, const Vec2& center, double maxR,
+                                                 double cellSize, double agentRadius) {
+  std::vector<std::pair<double, Vec2>> out;
+  const int steps = static_cast<int>(std::ceil(maxR / cellSize));
+  for (int dx = -steps; dx <= steps; ++dx) {
+    for (int dy = -steps; dy <= steps; ++dy) {
+      const Vec2 p{center.x + dx * cellSize, center.y + dy * cellSize};
+      const double d = (p - center).norm();
+      if (d > maxR) continue;
+      if (map.collidesCircleAt(p, agentRadius)) continue;
+      out.push_back({d, p});
+    }
+  }
+  std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  return out;
+}
+
+// Enemy lattice with LoS from self folded into prefix aggregates.
+struct ExposurePrefix {
+  RadialLattice lattice;
+  std::vector<int> losCount; // [i] = LoS points among the first i + 1
+  std::vector<double> minS;
+  std::vector<double> maxS;
+};
+
+} // anonymous namespace
+
+SweepResult ParameterSweep::run(const Scene& base,
+                                const SweepAxes& axes,
+                                const CancellationToken* cancel) const {
+  SweepResult out;
+  out.T = axisOr(axes.T, base.T);
+  out.cellSize = axisOr(axes.cellSize, base.cellSize);
+  out.selfSpeed = axisOr(axes.selfSpeed, base.self.speed);
+  out.enemySpeed = axisOr(axes.enemySpeed, base.enemy.speed);
+  out.visibilitySamples = axisOr(axes.visibilitySamples, base.visibilitySamples);
+  out.cells.resize(out.T.size() * out.cellSize.size() * out.selfSpeed.size() *
+                   out.enemySpeed.size() * out.visibilitySamples.size());
+
+  // Visibility: one analysis per sample count.
+  std::vector<VisibilityResult> visibility;
+  for (int samples : out.visibilitySamples) {
+    Scene scene = base;
+    scene.visibilitySamples = samples;
+    visibility.push_back(VisibilityAnalyzer().analyze(scene, scene.self.pos, scene.enemy, cancel));
+    if (visibility.back().cancelled) {
+      out.cancelled = true;
+      return out;
+    }
+  }
+
+  // Reachability and exposure: the lattices go out to the largest radius,
+  // computed the same way ReachabilityAnalyzer does.
+  double maxSelfR = 0.0, maxEnemyR = 0.0;
+  for (double t : out.T) {
+    for (double v : out.selfSpeed) maxSelfR = std::max(maxSelfR, v * t);
+    for (double v : out.enemySpeed) maxEnemyR = std::max(maxEnemyR, v * t);
+  }
+
+  const Vec2 facing = base.self.facing.normalized();
+  const Vec2 axis = perp(facing);
+
+  for (std::size_t iCell = 0; iCell < out.cellSize.size(); ++iCell) {
+    if (isCancelled(cancel)) {
+      out.cancelled = true;
+      return out;
+    }
+    const double cell = out.cellSize[iCell];
+
+    RadialLattice self;
+    for (const auto& [d, p] : freeLattice(base.map, base.self.pos, maxSelfR, cell, base.self.radius)) {
+      self.dist.push_back(d);
+    }
+
+    ExposurePrefix enemy;
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -std::numeric_limits<double>::infinity();
+    int los = 0;
+    for (const auto& [d, p] : freeLattice(base.map, base.enemy.pos, maxEnemyR, cell, base.enemy.radius)) {
+      if (inFieldOfView(facing, base.fovDegrees, p - base.self.pos) &&
+          base.map.hasLineOfSight(base.self.pos, p)) {
+        los++;
+        const double s = (p - base.self.pos).dot(axis);
+        lo = std::min(lo, s);
+        hi = std::max(hi, s);
+      }
+      enemy.lattice.dist.push_back(d);
+      enemy.losCount.push_back(los);
+      enemy.minS.push_back(lo);
+      enemy.maxS.push_back(hi);
+    }
+
+    for (std::size_t iT = 0; iT < out.T.size(); ++iT) {
+      for (std::size_t iSelf = 0; iSelf < out.selfSpeed.size(); ++iSelf) {
+        const int nSelf = self.within(out.selfSpeed[iSelf] * out.T[iT]);
+        for (std::size_t iEnemy = 0; iEnemy < out.enemySpeed.size(); ++iEnemy) {
+          const int nEnemy = enemy.lattice.within(out.enemySpeed[iEnemy] * out.T[iT]);
+
+          SweepCell c;
+          c.reachableSelf = nSelf;
+          c.reachableEnemy = nEnemy;
+          if (nEnemy > 0) {
+            c.areaRatio = static_cast<double>(nSelf) / static_cast<double>(nEnemy);
+            c.losCount = enemy.losCount[static_cast<std::size_t>(nEnemy - 1)];
+            if (c.losCount > 0) {
+              c.exposureWidth = enemy.maxS[static_cast<std::size_t>(nEnemy - 1)] -
+                                enemy.minS[static_cast<std::size_t>(nEnemy - 1)];
+            }
+          }
+
+          for (std::size_t iS = 0; iS < out.visibilitySamples.size(); ++iS) {
+            SweepCell& dst = out.cells[out.index(iT, iCell, iSelf, iEnemy, iS)];
+            dst = c;
+            dst.visibleFraction = visibility[iS].visibleFraction;
+            dst.visibleCount = visibility[iS].visibleCount;
+          }
+        }
+      }
+    }
+  }
+  return out;
+}
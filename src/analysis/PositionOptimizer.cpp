@@ -0,0 +1,319 @@
+#include "analysis/PositionOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+#include "analysis/ReachabilityAnalyzer.hpp"
+#include "geom/Raycast.hpp"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+struct Node {
+  double bound;
+  int x0, y0, x1, y1; // inclusive lattice index range
+
+  bool operator<(const Node& o) const { return bound < o.bound; }
+};
+
+// Everything that does not depend on where self stands.
+struct Context {
+  const Scene& scene;
+  const PositionQuery& query;
+
+  std::vector<Vec2> enemyReach;
+  std::vector<Vec2> targets; // VisibilityAnalyzer's samples on the enemy circle
+  std::vector<Vec2> facings; // as returned
+  std::vector<Vec2> axes;    // exposure axis per facing
+
+  double areaBound = 0.0;
+
+  Vec2 origin;
+  double spacing = 1.0;
+  int nx = 0;
+  int ny = 0;
+  std::vector<int> freePrefix; // (nx+1) x (ny+1) summed-area table of free lattice points
+
+  Context(const Scene& s, const PositionQuery& q) : scene(s), query(q) {}
+
+  Vec2 point(int ix, int iy) const { return Vec2{origin.x + ix * spacing, origin.y + iy * spacing}; }
+
+  bool isFree(int ix, int iy) const { return freeCount(ix, iy, ix, iy) > 0; }
+
+  int freeCount(int x0, int y0, int x1, int y1) const {
+    const int w = nx + 1;
+    return freePrefix[static_cast<size_t>(y1 + 1) * w + (x1 + 1)]
+         - freePrefix[static_cast<size_t>(y0) * w + (x1 + 1)]
+         - freePrefix[static_cast<size_t>(y1 + 1) * w + x0]
+         + freePrefix[static_cast<size_t>(y0) * w + x0];
+  }
+};
+
+double combine(const ScoreWeights& w, double area, double exposure, double visibility) {
+  return w.area * area + w.exposure * exposure + w.visibility * visibility;
+}
+
+// Upper bound on the lattice count ReachabilityAnalyzer can return for any
+// position: every offset of the movement disk, with a little slack for the
+// rounding in its radial test.
+int diskLatticeCount(double radius, double cellSize) {
+  const int steps = static_cast<int>(std::ceil(radius / cellSize));
+  const double r = radius * (1.0 + 1e-9) + 1e-12;
+  int count = 0;
+  for (int dx = -steps; dx <= steps; ++dx) {
+    for (int dy = -steps; dy <= steps; ++dy) {
+      if (std::hypot(dx * cellSize, dy * cellSize) <= r) count++;
+    }
+  }
+  return count;
+}
+
+// True when one obstacle blocks the segments from all four corners to t.
+// The set of points whose segment to t crosses a given box is convex, so the
+// whole rectangle spanned by the corners is then hidden from t.
+bool shadowedFromRect(const Map& map, const Vec2 corners[4], const Vec2& t) {
+  for (const auto& ob : map.obstacles()) {
+    bool all = true;
+    for (int c = 0; c < 4 && all; ++c) all = segmentIntersectsAABB(corners[c], t, ob);
+    if (all) return true;
+  }
+  return false;
+}
+
+double nodeBound(const Context& ctx, const Node& n) {
+  const ScoreWeights& w = ctx.query.weights;
+  const Map& map = ctx.scene.map;
+
+  const Vec2 lo = ctx.point(n.x0, n.y0);
+  const Vec2 hi = ctx.point(n.x1, n.y1);
+  const Vec2 corners[4] = {lo, Vec2{hi.x, lo.y}, hi, Vec2{lo.x, hi.y}};
+
+  // Every metric is >= 0, so a non-positive weight contributes at most 0.
+  double bound = std::max(0.0, w.area) * ctx.areaBound;
+
+  if (w.visibility > 0.0) {
+    int open = 0;
+    for (const auto& t : ctx.targets) {
+      if (!shadowedFromRect(map, corners, t)) open++;
+    }
+    bound += w.visibility * static_cast<double>(open) / static_cast<double>(ctx.targets.size());
+  }
+
+  if (w.exposure > 0.0) {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> minS(ctx.axes.size(), inf), maxS(ctx.axes.size(), -inf);
+    bool any = false;
+    for (const auto& q : ctx.enemyReach) {
+      if (shadowedFromRect(map, corners, q)) continue;
+      any = true;
+      for (size_t j = 0; j < ctx.axes.size(); ++j) {
+        const double s = q.dot(ctx.axes[j]);
+        minS[j] = std::min(minS[j], s);
+        maxS[j] = std::max(maxS[j], s);
+      }
+    }
+    if (any) {
+      double width = 0.0;
+      for (size_t j = 0; j < ctx.axes.size(); ++j) width = std::max(width, maxS[j] - minS[j]);
+      // Exact widths project (q - p); allow for its rounding.
+      bound += w.exposure * (width * (1.0 + 1e-9) + 1e-9);
+    }
+  }
+  return bound;
+}
+
+// The three SceneAnalyzer metrics with self at p, best facing chosen.
+PositionCandidate evaluate(const Context& ctx, const Vec2& p) {
+  const Scene& scene = ctx.scene;
+  const Map& map = scene.map;
+
+  PositionCandidate c;
+  c.pos = p;
+
+  // Reachability, as ReachabilityAnalyzer samples it
+  const double radius = scene.self.speed * scene.T;
+  const int steps = static_cast<int>(std::ceil(radius / scene.cellSize));
+  int selfCount = 0;
+  for (int dx = -steps; dx <= steps; ++dx) {
+    for (int dy = -steps; dy <= steps; ++dy) {
+      const Vec2 q{p.x + dx * scene.cellSize, p.y + dy * scene.cellSize};
+      if ((q - p).norm() > radius) continue;
+      if (map.collidesCircleAt(q, scene.self.radius)) continue;
+      selfCount++;
+    }
+  }
+  if (!ctx.enemyReach.empty()) {
+    c.areaRatio = static_cast<double>(selfCount) / static_cast<double>(ctx.enemyReach.size());
+  }
+
+  int visible = 0;
+  for (const auto& t : ctx.targets) {
+    if (map.hasLineOfSight(p, t)) visible++;
+  }
+  c.visibleFraction = static_cast<double>(visible) / static_cast<double>(ctx.targets.size());
+
+  // Exposure per facing, as ExposureAnalyzer projects it: only points inside
+  // that facing's field of view count.
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<double> minS(ctx.axes.size(), inf), maxS(ctx.axes.size(), -inf);
+  std::vector<int> losCount(ctx.axes.size(), 0);
+  for (const auto& q : ctx.enemyReach) {
+    if (!map.hasLineOfSight(p, q)) continue;
+    for (size_t j = 0; j < ctx.axes.size(); ++j) {
+      if (!inFieldOfView(ctx.facings[j].normalized(), scene.fovDegrees, q - p)) continue;
+      losCount[j]++;
+      const double s = (q - p).dot(ctx.axes[j]);
+      minS[j] = std::min(minS[j], s);
+      maxS[j] = std::max(maxS[j], s);
+    }
+  }
+
+  c.score = -inf;
+  for (size_t j = 0; j < ctx.axes.size(); ++j) {
+    const double width = (losCount[j] > 0) ? (maxS[j] - minS[j]) : 0.0;
+    const double score = combine(ctx.query.weights, c.areaRatio, width, c.visibleFraction);
+    if (score > c.score) {
+      c.score = score;
+      c.exposureWidth = width;
+      c.facing = ctx.facings[j];
+    }
+  }
+  return c;
+}
+
+bool ranksBefore(const PositionCandidate& a, const PositionCandidate& b) {
+  if (a.score != b.score) return a.score > b.score;
+  if (a.pos.y != b.pos.y) return a.pos.y < b.pos.y;
+  return a.pos.x < b.pos.x;
+}
+
+} // anonymous namespace
+
+PositionSearchResult PositionOptimizer::search(const Scene& scene,
+                                               const PositionQuery& query,
+                                               const CancellationToken* cancel) const {
+  PositionSearchResult out;
+  if (query.topK <= 0) return out;
+
+  Context ctx(scene, query);
+
+  ReachabilityAnalyzer reach;
+  ctx.enemyReach = reach.analyze(scene, cancel).reachableEnemy;
+  if (isCancelled(cancel)) {
+    out.cancelled = true;
+    return out;
+  }
+
+  const int N = (scene.visibilitySamples > 0) ? scene.visibilitySamples : 1;
+  for (int i = 0; i < N; ++i) {
+    const double theta = (2.0 * M_PI * static_cast<double>(i)) / static_cast<double>(N);
+    ctx.targets.push_back(Vec2{scene.enemy.pos.x + std::cos(theta) * scene.enemy.radius,
+                               scene.enemy.pos.y + std::sin(theta) * scene.enemy.radius});
+  }
+
+  if (query.facingSamples > 0) {
+    for (int i = 0; i < query.facingSamples; ++i) {
+      const double a = (2.0 * M_PI * static_cast<double>(i)) / static_cast<double>(query.facingSamples);
+      ctx.facings.push_back(Vec2{std::cos(a), std::sin(a)});
+    }
+  } else {
+    ctx.facings.push_back(scene.self.facing);
+  }
+  for (const auto& f : ctx.facings) ctx.axes.push_back(perp(f.normalized()));
+
+  if (!ctx.enemyReach.empty()) {
+    ctx.areaBound = static_cast<double>(diskLatticeCount(scene.self.speed * scene.T, scene.cellSize))
+                  / static_cast<double>(ctx.enemyReach.size());
+  }
+
+  // Candidate lattice and its free-point prefix sums
+  const AABB region = (query.region.max.x > query.region.min.x && query.region.max.y > query.region.min.y)
+                    ? query.region : scene.map.worldBounds();
+  ctx.spacing = (query.spacing > 0.0) ? query.spacing : scene.cellSize;
+  ctx.origin = region.min;
+  ctx.nx = static_cast<int>(std::floor((region.max.x - region.min.x) / ctx.spacing)) + 1;
+  ctx.ny = static_cast<int>(std::floor((region.max.y - region.min.y) / ctx.spacing)) + 1;
+
+  const int w = ctx.nx + 1;
+  ctx.freePrefix.assign(static_cast<size_t>(w) * (ctx.ny + 1), 0);
+  for (int iy = 0; iy < ctx.ny; ++iy) {
+    for (int ix = 0; ix < ctx.nx; ++ix) {
+      const int free = scene.map.collidesCircleAt(ctx.point(ix, iy), scene.self.radius) ? 0 : 1;
+      ctx.freePrefix[static_cast<size_t>(iy + 1) * w + (ix + 1)] =
+          free
+        + ctx.freePrefix[static_cast<size_t>(iy) * w + (ix + 1)]
+        + ctx.freePrefix[static_cast<size_t>(iy + 1) * w + ix]
+        - ctx.freePrefix[static_cast<size_t>(iy) * w + ix];
+    }
+  }
+  out.candidates = ctx.freeCount(0, 0, ctx.nx - 1, ctx.ny - 1);
+  if (out.candidates == 0) return out;
+
+  // Best-bound-first branch and bound
+  const size_t k = static_cast<size_t>(query.topK);
+  auto kthScore = [&] {
+    return (out.best.size() < k) ? -std::numeric_limits<double>::infinity() : out.best.back().score;
+  };
+  auto offer = [&](const PositionCandidate& c) {
+    if (out.best.size() == k && !ranksBefore(c, out.best.back())) return;
+    out.best.insert(std::upper_bound(out.best.begin(), out.best.end(), c, ranksBefore), c);
+    if (out.best.size() > k) out.best.pop_back();
+  };
+
+  std::priority_queue<Node> open;
+  open.push(Node{std::numeric_limits<double>::infinity(), 0, 0, ctx.nx - 1, ctx.ny - 1});
+
+  while (!open.empty()) {
+    if (isCancelled(cancel)) {
+      out.cancelled = true;
+      return out;
+    }
+
+    const Node n = open.top();
+    open.pop();
+
+    // Bounds only decrease from here on, so everything left is pruned too.
+    if (n.bound < kthScore()) {
+      out.nodesPruned += 1 + static_cast<int>(open.size());
+      break;
+    }
+    out.nodesVisited++;
+
+    if (ctx.freeCount(n.x0, n.y0, n.x1, n.y1) <= std::max(1, query.leafSize)) {
+      for (int iy = n.y0; iy <= n.y1; ++iy) {
+        for (int ix = n.x0; ix <= n.x1; ++ix) {
+          if (!ctx.isFree(ix, iy)) continue;
+          offer(evaluate(ctx, ctx.point(ix, iy)));
+          out.evaluated++;
+        }
+      }
+      continue;
+    }
+
+    const int mx = (n.x0 + n.x1) / 2;
+    const int my = (n.y0 + n.y1) / 2;
+    const Node children[4] = {
+      {0.0, n.x0, n.y0, mx, my},
+      {0.0, mx + 1, n.y0, n.x1, my},
+      {0.0, n.x0, my + 1, mx, n.y1},
+      {0.0, mx + 1, my + 1, n.x1, n.y1},
+    };
+    for (Node child : children) {
+      if (child.x0 > child.x1 || child.y0 > child.y1) continue;
+      if (ctx.freeCount(child.x0, child.y0, child.x1, child.y1) == 0) continue;
+
+      child.bound = nodeBound(ctx, child);
+      if (child.bound < kthScore()) {
+        out.nodesPruned++;
+        continue;
+      }
+      open.push(child);
+    }
+  }
+  return out;
+}
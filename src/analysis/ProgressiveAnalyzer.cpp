@@ -0,0 +1,69 @@
+#include "analysis/ProgressiveAnalyzer.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "core/CancellationToken.hpp"
+
+namespace {
+
+// Coarse-to-fine schedule ending exactly at the scene's own resolution.
+std::vector<ProgressiveLevel> buildSchedule(const Scene& scene, const ProgressiveOptions& opt) {
+  const double targetCell = scene.cellSize;
+  const int targetSamples = (scene.visibilitySamples > 0) ? scene.visibilitySamples : 1;
+
+  double cell = std::max(opt.coarseCellSize, targetCell);
+  int samples = std::clamp(opt.coarseVisibilitySamples, 1, targetSamples);
+
+  std::vector<ProgressiveLevel> levels;
+  while (true) {
+    levels.push_back(ProgressiveLevel{static_cast<int>(levels.size()), cell, samples});
+    if (cell <= targetCell && samples >= targetSamples) break;
+
+    cell = std::max(targetCell, cell * 0.5);
+    samples = std::min(targetSamples, samples * 2);
+  }
+  return levels;
+}
+
+} // anonymous namespace
+
+ProgressiveResult ProgressiveAnalyzer::analyze(const Scene& scene,
+                                               Clock::time_point deadline,
+                                               const ProgressiveOptions& options,
+                                               const LevelCallback& onLevel) const {
+  ProgressiveResult out;
+  SceneAnalyzer analyzer;
+
+  CancellationToken token;
+  token.setDeadline(deadline);
+
+  const auto levels = buildSchedule(scene, options);
+  double lastLevelMs = 0.0;
+
+  for (const auto& level : levels) {
+    const auto start = Clock::now();
+    if (start >= deadline) break;
+
+    // Skip a refinement that cannot plausibly finish; its work would be thrown away.
+    const double remainingMs = std::chrono::duration<double, std::milli>(deadline - start).count();
+    if (out.level.level >= 0 && lastLevelMs * options.expectedGrowth > remainingMs) break;
+
+    Scene refined = scene;
+    refined.cellSize = level.cellSize;
+    refined.visibilitySamples = level.visibilitySamples;
+
+    AnalysisResult res = analyzer.analyze(refined, &token);
+    if (res.cancelled) break;
+
+    lastLevelMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    out.result = std::move(res);
+    out.level = level;
+    if (onLevel) onLevel(out.result, out.level);
+  }
+
+  out.reachedTarget = (out.level.level == static_cast<int>(levels.size()) - 1);
+  return out;
+}
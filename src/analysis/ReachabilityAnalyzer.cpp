@@ -1,21 +1,48 @@
 #include "analysis/ReachabilityAnalyzer.hpp"
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <memory>
+
+#include "core/DistanceField.hpp"
 
 namespace {
 
+// Below this many boxes the collision scan is cheaper than a field lookup.
+constexpr size_t kFieldMinObstacles = 32;
+
+// Cached on the map's snapshot, so scenes sharing a map build it once.
+std::shared_ptr<const DistanceField> clearanceField(const Map& map) {
+  if (map.obstacles().size() < kFieldMinObstacles) return nullptr;
+  const AABB& world = map.worldBounds();
+  return DistanceField::cached(map, std::max(world.max.x - world.min.x, world.max.y - world.min.y) / 128.0);
+}
+
+// Same answer as Map::collidesCircleAt. A centre inside a box inflated by r
+// on both axes is within r * sqrt(2) of it, so where the field's lower bound
+// exceeds 1.5 r no box can collide and the scan is skipped.
+bool collides(const Map& map, const DistanceField* field, const Vec2& p, double radius) {
+  if (field && field->distance(p) > 1.5 * radius) return false;
+  return map.collidesCircleAt(p, radius);
+}
+
 // Helper: sample grid points inside a circle
 std::vector<Vec2> sampleReachable(
     const Map& map,
+    const DistanceField* field,
     const Vec2& center,
     double radius,
     double cellSize,
-    double agentRadius)
+    double agentRadius,
+    const CancellationToken* cancel)
 {
   std::vector<Vec2> points;
 
   const int steps = static_cast<int>(std::ceil(radius / cellSize));
 
   for (int dx = -steps; dx <= steps; ++dx) {
+    if (isCancelled(cancel)) break;
+
     for (int dy = -steps; dy <= steps; ++dy) {
       Vec2 p {
         center.x + dx * cellSize,
@@ -27,7 +54,7 @@ std::vector<Vec2> sampleReachable(
         continue;
 
       // collision check
-      if (map.collidesCircleAt(p, agentRadius))
+      if (collides(map, field, p, agentRadius))
         continue;
 
       points.push_back(p);
@@ -37,30 +64,84 @@ std::vector<Vec2> sampleReachable(
   return points;
 }
 
+constexpr int kCheckEvery = 16;
+
+// The points sampleReachable tests, before collision checks.
+std::vector<Vec2> diskLattice(const Vec2& center, double radius, double cellSize) {
+  std::vector<Vec2> points;
+  const int steps = static_cast<int>(std::ceil(radius / cellSize));
+  for (int dx = -steps; dx <= steps; ++dx) {
+    for (int dy = -steps; dy <= steps; ++dy) {
+      const Vec2 p{center.x + dx * cellSize, center.y + dy * cellSize};
+      if ((p - center).norm() <= radius) points.push_back(p);
+    }
+  }
+  return points;
+}
+
+// One disk's lattice, drawn without replacement in golden-stride order.
+struct DiskDraws {
+  std::vector<Vec2> points;
+  int stride = 1;
+  int cursor = 0; // (drawn * stride) % population
+  int drawn = 0;
+  int free = 0;
+  double agentRadius = 0.0;
+
+  int population() const { return static_cast<int>(points.size()); }
+  bool exhausted() const { return drawn >= population(); }
+
+  void draw(const Map& map, const DistanceField* field) {
+    if (!collides(map, field, points[static_cast<std::size_t>(cursor)], agentRadius)) free++;
+    drawn++;
+    cursor += stride;
+    if (cursor >= population()) cursor -= population();
+  }
+
+  // Estimated free point count and its interval.
+  double count() const { return drawn ? static_cast<double>(free) * population() / drawn : 0.0; }
+  void countInterval(double z, double& lower, double& upper) const {
+    wilsonInterval(free, drawn, population(), z, lower, upper);
+    lower *= population();
+    upper *= population();
+  }
+};
+
 } // anonymous namespace
 
-ReachabilityResult ReachabilityAnalyzer::analyze(const Scene& scene) const {
+ReachabilityResult ReachabilityAnalyzer::analyze(const Scene& scene,
+                                                 const CancellationToken* cancel) const {
   ReachabilityResult result;
 
   const double maxDistSelf   = scene.self.speed   * scene.T;
   const double maxDistEnemy  = scene.enemy.speed  * scene.T;
 
+  const auto field = clearanceField(scene.map);
   result.reachableSelf = sampleReachable(
     scene.map,
+    field.get(),
     scene.self.pos,
     maxDistSelf,
     scene.cellSize,
-    scene.self.radius
+    scene.self.radius,
+    cancel
   );
 
   result.reachableEnemy = sampleReachable(
     scene.map,
+    field.get(),
     scene.enemy.pos,
     maxDistEnemy,
     scene.cellSize,
-    scene.enemy.radius
+    scene.enemy.radius,
+    cancel
   );
 
+  if (isCancelled(cancel)) {
+    result.cancelled = true;
+    return result;
+  }
+
   if (!result.reachableEnemy.empty()) {
     result.areaRatio =
       static_cast<double>(result.reachableSelf.size()) /
@@ -69,3 +150,57 @@ ReachabilityResult ReachabilityAnalyzer::analyze(const Scene& scene) const {
 
   return result;
 }
+
+SampledEstimate ReachabilityAnalyzer::estimateAreaRatio(const Scene& scene,
+                                                         const SamplingTolerance& tol,
+                                                         const CancellationToken* cancel) const {
+  SampledEstimate out;
+
+  const auto field = clearanceField(scene.map);
+  DiskDraws self, enemy;
+  self.points = diskLattice(scene.self.pos, scene.self.speed * scene.T, scene.cellSize);
+  self.agentRadius = scene.self.radius;
+  self.stride = goldenStride(self.population());
+  enemy.points = diskLattice(scene.enemy.pos, scene.enemy.speed * scene.T, scene.cellSize);
+  enemy.agentRadius = scene.enemy.radius;
+  enemy.stride = goldenStride(enemy.population());
+
+  out.population = self.population() + enemy.population();
+  out.upper = out.errorBound = std::numeric_limits<double>::infinity();
+
+  while (!(self.exhausted() && enemy.exhausted())) {
+    if (isCancelled(cancel)) {
+      out.cancelled = true;
+      return out;
+    }
+
+    // Keep the two disks at similar sample counts.
+    DiskDraws& next = enemy.exhausted() || (!self.exhausted() && self.drawn <= enemy.drawn) ? self : enemy;
+    next.draw(scene.map, field.get());
+    out.samples++;
+
+    // Collision tests can be cheaper than the interval update, so the stop
+    // rule is only evaluated every kCheckEvery draws.
+    if (out.samples % kCheckEvery != 0 && !(self.exhausted() && enemy.exhausted())) continue;
+
+    double sLo, sHi, eLo, eHi;
+    self.countInterval(tol.z, sLo, sHi);
+    enemy.countInterval(tol.z, eLo, eHi);
+
+    if (enemy.exhausted() && enemy.free == 0) {
+      // No free enemy point: the exact analyzer reports 0.
+      out.value = out.lower = out.upper = out.errorBound = 0.0;
+      break;
+    }
+    const double inf = std::numeric_limits<double>::infinity();
+    out.value = enemy.free > 0 ? self.count() / enemy.count() : 0.0;
+    out.lower = eHi > 0.0 ? sLo / eHi : 0.0;
+    out.upper = eLo > 0.0 ? sHi / eLo : inf;
+    out.errorBound = std::max(out.value - out.lower, out.upper - out.value);
+
+    const bool enough = (self.exhausted() || self.drawn >= tol.minSamples) &&
+                        (enemy.exhausted() || enemy.drawn >= tol.minSamples);
+    if (enough && out.errorBound <= tol.halfWidth) break;
+  }
+  return out;
+}
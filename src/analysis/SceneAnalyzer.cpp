@@ -1,27 +1,95 @@
 #include "analysis/SceneAnalyzer.hpp"
 
+#include <chrono>
 #include <sstream>
 #include <iomanip>
 
 #include "analysis/ReachabilityAnalyzer.hpp"
 #include "analysis/ExposureAnalyzer.hpp"
 #include "analysis/VisibilityAnalyzer.hpp"
+#include "core/TraceRecorder.hpp"
 
-AnalysisResult SceneAnalyzer::analyze(const Scene& scene) const {
+namespace {
+
+// Records wall time, work counters and allocations for one stage while in
+// scope.
+// Empty in builds without FPS_ENGINE_STATS.
+class StageProbe {
+public:
+#if FPS_ENGINE_STATS
+  explicit StageProbe(StageStats& out)
+    : out_(out), start_(std::chrono::steady_clock::now()), before_(threadWorkCounters()) {}
+
+  ~StageProbe() {
+    out_.wallMs = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start_).count();
+    out_.work = threadWorkCounters() - before_;
+    out_.alloc = alloc_.counters();
+  }
+
+private:
+  StageStats& out_;
+  std::chrono::steady_clock::time_point start_;
+  WorkCounters before_;
+  AllocationScope alloc_;
+#else
+  explicit StageProbe(StageStats&) {}
+#endif
+};
+
+} // anonymous namespace
+
+AnalysisResult SceneAnalyzer::analyze(const Scene& scene,
+                                     const CancellationToken* cancel) const {
   AnalysisResult out;
+  TraceRecorder::AnalyzeScope trace(scene);
 
   ReachabilityAnalyzer reach;
   ExposureAnalyzer exposure;
   VisibilityAnalyzer visibility;
 
+#if FPS_ENGINE_STATS
+  const auto start = std::chrono::steady_clock::now();
+  out.stats.enabled = true;
+  AllocationScope alloc;
+#endif
+
   // A) Reachable Area Ratio
-  out.reachability = reach.analyze(scene);
+  {
+    StageProbe probe(out.stats.reachability);
+    out.reachability = reach.analyze(scene, cancel);
+  }
+  if (out.reachability.cancelled) {
+    out.cancelled = true;
+    return out;
+  }
 
   // B) Exposure Width (enemy reachable cells that have LoS from self)
-  out.exposure = exposure.analyze(scene, out.reachability.reachableEnemy);
+  {
+    StageProbe probe(out.stats.exposure);
+    out.exposure = exposure.analyze(scene, out.reachability.reachableEnemy, cancel);
+  }
+  if (out.exposure.cancelled) {
+    out.cancelled = true;
+    return out;
+  }
 
   // C) Visible Hit Fraction (self -> enemy)
-  out.visibility = visibility.analyze(scene, scene.self.pos, scene.enemy);
+  {
+    StageProbe probe(out.stats.visibility);
+    out.visibility = visibility.analyze(scene, scene.self.pos, scene.enemy, cancel);
+  }
+  if (out.visibility.cancelled) {
+    out.cancelled = true;
+    return out;
+  }
+
+#if FPS_ENGINE_STATS
+  out.stats.totalMs = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+  out.stats.reachableCells = static_cast<int>(
+    out.reachability.reachableSelf.size() + out.reachability.reachableEnemy.size());
+#endif
 
   // --- Explainability strings ---
   {
@@ -48,5 +116,10 @@ AnalysisResult SceneAnalyzer::analyze(const Scene& scene) const {
     out.explanations.push_back(fact.str());
   }
 
+#if FPS_ENGINE_STATS
+  out.stats.alloc = alloc.counters();
+#endif
+
+  trace.finish(out.reachability.areaRatio, out.exposure.width, out.visibility.visibleFraction);
   return out;
 }
@@ -1,13 +1,92 @@
 #include "analysis/VisibilityAnalyzer.hpp"
+#include <algorithm>
 #include <cmath>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace {
+
+Vec2 rimSample(const Agent& target, int i, int n) {
+  const double theta = (2.0 * M_PI * static_cast<double>(i)) / static_cast<double>(n);
+  return Vec2{
+    target.pos.x + std::cos(theta) * target.radius,
+    target.pos.y + std::sin(theta) * target.radius
+  };
+}
+
+// Parameter range [lo, hi] of p0 + s * d, s in [0, 1].
+struct Range {
+  double lo = 0.0;
+  double hi = 1.0;
+  bool empty() const { return lo > hi; }
+};
+
+// Keeps the part where n . p >= c.
+void clip(Range& r, const Vec2& p0, const Vec2& d, const Vec2& n, double c) {
+  const double f0 = n.dot(p0) - c;
+  const double fd = n.dot(d);
+  if (fd == 0.0) {
+    if (f0 < 0.0) r.lo = 1.0, r.hi = 0.0;
+    return;
+  }
+  const double s = -f0 / fd;
+  if (fd > 0.0) r.lo = std::max(r.lo, s);
+  else r.hi = std::min(r.hi, s);
+}
+
+// Half-plane form of cross(t, c, p) >= 0 (p left of the ray t -> c).
+void clipLeftOf(Range& r, const Vec2& p0, const Vec2& d, const Vec2& t, const Vec2& c, double sign) {
+  const Vec2 e = c - t;
+  const Vec2 n{-e.y * sign, e.x * sign};
+  clip(r, p0, d, n, n.dot(t));
+}
+
+// Shooter positions on p0 + s * d whose segment to t crosses `box`.
+Range shadowRange(const Vec2& p0, const Vec2& d, const Vec2& t, const AABB& box) {
+  Range r;
+  if (box.contains(t)) return r;
+
+  // Beyond each face that t sees.
+  if (t.x < box.min.x) clip(r, p0, d, Vec2{1, 0}, box.min.x);
+  if (t.x > box.max.x) clip(r, p0, d, Vec2{-1, 0}, -box.max.x);
+  if (t.y < box.min.y) clip(r, p0, d, Vec2{0, 1}, box.min.y);
+  if (t.y > box.max.y) clip(r, p0, d, Vec2{0, -1}, -box.max.y);
+  if (r.empty()) return r;
+
+  // Inside the cone from t through the silhouette corners.
+  const Vec2 corners[4] = {box.min, Vec2{box.max.x, box.min.y}, box.max, Vec2{box.min.x, box.max.y}};
+  bool haveRight = false, haveLeft = false;
+  for (const Vec2& c : corners) {
+    bool allLeft = true, allRight = true;
+    for (const Vec2& o : corners) {
+      const double side = (c.x - t.x) * (o.y - t.y) - (c.y - t.y) * (o.x - t.x);
+      allLeft = allLeft && side >= 0.0;
+      allRight = allRight && side <= 0.0;
+    }
+    if (allLeft && !haveRight) { clipLeftOf(r, p0, d, t, c, 1.0); haveRight = true; }
+    else if (allRight && !haveLeft) { clipLeftOf(r, p0, d, t, c, -1.0); haveLeft = true; }
+  }
+  return r;
+}
+
+// Where p0 + s * d is inside `bounds`.
+Range insideRange(const Vec2& p0, const Vec2& d, const AABB& bounds) {
+  Range r;
+  clip(r, p0, d, Vec2{1, 0}, bounds.min.x);
+  clip(r, p0, d, Vec2{-1, 0}, -bounds.max.x);
+  clip(r, p0, d, Vec2{0, 1}, bounds.min.y);
+  clip(r, p0, d, Vec2{0, -1}, -bounds.max.y);
+  return r;
+}
+
+} // anonymous namespace
+
 VisibilityResult VisibilityAnalyzer::analyze(const Scene& scene,
                                             const Vec2& shooterPos,
-                                            const Agent& target) const {
+                                            const Agent& target,
+                                            const CancellationToken* cancel) const {
   VisibilityResult out;
 
   const int N = (scene.visibilitySamples > 0) ? scene.visibilitySamples : 1;
@@ -16,14 +95,12 @@ VisibilityResult VisibilityAnalyzer::analyze(const Scene& scene,
   // If shooter is out of bounds, we treat as no visibility (consistent with Map::hasLineOfSight)
   // If target center out of bounds, same outcome anyway because sampled points will be out.
   for (int i = 0; i < N; ++i) {
-    const double theta = (2.0 * M_PI * static_cast<double>(i)) / static_cast<double>(N);
-
-    const Vec2 sample{
-      target.pos.x + std::cos(theta) * target.radius,
-      target.pos.y + std::sin(theta) * target.radius
-    };
+    if (isCancelled(cancel)) {
+      out.cancelled = true;
+      return out;
+    }
 
-    if (scene.map.hasLineOfSight(shooterPos, sample)) {
+    if (scene.map.hasLineOfSight(shooterPos, rimSample(target, i, N))) {
       out.visibleCount++;
     }
   }
@@ -31,3 +108,164 @@ VisibilityResult VisibilityAnalyzer::analyze(const Scene& scene,
   out.visibleFraction = static_cast<double>(out.visibleCount) / static_cast<double>(out.sampleCount);
   return out;
 }
+
+SampledEstimate VisibilityAnalyzer::estimate(const Scene& scene,
+                                             const Vec2& shooterPos,
+                                             const Agent& target,
+                                             const SamplingTolerance& tol,
+                                             const CancellationToken* cancel) const {
+  SampledEstimate out;
+
+  const int N = (scene.visibilitySamples > 0) ? scene.visibilitySamples : 1;
+  const int stride = goldenStride(N);
+  out.population = N;
+  out.upper = 1.0;
+  out.errorBound = 1.0;
+
+  int visible = 0;
+  for (int k = 0; k < N; ++k) {
+    if (isCancelled(cancel)) {
+      out.cancelled = true;
+      return out;
+    }
+
+    const int i = static_cast<int>((static_cast<long long>(k) * stride) % N);
+    if (scene.map.hasLineOfSight(shooterPos, rimSample(target, i, N))) visible++;
+    out.samples = k + 1;
+
+    out.value = static_cast<double>(visible) / out.samples;
+    wilsonInterval(visible, out.samples, N, tol.z, out.lower, out.upper);
+    out.errorBound = std::max(out.value - out.lower, out.upper - out.value);
+    if (out.samples >= tol.minSamples && out.errorBound <= tol.halfWidth) break;
+  }
+  return out;
+}
+
+double SweptVisibilityResult::fractionAt(double time) const {
+  auto it = std::upper_bound(events.begin(), events.end(), time,
+                             [](double t, const VisibilityEvent& e) { return t < e.time; });
+  return it == events.begin() ? 0.0 : (it - 1)->visibleFraction;
+}
+
+SweptVisibilityResult VisibilityAnalyzer::sweep(const Scene& scene,
+                                                const std::vector<Vec2>& path,
+                                                double speed,
+                                                const Agent& target,
+                                                const CancellationToken* cancel) const {
+  SweptVisibilityResult out;
+  const int N = (scene.visibilitySamples > 0) ? scene.visibilitySamples : 1;
+  out.sampleCount = N;
+  if (path.empty() || speed <= 0.0) return out;
+
+  // Segment start times.
+  std::vector<double> startTime(path.size(), 0.0);
+  for (std::size_t i = 1; i < path.size(); ++i) {
+    startTime[i] = startTime[i - 1] + dist(path[i - 1], path[i]) / speed;
+  }
+  out.duration = startTime.back();
+
+  const AABB& world = scene.map.worldBounds();
+  const auto& obstacles = scene.map.obstacles();
+
+  // +1 / -1 at the ends of each sample's visible intervals.
+  std::vector<std::pair<double, int>> edges;
+  std::vector<std::pair<double, double>> blocked;
+  int zeroLengthVisible = 0;
+
+  for (int k = 0; k < N; ++k) {
+    if (isCancelled(cancel)) {
+      out.cancelled = true;
+      return out;
+    }
+
+    const Vec2 t = rimSample(target, k, N);
+    if (!world.contains(t)) continue;
+
+    blocked.clear();
+    // A single-point path is one zero-length segment.
+    const std::size_t segments = std::max<std::size_t>(1, path.size() - 1);
+    for (std::size_t i = 0; i < segments; ++i) {
+      const Vec2& p0 = path[i];
+      const Vec2 d = (path.size() > 1) ? path[i + 1] - p0 : Vec2{};
+      const double t0 = startTime[i];
+      const double dt = (path.size() > 1) ? startTime[i + 1] - t0 : 0.0;
+
+      // Outside the world counts as blocked.
+      const Range in = insideRange(p0, d, world);
+      if (in.empty()) {
+        blocked.push_back({t0, t0 + dt});
+        continue;
+      }
+      if (in.lo > 0.0) blocked.push_back({t0, t0 + in.lo * dt});
+      if (in.hi < 1.0) blocked.push_back({t0 + in.hi * dt, t0 + dt});
+
+      const AABB reach{Vec2{std::min({p0.x, p0.x + d.x, t.x}), std::min({p0.y, p0.y + d.y, t.y})},
+                       Vec2{std::max({p0.x, p0.x + d.x, t.x}), std::max({p0.y, p0.y + d.y, t.y})}};
+      for (const auto& ob : obstacles) {
+        if (ob.min.x > reach.max.x || ob.max.x < reach.min.x ||
+            ob.min.y > reach.max.y || ob.max.y < reach.min.y) continue;
+        const Range r = shadowRange(p0, d, t, ob);
+        if (!r.empty()) blocked.push_back({t0 + r.lo * dt, t0 + r.hi * dt});
+      }
+    }
+
+    // Visible = [0, duration] minus the union of blocked intervals.
+    if (out.duration == 0.0) {
+      if (blocked.empty()) zeroLengthVisible++;
+      continue;
+    }
+    std::sort(blocked.begin(), blocked.end());
+    double cursor = 0.0; // everything before cursor is accounted for
+    for (const auto& [b0, b1] : blocked) {
+      if (b0 > cursor) {
+        edges.push_back({cursor, +1});
+        edges.push_back({b0, -1});
+      }
+      cursor = std::max(cursor, b1);
+    }
+    if (cursor < out.duration) {
+      edges.push_back({cursor, +1});
+      edges.push_back({out.duration, -1});
+    }
+  }
+
+  if (out.duration == 0.0) {
+    const double fraction = static_cast<double>(zeroLengthVisible) / N;
+    out.events.push_back({0.0, path.front(), fraction});
+    if (zeroLengthVisible > 0) out.firstVisibleTime = 0.0;
+    if (zeroLengthVisible == N) out.firstFullTime = 0.0;
+    return out;
+  }
+
+  // Sweep the edges into piecewise-constant fractions.
+  std::sort(edges.begin(), edges.end());
+  int visible = 0;
+  out.events.push_back({0.0, path.front(), 0.0});
+  double prevTime = 0.0;
+  for (std::size_t i = 0; i < edges.size();) {
+    const double time = edges[i].first;
+    if (visible > 0) out.visibleTime += time - prevTime;
+    prevTime = time;
+    for (; i < edges.size() && edges[i].first == time; ++i) visible += edges[i].second;
+    if (time >= out.duration) break;
+
+    const double fraction = static_cast<double>(visible) / N;
+    if (fraction == out.events.back().visibleFraction) continue;
+
+    // Position at `time`.
+    std::size_t seg = std::upper_bound(startTime.begin(), startTime.end(), time) - startTime.begin();
+    seg = std::min(std::max<std::size_t>(seg, 1), path.size()) - 1;
+    Vec2 pos = path[seg];
+    if (seg + 1 < path.size() && startTime[seg + 1] > startTime[seg]) {
+      const double u = (time - startTime[seg]) / (startTime[seg + 1] - startTime[seg]);
+      pos = path[seg] + (path[seg + 1] - path[seg]) * u;
+    }
+
+    if (out.events.back().time == time) out.events.back().visibleFraction = fraction;
+    else out.events.push_back({time, pos, fraction});
+
+    if (fraction > 0.0 && out.firstVisibleTime < 0.0) out.firstVisibleTime = time;
+    if (visible == N && out.firstFullTime < 0.0) out.firstFullTime = time;
+  }
+  return out;
+}
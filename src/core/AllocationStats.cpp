@@ -0,0 +1,90 @@
+#include "core/AllocationStats.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+struct Tally {
+  std::uint64_t allocations;
+  std::uint64_t bytes;
+  std::int64_t live;
+  std::int64_t peak;
+};
+
+// Trivial, so it needs no construction or destruction and is safe to touch
+// from operator new at any point in a thread's life.
+thread_local Tally tTally{};
+
+} // anonymous namespace
+
+AllocationScope::AllocationScope()
+  : allocations_(tTally.allocations), bytes_(tTally.bytes), live_(tTally.live), outerPeak_(tTally.peak) {
+  tTally.peak = tTally.live;
+}
+
+AllocationScope::~AllocationScope() {
+  tTally.peak = std::max(outerPeak_, tTally.peak);
+}
+
+AllocationCounters AllocationScope::counters() const {
+  return {tTally.allocations - allocations_, tTally.bytes - bytes_,
+          static_cast<std::uint64_t>(std::max<std::int64_t>(0, tTally.peak - live_))};
+}
+
+#if FPS_ENGINE_STATS
+
+// Each block carries its size in a header, so delete can subtract it. The
+// header is max_align_t sized to keep the returned pointer aligned. Over-
+// aligned new / delete are left to the standard library and not counted.
+namespace {
+
+constexpr std::size_t kHeader = alignof(std::max_align_t);
+
+void* countedAlloc(std::size_t n) {
+  void* p = nullptr;
+  while ((p = std::malloc(n + kHeader)) == nullptr) {
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+  *static_cast<std::size_t*>(p) = n;
+
+  tTally.allocations++;
+  tTally.bytes += n;
+  tTally.live += static_cast<std::int64_t>(n);
+  tTally.peak = std::max(tTally.peak, tTally.live);
+  return static_cast<char*>(p) + kHeader;
+}
+
+void countedFree(void* p) noexcept {
+  if (!p) return;
+  char* base = static_cast<char*>(p) - kHeader;
+  tTally.live -= static_cast<std::int64_t>(*reinterpret_cast<std::size_t*>(base));
+  std::free(base);
+}
+
+} // anonymous namespace
+
+void* operator new(std::size_t n) { return countedAlloc(n); }
+void* operator new[](std::size_t n) { return countedAlloc(n); }
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+  try {
+    return countedAlloc(n);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void* operator new[](std::size_t n, const std::nothrow_t& tag) noexcept { return operator new(n, tag); }
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+
+#endif
@@ -0,0 +1,108 @@
+#include "core/BoxGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "geom/Raycast.hpp"
+
+namespace {
+
+// Euclidean distance from p to box b (0 if p is inside or on the boundary).
+double distanceToBox(const Vec2& p, const AABB& b) {
+  const double dx = std::max({b.min.x - p.x, 0.0, p.x - b.max.x});
+  const double dy = std::max({b.min.y - p.y, 0.0, p.y - b.max.y});
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+} // anonymous namespace
+
+BoxGrid::BoxGrid(const std::vector<AABB>& boxes, const AABB& region, double bucketSize)
+  : region_(region), size_(bucketSize) {
+  nx_ = std::max(1, static_cast<int>(std::ceil((region.max.x - region.min.x) / size_)));
+  ny_ = std::max(1, static_cast<int>(std::ceil((region.max.y - region.min.y) / size_)));
+  buckets_.resize(static_cast<size_t>(nx_) * ny_);
+
+  // A hair of padding so a ray walk that rounds across a bucket edge early
+  // still meets a box touching that edge.
+  const double pad = 1e-6 * size_;
+  for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+    const AABB& b = boxes[i];
+    const int x0 = clampX(b.min.x - pad), x1 = clampX(b.max.x + pad);
+    const int y0 = clampY(b.min.y - pad), y1 = clampY(b.max.y + pad);
+    for (int y = y0; y <= y1; ++y)
+      for (int x = x0; x <= x1; ++x) buckets_[static_cast<size_t>(y) * nx_ + x].push_back(i);
+  }
+}
+
+int BoxGrid::clampX(double x) const {
+  return std::clamp(static_cast<int>(std::floor((x - region_.min.x) / size_)), 0, nx_ - 1);
+}
+
+int BoxGrid::clampY(double y) const {
+  return std::clamp(static_cast<int>(std::floor((y - region_.min.y) / size_)), 0, ny_ - 1);
+}
+
+double BoxGrid::nearest(const std::vector<AABB>& boxes, const Vec2& p) const {
+  double best = std::numeric_limits<double>::infinity();
+  const int cx = clampX(p.x);
+  const int cy = clampY(p.y);
+  const int maxRing = std::max(nx_, ny_);
+
+  for (int ring = 0; ring <= maxRing; ++ring) {
+    // Everything in ring k is at least (k - 1) buckets away.
+    if (ring >= 1 && static_cast<double>(ring - 1) * size_ > best) break;
+
+    for (int y = cy - ring; y <= cy + ring; ++y) {
+      if (y < 0 || y >= ny_) continue;
+      const bool edgeRow = (y == cy - ring || y == cy + ring);
+      for (int x = cx - ring; x <= cx + ring; x += (edgeRow ? 1 : 2 * ring)) {
+        if (x >= 0 && x < nx_) {
+          for (int id : bucket(x, y)) best = std::min(best, distanceToBox(p, boxes[id]));
+        }
+        if (ring == 0) break;
+      }
+    }
+  }
+  return best;
+}
+
+BoxGrid::Hit BoxGrid::raycast(const std::vector<AABB>& boxes, const Vec2& origin, const Vec2& dirUnit,
+                              double tStart, double maxRange) const {
+  Hit best{maxRange, -1};
+  const Vec2 start = origin + dirUnit * tStart;
+  if (tStart >= maxRange || !region_.contains(start)) return best;
+
+  // Amanatides & Woo: t of the next bucket edge on each axis, and the t
+  // between consecutive edges.
+  const double inf = std::numeric_limits<double>::infinity();
+  int x = clampX(start.x);
+  int y = clampY(start.y);
+  const int stepX = dirUnit.x > 0.0 ? 1 : (dirUnit.x < 0.0 ? -1 : 0);
+  const int stepY = dirUnit.y > 0.0 ? 1 : (dirUnit.y < 0.0 ? -1 : 0);
+  double tx = stepX == 0 ? inf : (region_.min.x + (x + (stepX > 0)) * size_ - origin.x) / dirUnit.x;
+  double ty = stepY == 0 ? inf : (region_.min.y + (y + (stepY > 0)) * size_ - origin.y) / dirUnit.y;
+  const double dtx = stepX == 0 ? inf : size_ / std::abs(dirUnit.x);
+  const double dty = stepY == 0 ? inf : size_ / std::abs(dirUnit.y);
+
+  for (;;) {
+    for (int id : bucket(x, y)) {
+      const double t = rayIntersectAABB(origin, dirUnit, boxes[id]);
+      if (t < best.distance || (t == best.distance && best.index > id)) best = Hit{t, id};
+    }
+
+    // A hit inside this bucket beats anything further along; an exact tie
+    // with the exit still checks the next bucket for a lower index.
+    const double exit = std::min(tx, ty);
+    if (best.distance < exit || exit >= maxRange) break;
+    if (tx < ty) {
+      x += stepX;
+      tx += dtx;
+    } else {
+      y += stepY;
+      ty += dty;
+    }
+    if (x < 0 || x >= nx_ || y < 0 || y >= ny_) break;
+  }
+  return best;
+}
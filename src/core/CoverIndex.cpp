@@ -0,0 +1,140 @@
+#include "core/CoverIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <queue>
+
+#include "core/Map.hpp"
+#include "core/Scene.hpp"
+
+namespace {
+
+// Keeps cover points strictly clear of the box they were generated from.
+constexpr double kClearance = 1e-6;
+
+double coord(const Vec2& p, int axis) { return axis == 0 ? p.x : p.y; }
+
+// Points along [a, b] at most `spacing` apart, excluding b.
+void edgePoints(const Vec2& a, const Vec2& b, double spacing, std::vector<Vec2>& out) {
+  const double len = dist(a, b);
+  const int n = std::max(1, static_cast<int>(std::ceil(len / spacing)));
+  for (int i = 0; i < n; ++i) out.push_back(a + (b - a) * (static_cast<double>(i) / n));
+}
+
+} // anonymous namespace
+
+std::shared_ptr<const CoverIndex> CoverIndex::build(const Map& map, double agentRadius, double spacing) {
+  std::shared_ptr<CoverIndex> index(new CoverIndex());
+  const double r = agentRadius + kClearance;
+  spacing = std::max(spacing, 1e-3);
+
+  const auto& obstacles = map.obstacles();
+  std::vector<Vec2> candidates;
+  for (int id = 0; id < static_cast<int>(obstacles.size()); ++id) {
+    const AABB b = obstacles[id].inflated(r);
+    candidates.clear();
+
+    // Edges of the inflated box, then the diagonal points past each corner
+    // (inflated corners sit at distance r*sqrt(2); these sit at exactly r).
+    edgePoints(b.min, Vec2{b.max.x, b.min.y}, spacing, candidates);
+    edgePoints(Vec2{b.max.x, b.min.y}, b.max, spacing, candidates);
+    edgePoints(b.max, Vec2{b.min.x, b.max.y}, spacing, candidates);
+    edgePoints(Vec2{b.min.x, b.max.y}, b.min, spacing, candidates);
+
+    const AABB& o = obstacles[id];
+    const double d = r / std::sqrt(2.0);
+    candidates.push_back(Vec2{o.min.x - d, o.min.y - d});
+    candidates.push_back(Vec2{o.max.x + d, o.min.y - d});
+    candidates.push_back(Vec2{o.max.x + d, o.max.y + d});
+    candidates.push_back(Vec2{o.min.x - d, o.max.y + d});
+
+    for (const auto& p : candidates) {
+      if (map.collidesCircleAt(p, agentRadius)) continue;
+      index->points_.push_back(CoverPoint{p, id, 0.0});
+    }
+  }
+
+  index->axis_.assign(index->points_.size(), 0);
+  index->buildTree(0, static_cast<int>(index->points_.size()));
+  return index;
+}
+
+std::shared_ptr<const CoverIndex> CoverIndex::cached(const Map& map, double agentRadius, double spacing) {
+  char key[96];
+  std::snprintf(key, sizeof(key), "CoverIndex:%a:%a", agentRadius, spacing);
+  return map.derived<CoverIndex>(key, [&] { return build(map, agentRadius, spacing); });
+}
+
+// Implicit k-d tree: the node for [lo, hi) is its median element, split on
+// the axis of larger extent; children are [lo, mid) and [mid + 1, hi).
+void CoverIndex::buildTree(int lo, int hi) {
+  if (hi - lo <= 0) return;
+
+  double minX = points_[lo].pos.x, maxX = minX, minY = points_[lo].pos.y, maxY = minY;
+  for (int i = lo + 1; i < hi; ++i) {
+    minX = std::min(minX, points_[i].pos.x);
+    maxX = std::max(maxX, points_[i].pos.x);
+    minY = std::min(minY, points_[i].pos.y);
+    maxY = std::max(maxY, points_[i].pos.y);
+  }
+  const int axis = (maxY - minY > maxX - minX) ? 1 : 0;
+
+  const int mid = lo + (hi - lo) / 2;
+  std::nth_element(points_.begin() + lo, points_.begin() + mid, points_.begin() + hi,
+                   [axis](const CoverPoint& a, const CoverPoint& b) {
+                     return coord(a.pos, axis) < coord(b.pos, axis);
+                   });
+  axis_[mid] = static_cast<unsigned char>(axis);
+
+  buildTree(lo, mid);
+  buildTree(mid + 1, hi);
+}
+
+std::vector<CoverPoint> CoverIndex::nearestHidden(const Map& map, const Vec2& from, const Vec2& viewpoint,
+                                                  double maxDistance, int k) const {
+  std::vector<CoverPoint> out;
+  if (k <= 0 || points_.empty()) return out;
+
+  // Best-first traversal: entries are subtrees (keyed by a lower bound on the
+  // distance to anything inside) or single points (keyed by exact distance).
+  struct Entry {
+    double key;
+    int lo, hi;   // subtree range, or point index in lo when hi == -1
+    bool operator>(const Entry& o) const { return key > o.key; }
+  };
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  open.push(Entry{0.0, 0, static_cast<int>(points_.size())});
+
+  while (!open.empty()) {
+    const Entry e = open.top();
+    open.pop();
+    if (e.key > maxDistance) break;
+
+    if (e.hi == -1) {
+      // Nearest unvisited point: accept it if the viewpoint cannot see it.
+      const CoverPoint& p = points_[e.lo];
+      if (!map.hasLineOfSight(viewpoint, p.pos)) {
+        out.push_back(CoverPoint{p.pos, p.obstacle, e.key});
+        if (static_cast<int>(out.size()) == k) break;
+      }
+      continue;
+    }
+
+    const int mid = e.lo + (e.hi - e.lo) / 2;
+    const int axis = axis_[mid];
+    open.push(Entry{dist(from, points_[mid].pos), mid, -1});
+
+    // The far side of the split is at least |delta| away along the axis.
+    const double delta = coord(from, axis) - coord(points_[mid].pos, axis);
+    const double nearKey = e.key;
+    const double farKey = std::max(e.key, std::abs(delta));
+    if (mid > e.lo) open.push(Entry{delta < 0.0 ? nearKey : farKey, e.lo, mid});
+    if (mid + 1 < e.hi) open.push(Entry{delta < 0.0 ? farKey : nearKey, mid + 1, e.hi});
+  }
+  return out;
+}
+
+std::vector<CoverPoint> CoverIndex::nearestHidden(const Scene& scene, int k) const {
+  return nearestHidden(scene.map, scene.self.pos, scene.enemy.pos, scene.self.speed * scene.T, k);
+}
@@ -0,0 +1,166 @@
+#include "core/DistanceField.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include "core/BoxGrid.hpp"
+#include "core/Map.hpp"
+
+namespace {
+
+// Stand-in for "no seed yet" that keeps the parabola arithmetic finite.
+constexpr double kFar = 1e20;
+
+// 1D squared distance transform (Felzenszwalb & Huttenlocher): f holds 0 at
+// seeds and kFar elsewhere on input, squared distances on output.
+void edt1d(std::vector<double>& f, std::vector<double>& d, std::vector<int>& v, std::vector<double>& z) {
+  const int n = static_cast<int>(f.size());
+  auto intersect = [&](int q, int p) {
+    return ((f[q] + double(q) * q) - (f[p] + double(p) * p)) / (2.0 * q - 2.0 * p);
+  };
+
+  int k = 0;
+  v[0] = 0;
+  z[0] = -std::numeric_limits<double>::infinity();
+  z[1] = std::numeric_limits<double>::infinity();
+  for (int q = 1; q < n; ++q) {
+    double s = intersect(q, v[k]);
+    while (s <= z[k]) {
+      k--;
+      s = intersect(q, v[k]);
+    }
+    k++;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = std::numeric_limits<double>::infinity();
+  }
+
+  k = 0;
+  for (int q = 0; q < n; ++q) {
+    while (z[k + 1] < q) k++;
+    const double dq = q - v[k];
+    d[q] = dq * dq + f[v[k]];
+  }
+  f.swap(d);
+}
+
+float roundDown(double v) {
+  float f = static_cast<float>(v);
+  if (static_cast<double>(f) > v) f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+  return f;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<const DistanceField> DistanceField::build(const Map& map, double resolution) {
+  std::shared_ptr<DistanceField> field(new DistanceField());
+  const AABB& world = map.worldBounds();
+
+  field->bounds_ = world;
+  field->h_ = resolution;
+  field->nx_ = static_cast<int>(std::ceil((world.max.x - world.min.x) / resolution)) + 1;
+  field->ny_ = static_cast<int>(std::ceil((world.max.y - world.min.y) / resolution)) + 1;
+
+  const int nx = field->nx_;
+  const int ny = field->ny_;
+  const double INF = std::numeric_limits<double>::infinity();
+  const double diag = std::hypot(world.max.x - world.min.x, world.max.y - world.min.y);
+
+  // Exact outside distances; samples touching an obstacle are marked blocked.
+  std::vector<double> outside(static_cast<size_t>(nx) * ny);
+  const BoxGrid buckets(map.obstacles(), world, 8.0 * resolution);
+  bool anyFree = false;
+  for (int iy = 0; iy < ny; ++iy) {
+    for (int ix = 0; ix < nx; ++ix) {
+      const Vec2 p{world.min.x + ix * resolution, world.min.y + iy * resolution};
+      const double d = map.obstacles().empty() ? INF : buckets.nearest(map.obstacles(), p);
+      outside[static_cast<size_t>(iy) * nx + ix] = d;
+      anyFree = anyFree || d > 0.0;
+    }
+  }
+
+  // Blocked samples: distance to the nearest free sample, by a separable
+  // squared EDT seeded at free samples (in grid units).
+  std::vector<double> sq(static_cast<size_t>(nx) * ny);
+  for (size_t i = 0; i < sq.size(); ++i) sq[i] = (outside[i] > 0.0) ? 0.0 : kFar;
+
+  if (anyFree) {
+    const int n = std::max(nx, ny);
+    std::vector<double> f, d;
+    std::vector<int> v(n);
+    std::vector<double> z(n + 1);
+
+    for (int ix = 0; ix < nx; ++ix) {
+      f.assign(ny, 0.0);
+      d.assign(ny, 0.0);
+      for (int iy = 0; iy < ny; ++iy) f[iy] = sq[static_cast<size_t>(iy) * nx + ix];
+      edt1d(f, d, v, z);
+      for (int iy = 0; iy < ny; ++iy) sq[static_cast<size_t>(iy) * nx + ix] = f[iy];
+    }
+    for (int iy = 0; iy < ny; ++iy) {
+      f.assign(sq.begin() + static_cast<long>(iy) * nx, sq.begin() + static_cast<long>(iy + 1) * nx);
+      d.assign(nx, 0.0);
+      edt1d(f, d, v, z);
+      std::copy(f.begin(), f.end(), sq.begin() + static_cast<long>(iy) * nx);
+    }
+  }
+
+  field->values_.resize(sq.size());
+  for (size_t i = 0; i < sq.size(); ++i) {
+    double value;
+    if (outside[i] > 0.0) {
+      value = std::min(outside[i], diag);
+    } else {
+      value = anyFree ? -std::sqrt(sq[i]) * resolution : -diag;
+    }
+    field->values_[i] = roundDown(value);
+  }
+
+  return field;
+}
+
+std::shared_ptr<const DistanceField> DistanceField::cached(const Map& map, double resolution) {
+  char key[64];
+  std::snprintf(key, sizeof(key), "DistanceField:%a", resolution); // exact, unlike to_string
+  return map.derived<DistanceField>(key, [&] { return build(map, resolution); });
+}
+
+double DistanceField::distance(const Vec2& p) const {
+  if (!bounds_.contains(p)) return -1.0;
+
+  const double fx = (p.x - bounds_.min.x) / h_;
+  const double fy = (p.y - bounds_.min.y) / h_;
+  const int ix = std::clamp(static_cast<int>(fx), 0, std::max(0, nx_ - 2));
+  const int iy = std::clamp(static_cast<int>(fy), 0, std::max(0, ny_ - 2));
+
+  double best = -std::numeric_limits<double>::infinity();
+  for (int cy = iy; cy <= std::min(iy + 1, ny_ - 1); ++cy) {
+    for (int cx = ix; cx <= std::min(ix + 1, nx_ - 1); ++cx) {
+      const double ox = bounds_.min.x + cx * h_ - p.x;
+      const double oy = bounds_.min.y + cy * h_ - p.y;
+      best = std::max(best, sample(cx, cy) - std::sqrt(ox * ox + oy * oy));
+    }
+  }
+  return best;
+}
+
+double DistanceField::raycast(const Vec2& origin, const Vec2& dirUnit, double maxRange,
+                              double hitEpsilon) const {
+  const int maxSteps = 512;
+
+  double t = 0.0;
+  for (int step = 0; step < maxSteps; ++step) {
+    const Vec2 p = origin + dirUnit * t;
+    if (!bounds_.contains(p)) return (t == 0.0) ? 0.0 : maxRange;
+
+    const double d = distance(p);
+    if (d < hitEpsilon) return t;
+
+    t += d;
+    if (t >= maxRange) return maxRange;
+  }
+  // Grazing rays converge slowly; stopping here errs on the side of a hit.
+  return t;
+}
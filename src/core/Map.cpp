@@ -1,11 +1,62 @@
 #include "core/Map.hpp"
+#include "core/BoxGrid.hpp"
+#include "core/EngineStats.hpp"
+#include "core/TraceRecorder.hpp"
+#include "core/VisibilityMatrix.hpp"
 #include "geom/Raycast.hpp"
+#include <algorithm>
+#include <cmath>
+
+Map::Map()
+  : snap_(std::make_shared<MapSnapshot>(AABB{Vec2{0,0}, Vec2{10,10}}, std::vector<AABB>{})) {}
+
+Map::Map(std::shared_ptr<const MapSnapshot> snapshot)
+  : snap_(std::move(snapshot)), ownsSnapshot_(false) {}
+
+MapSnapshot& Map::edit() {
+  pvs_.reset();
+  if (!ownsSnapshot_ || snap_.use_count() != 1) {
+    snap_ = std::make_shared<MapSnapshot>(snap_->worldBounds(), snap_->obstacles());
+    ownsSnapshot_ = true;
+  }
+  // Created non-const by a Map and held by no one else, so this is safe and
+  // invisible to other handles.
+  auto& own = const_cast<MapSnapshot&>(*snap_);
+  std::lock_guard<std::mutex> lock(own.derivedMutex_);
+  own.derived_.clear();
+  return own;
+}
+
+bool Map::setVisibilityMatrix(std::shared_ptr<const VisibilityMatrix> pvs) {
+  if (pvs && !pvs->builtFor(*this)) return false;
+  pvs_ = std::move(pvs);
+  return true;
+}
 
 bool Map::hasLineOfSight(const Vec2& from, const Vec2& to) const {
+  if (TraceRecorder::recording()) {
+    const std::uint64_t start = TraceRecorder::nowNs();
+    const bool visible = lineOfSight(from, to);
+    TraceRecorder::lineOfSight(*this, from, to, visible, start, TraceRecorder::nowNs());
+    return visible;
+  }
+  return lineOfSight(from, to);
+}
+
+bool Map::lineOfSight(const Vec2& from, const Vec2& to) const {
+  ENGINE_STAT_ADD(losQueries, 1);
+
   // If either point is out of bounds, treat as no LoS for MVP.
   if (!inBounds(from) || !inBounds(to)) return false;
 
-  for (const auto& ob : obstacles_) {
+  if (pvs_) {
+    const int a = pvs_->freeCellAt(from);
+    const int b = (a >= 0) ? pvs_->freeCellAt(to) : -1;
+    if (b >= 0) return pvs_->visible(a, b);
+  }
+
+  for (const auto& ob : obstacles()) {
+    ENGINE_STAT_ADD(boxTests, 1);
     if (segmentIntersectsAABB(from, to, ob)) {
       return false;
     }
@@ -13,13 +64,221 @@ bool Map::hasLineOfSight(const Vec2& from, const Vec2& to) const {
   return true;
 }
 
+void Map::hasLineOfSightBatch(const double* ax, const double* ay,
+                              const double* bx, const double* by,
+                              int n, unsigned char* visible) const {
+  ENGINE_STAT_ADD(losQueries, static_cast<std::uint64_t>(n));
+  ENGINE_STAT_ADD(boxTests, static_cast<std::uint64_t>(n) * obstacles().size());
+
+  // visible[] holds "blocked" until the final flip.
+  for (int i = 0; i < n; ++i) {
+    visible[i] = static_cast<unsigned char>(
+      !inBounds(Vec2{ax[i], ay[i]}) || !inBounds(Vec2{bx[i], by[i]}));
+  }
+  for (const auto& ob : obstacles()) {
+    segmentsIntersectAABB(ax, ay, bx, by, n, ob, visible);
+  }
+  for (int i = 0; i < n; ++i) visible[i] = static_cast<unsigned char>(visible[i] ^ 1);
+}
+
 bool Map::collidesCircleAt(const Vec2& center, double radius) const {
+  if (TraceRecorder::recording()) {
+    const std::uint64_t start = TraceRecorder::nowNs();
+    const bool hit = collidesCircle(center, radius);
+    TraceRecorder::collision(*this, center, radius, hit, start, TraceRecorder::nowNs());
+    return hit;
+  }
+  return collidesCircle(center, radius);
+}
+
+bool Map::collidesCircle(const Vec2& center, double radius) const {
+  ENGINE_STAT_ADD(collisionQueries, 1);
+
   if (!inBounds(center)) return true;
 
-  for (const auto& ob : obstacles_) {
+  for (const auto& ob : obstacles()) {
+    ENGINE_STAT_ADD(boxTests, 1);
     // Inflate obstacle by radius: then circle-center inside inflated box => overlap.
     const AABB inflated = ob.inflated(radius);
     if (inflated.contains(center)) return true;
   }
   return false; 
 }
+
+namespace {
+
+// Below this many boxes a straight scan beats walking a grid.
+constexpr size_t kRayGridMinObstacles = 32;
+
+// Buckets for raycasts, about one box per bucket, plus the boxes that reach
+// past the world (a ray can still hit those after the walk leaves it).
+struct RayGrid {
+  BoxGrid grid;
+  std::vector<int> outside;
+};
+
+std::shared_ptr<const RayGrid> rayGrid(const Map& map) {
+  return map.derived<RayGrid>("RayGrid", [&] {
+    const AABB& world = map.worldBounds();
+    const auto& obs = map.obstacles();
+    const double extent = std::max(world.max.x - world.min.x, world.max.y - world.min.y);
+    const double perSide = std::clamp(std::ceil(std::sqrt(static_cast<double>(obs.size()))), 1.0, 256.0);
+
+    auto out = std::make_shared<RayGrid>(RayGrid{BoxGrid(obs, world, extent / perSide), {}});
+    for (size_t i = 0; i < obs.size(); ++i) {
+      if (!world.contains(obs[i].min) || !world.contains(obs[i].max)) out->outside.push_back(static_cast<int>(i));
+    }
+    return out;
+  });
+}
+
+} // anonymous namespace
+
+RayHit Map::raycast(const Vec2& origin, const Vec2& dirUnit, double maxRange) const {
+  RayHit hit;
+  hit.distance = maxRange;
+
+  const auto& obs = obstacles();
+  if (obs.size() >= kRayGridMinObstacles && inBounds(origin)) {
+    const auto rays = rayGrid(*this);
+    const BoxGrid::Hit h = rays->grid.raycast(obs, origin, dirUnit, 0.0, maxRange);
+    hit.distance = h.distance;
+    hit.obstacle = h.index;
+    for (int i : rays->outside) {
+      const double t = rayIntersectAABB(origin, dirUnit, obs[i]);
+      if (t < hit.distance || (t == hit.distance && hit.obstacle > i)) {
+        hit.distance = t;
+        hit.obstacle = i;
+      }
+    }
+    hit.point = origin + dirUnit * hit.distance;
+    return hit;
+  }
+
+  for (size_t i = 0; i < obs.size(); ++i) {
+    const double t = rayIntersectAABB(origin, dirUnit, obs[i]);
+    if (t < hit.distance) {
+      hit.distance = t;
+      hit.obstacle = static_cast<int>(i);
+    }
+  }
+  hit.point = origin + dirUnit * hit.distance;
+  return hit;
+}
+
+namespace {
+
+constexpr double kTwoPi = 6.28318530717958647692;
+
+// Angle in (-pi, pi].
+double wrapAngle(double a) {
+  a = std::remainder(a, kTwoPi);
+  return a <= -kTwoPi / 2 ? a + kTwoPi : a;
+}
+
+double distanceToBox(const Vec2& p, const AABB& b) {
+  const double dx = std::max({b.min.x - p.x, 0.0, p.x - b.max.x});
+  const double dy = std::max({b.min.y - p.y, 0.0, p.y - b.max.y});
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+} // anonymous namespace
+
+std::vector<RayHit> Map::fanCast(const Vec2& origin, double startAngle, double endAngle,
+                                 int rays, double maxRange) const {
+  std::vector<RayHit> out;
+  if (rays <= 0) return out;
+
+  if (obstacles().size() >= kRayGridMinObstacles && inBounds(origin)) {
+    out.reserve(static_cast<size_t>(rays));
+    for (int r = 0; r < rays; ++r) {
+      const double angle = rays == 1
+          ? startAngle
+          : startAngle + (endAngle - startAngle) * static_cast<double>(r) / (rays - 1);
+      out.push_back(raycast(origin, Vec2{std::cos(angle), std::sin(angle)}, maxRange));
+    }
+    return out;
+  }
+
+  // Angles below are relative to the middle of the fan, so rays lie in
+  // [-half, half]. A box not containing the origin subtends less than pi
+  // around it; its interval is kept unwrapped around its centre's angle and
+  // tested against the ray shifted by a full turn either way.
+  const double centre = 0.5 * (startAngle + endAngle);
+  const double half = 0.5 * std::abs(endAngle - startAngle);
+  const bool wholeTurn = half >= kTwoPi / 2;
+  constexpr double kAngleSlack = 1e-9;
+
+  auto covers = [&](double lo, double hi, double a) {
+    for (double s : {0.0, kTwoPi, -kTwoPi}) {
+      if (a + s >= lo - kAngleSlack && a + s <= hi + kAngleSlack) return true;
+    }
+    return false;
+  };
+  auto overlapsFan = [&](double lo, double hi) {
+    for (double s : {0.0, kTwoPi, -kTwoPi}) {
+      if (hi + s >= -half - kAngleSlack && lo + s <= half + kAngleSlack) return true;
+    }
+    return false;
+  };
+
+  struct Candidate {
+    double near; // lower bound on any hit distance
+    double lo, hi;
+    int index;
+  };
+  std::vector<Candidate> candidates;
+
+  const auto& obs = obstacles();
+  for (size_t i = 0; i < obs.size(); ++i) {
+    const AABB& b = obs[i];
+    const double near = distanceToBox(origin, b);
+    if (near >= maxRange) continue;
+
+    Candidate c{near, -kTwoPi, kTwoPi, static_cast<int>(i)};
+    if (!b.contains(origin)) {
+      const Vec2 mid = (b.min + b.max) * 0.5 - origin;
+      const double base = std::atan2(mid.y, mid.x);
+      double lo = 0.0, hi = 0.0;
+      for (const Vec2& corner : {b.min, Vec2{b.max.x, b.min.y}, b.max, Vec2{b.min.x, b.max.y}}) {
+        const Vec2 d = corner - origin;
+        const double a = wrapAngle(std::atan2(d.y, d.x) - base);
+        lo = std::min(lo, a);
+        hi = std::max(hi, a);
+      }
+      const double rel = wrapAngle(base - centre);
+      c.lo = rel + lo;
+      c.hi = rel + hi;
+      if (!wholeTurn && !overlapsFan(c.lo, c.hi)) continue;
+    }
+    candidates.push_back(c);
+  }
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+    return a.near < b.near || (a.near == b.near && a.index < b.index);
+  });
+
+  out.reserve(static_cast<size_t>(rays));
+  for (int r = 0; r < rays; ++r) {
+    const double angle = rays == 1
+        ? startAngle
+        : startAngle + (endAngle - startAngle) * static_cast<double>(r) / (rays - 1);
+    const Vec2 dir{std::cos(angle), std::sin(angle)};
+    const double rel = angle - centre;
+
+    RayHit hit;
+    hit.distance = maxRange;
+    for (const Candidate& c : candidates) {
+      if (c.near > hit.distance + kAngleSlack) break;
+      if (!covers(c.lo, c.hi, rel)) continue;
+      const double t = rayIntersectAABB(origin, dir, obs[c.index]);
+      // Ties go to the lower index, as in raycast().
+      if (t < hit.distance || (t == hit.distance && hit.obstacle > c.index)) {
+        hit.distance = t;
+        hit.obstacle = c.index;
+      }
+    }
+    hit.point = origin + dir * hit.distance;
+    out.push_back(hit);
+  }
+  return out;
+}
@@ -0,0 +1,99 @@
+#include "core/MapSimplifier.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+bool containsBox(const AABB& outer, const AABB& inner) {
+  return inner.min.x >= outer.min.x && inner.max.x <= outer.max.x &&
+         inner.min.y >= outer.min.y && inner.max.y <= outer.max.y;
+}
+
+double area(const AABB& b) {
+  return (b.max.x - b.min.x) * (b.max.y - b.min.y);
+}
+
+// Drop every box that lies inside another one. Larger boxes are visited first
+// so a box is only ever tested against survivors that could contain it.
+std::size_t removeContained(std::vector<AABB>& boxes) {
+  std::stable_sort(boxes.begin(), boxes.end(), [](const AABB& a, const AABB& b) {
+    return area(a) > area(b);
+  });
+
+  std::vector<AABB> kept;
+  kept.reserve(boxes.size());
+
+  for (const auto& b : boxes) {
+    bool inside = false;
+    for (const auto& k : kept) {
+      if (containsBox(k, b)) { inside = true; break; }
+    }
+    if (!inside) kept.push_back(b);
+  }
+
+  const std::size_t removed = boxes.size() - kept.size();
+  boxes.swap(kept);
+  return removed;
+}
+
+// Fuse boxes that share the exact same [lo, hi] span on the cross axis and
+// touch or overlap along the main axis. Axis 0 merges along x, axis 1 along y.
+std::size_t mergeAlong(std::vector<AABB>& boxes, int axis) {
+  auto mainMin  = [axis](const AABB& b) { return axis == 0 ? b.min.x : b.min.y; };
+  auto mainMax  = [axis](const AABB& b) { return axis == 0 ? b.max.x : b.max.y; };
+  auto crossMin = [axis](const AABB& b) { return axis == 0 ? b.min.y : b.min.x; };
+  auto crossMax = [axis](const AABB& b) { return axis == 0 ? b.max.y : b.max.x; };
+
+  std::sort(boxes.begin(), boxes.end(), [&](const AABB& a, const AABB& b) {
+    if (crossMin(a) != crossMin(b)) return crossMin(a) < crossMin(b);
+    if (crossMax(a) != crossMax(b)) return crossMax(a) < crossMax(b);
+    return mainMin(a) < mainMin(b);
+  });
+
+  std::vector<AABB> out;
+  out.reserve(boxes.size());
+
+  for (const auto& b : boxes) {
+    if (!out.empty()) {
+      AABB& cur = out.back();
+      const bool sameBand = crossMin(cur) == crossMin(b) && crossMax(cur) == crossMax(b);
+      if (sameBand && mainMin(b) <= mainMax(cur)) {
+        if (axis == 0) cur.max.x = std::max(cur.max.x, b.max.x);
+        else           cur.max.y = std::max(cur.max.y, b.max.y);
+        continue;
+      }
+    }
+    out.push_back(b);
+  }
+
+  const std::size_t merged = boxes.size() - out.size();
+  boxes.swap(out);
+  return merged;
+}
+
+} // anonymous namespace
+
+SimplifyReport MapSimplifier::simplify(Map& map) const {
+  SimplifyReport report;
+
+  std::vector<AABB> boxes = map.obstacles();
+  report.obstaclesBefore = boxes.size();
+
+  // Each merge can expose new containments and new shared spans (a row of
+  // tiles fused along x can then fuse with the row above along y), so iterate
+  // to a fixed point. Every productive round shrinks the set, so this ends.
+  while (true) {
+    const std::size_t before = boxes.size();
+
+    report.containedRemoved += removeContained(boxes);
+    report.merged += mergeAlong(boxes, 0);
+    report.merged += mergeAlong(boxes, 1);
+
+    if (boxes.size() == before) break;
+  }
+
+  report.obstaclesAfter = boxes.size();
+  map.setObstacles(std::move(boxes));
+  return report;
+}
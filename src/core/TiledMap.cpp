@@ -0,0 +1,434 @@
+#include "core/TiledMap.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+#include "core/EngineStats.hpp"
+#include "core/Map.hpp"
+#include "geom/Raycast.hpp"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// On-disk layout: TiledHeader, tilesX * tilesY TileEntry (row-major), then
+// each tile's TileRecord run at its entry's offset.
+struct TiledHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t tilesX;
+  std::uint32_t tilesY;
+  std::uint32_t reserved;
+  double tileSize;
+  double minX, minY, maxX, maxY;
+};
+
+struct TileEntry {
+  std::uint64_t offset;
+  std::uint32_t count;
+  std::uint32_t reserved;
+};
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'P', 'S', 'T', 'I', 'L', 'E', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr int kBucketsPerSide = 8; // per-tile index resolution
+constexpr double kEdgeEps = 1e-9;  // in cell units; boundary points count for both cells
+
+struct TileRecord {
+  std::uint32_t id; // index in the source map, so extract() can keep order
+  std::uint32_t reserved;
+  double minX, minY, maxX, maxY;
+};
+
+int clampIndex(double v, int n) {
+  return std::clamp(static_cast<int>(std::floor(v)), 0, n - 1);
+}
+
+// Index range [lo, hi] of the cells of a 1D grid (origin o, size h, n cells)
+// touched by the closed interval [a, b].
+void cellRange(double a, double b, double o, double h, int n, int& lo, int& hi) {
+  lo = clampIndex((a - o) / h - kEdgeEps, n);
+  hi = clampIndex((b - o) / h + kEdgeEps, n);
+}
+
+// Calls fn(ix, iy) for every cell of an nx x ny grid that segment a-b passes
+// through, row by row, until fn returns true.
+template <class Fn>
+bool anyCellAlong(const Vec2& a, const Vec2& b, const Vec2& origin, double h, int nx, int ny, Fn fn) {
+  int j0, j1;
+  cellRange(std::min(a.y, b.y), std::max(a.y, b.y), origin.y, h, ny, j0, j1);
+
+  const double ylo = std::min(a.y, b.y), yhi = std::max(a.y, b.y);
+  for (int j = j0; j <= j1; ++j) {
+    // Part of the segment inside this row's slab
+    const double s0 = std::clamp(origin.y + j * h, ylo, yhi);
+    const double s1 = std::clamp(origin.y + (j + 1) * h, ylo, yhi);
+
+    double x0 = std::min(a.x, b.x), x1 = std::max(a.x, b.x);
+    if (a.y != b.y) {
+      const double k = (b.x - a.x) / (b.y - a.y);
+      const double xa = a.x + (s0 - a.y) * k;
+      const double xb = a.x + (s1 - a.y) * k;
+      x0 = std::max(x0, std::min(xa, xb));
+      x1 = std::min(x1, std::max(xa, xb));
+    }
+
+    int i0, i1;
+    cellRange(x0, x1, origin.x, h, nx, i0, i1);
+    for (int i = i0; i <= i1; ++i) {
+      if (fn(i, j)) return true;
+    }
+  }
+  return false;
+}
+
+// Liang-Barsky clip of a-b to r. False if they do not meet.
+bool clipSegment(const Vec2& a, const Vec2& b, const AABB& r, Vec2& ca, Vec2& cb) {
+  double t0 = 0.0, t1 = 1.0;
+  const Vec2 d = b - a;
+  const double p[4] = {-d.x, d.x, -d.y, d.y};
+  const double q[4] = {a.x - r.min.x, r.max.x - a.x, a.y - r.min.y, r.max.y - a.y};
+  for (int i = 0; i < 4; ++i) {
+    if (p[i] == 0.0) {
+      if (q[i] < 0.0) return false;
+      continue;
+    }
+    const double t = q[i] / p[i];
+    if (p[i] < 0.0) t0 = std::max(t0, t);
+    else t1 = std::min(t1, t);
+    if (t0 > t1) return false;
+  }
+  ca = a + d * t0;
+  cb = a + d * t1;
+  return true;
+}
+
+bool overlaps(const AABB& a, const AABB& b) {
+  return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+} // anonymous namespace
+
+struct TiledMap::Tile {
+  AABB rect;
+  double bucketSize = 1.0;
+  std::vector<AABB> boxes;
+  std::vector<std::uint32_t> ids;
+  std::vector<std::vector<std::uint32_t>> buckets; // local box indices
+
+  void buildIndex() {
+    buckets.assign(kBucketsPerSide * kBucketsPerSide, {});
+    for (std::uint32_t i = 0; i < boxes.size(); ++i) {
+      int x0, x1, y0, y1;
+      cellRange(boxes[i].min.x, boxes[i].max.x, rect.min.x, bucketSize, kBucketsPerSide, x0, x1);
+      cellRange(boxes[i].min.y, boxes[i].max.y, rect.min.y, bucketSize, kBucketsPerSide, y0, y1);
+      for (int y = y0; y <= y1; ++y)
+        for (int x = x0; x <= x1; ++x) buckets[y * kBucketsPerSide + x].push_back(i);
+    }
+  }
+
+  const std::vector<std::uint32_t>& bucket(int x, int y) const { return buckets[y * kBucketsPerSide + x]; }
+};
+
+TiledMap::~TiledMap() {
+#if !defined(_WIN32)
+  if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+bool TiledMap::write(const std::string& path, const Map& map, double tileSize) {
+  if (!(tileSize > 0.0)) return false;
+
+  const AABB& world = map.worldBounds();
+  const int tx = std::max(1, static_cast<int>(std::ceil((world.max.x - world.min.x) / tileSize)));
+  const int ty = std::max(1, static_cast<int>(std::ceil((world.max.y - world.min.y) / tileSize)));
+
+  std::vector<std::vector<TileRecord>> tiles(static_cast<size_t>(tx) * ty);
+  const auto& obstacles = map.obstacles();
+  for (std::uint32_t id = 0; id < obstacles.size(); ++id) {
+    const AABB& b = obstacles[id];
+    int x0, x1, y0, y1;
+    cellRange(b.min.x, b.max.x, world.min.x, tileSize, tx, x0, x1);
+    cellRange(b.min.y, b.max.y, world.min.y, tileSize, ty, y0, y1);
+    for (int y = y0; y <= y1; ++y)
+      for (int x = x0; x <= x1; ++x)
+        tiles[static_cast<size_t>(y) * tx + x].push_back(TileRecord{id, 0, b.min.x, b.min.y, b.max.x, b.max.y});
+  }
+
+  TiledHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.tilesX = static_cast<std::uint32_t>(tx);
+  header.tilesY = static_cast<std::uint32_t>(ty);
+  header.tileSize = tileSize;
+  header.minX = world.min.x;
+  header.minY = world.min.y;
+  header.maxX = world.max.x;
+  header.maxY = world.max.y;
+
+  std::vector<TileEntry> directory(tiles.size());
+  std::uint64_t offset = sizeof(TiledHeader) + sizeof(TileEntry) * directory.size();
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    directory[i] = TileEntry{offset, static_cast<std::uint32_t>(tiles[i].size()), 0};
+    offset += sizeof(TileRecord) * tiles[i].size();
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) return false;
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(directory.data()),
+            static_cast<std::streamsize>(sizeof(TileEntry) * directory.size()));
+  for (const auto& t : tiles) {
+    out.write(reinterpret_cast<const char*>(t.data()),
+              static_cast<std::streamsize>(sizeof(TileRecord) * t.size()));
+  }
+  return static_cast<bool>(out);
+}
+
+std::shared_ptr<TiledMap> TiledMap::open(const std::string& path, int maxResidentTiles) {
+  std::shared_ptr<TiledMap> map(new TiledMap());
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return nullptr;
+
+  file.seekg(0, std::ios::end);
+  const auto fileSize = static_cast<std::uint64_t>(file.tellg());
+  file.seekg(0);
+
+  TiledHeader header{};
+  if (fileSize < sizeof(header)) return nullptr;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) return nullptr;
+  if (header.version != kVersion || header.tilesX == 0 || header.tilesY == 0) return nullptr;
+  if (!(header.tileSize > 0.0) || !(header.maxX >= header.minX) || !(header.maxY >= header.minY)) return nullptr;
+
+  const std::uint64_t tileCount = static_cast<std::uint64_t>(header.tilesX) * header.tilesY;
+  if (sizeof(header) + tileCount * sizeof(TileEntry) > fileSize) return nullptr;
+
+  map->directory_.resize(tileCount);
+  file.read(reinterpret_cast<char*>(map->directory_.data()),
+            static_cast<std::streamsize>(tileCount * sizeof(TileEntry)));
+  if (!file) return nullptr;
+  for (const auto& e : map->directory_) {
+    if (e.offset + static_cast<std::uint64_t>(e.count) * sizeof(TileRecord) > fileSize) return nullptr;
+  }
+
+#if !defined(_WIN32)
+  map->fd_ = ::open(path.c_str(), O_RDONLY);
+  if (map->fd_ < 0) return nullptr;
+#endif
+  map->path_ = path;
+  map->worldBounds_ = AABB{Vec2{header.minX, header.minY}, Vec2{header.maxX, header.maxY}};
+  map->tileSize_ = header.tileSize;
+  map->tilesX_ = static_cast<int>(header.tilesX);
+  map->tilesY_ = static_cast<int>(header.tilesY);
+  map->maxResident_ = std::max(1, maxResidentTiles);
+  return map;
+}
+
+// Reads from any thread without a shared file position.
+bool TiledMap::readAt(std::uint64_t offset, void* dst, std::size_t bytes) const {
+#if !defined(_WIN32)
+  auto* out = static_cast<char*>(dst);
+  while (bytes > 0) {
+    const ssize_t n = ::pread(fd_, out, bytes, static_cast<off_t>(offset));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    out += n;
+    offset += static_cast<std::uint64_t>(n);
+    bytes -= static_cast<std::size_t>(n);
+  }
+  return true;
+#else
+  std::ifstream file(path_, std::ios::binary);
+  file.seekg(static_cast<std::streamoff>(offset));
+  file.read(static_cast<char*>(dst), static_cast<std::streamsize>(bytes));
+  return static_cast<bool>(file);
+#endif
+}
+
+std::shared_ptr<const TiledMap::Tile> TiledMap::loadTile(int index) const {
+  const TileEntry& e = directory_[index];
+
+  auto tile = std::make_shared<Tile>();
+  const int tx = index % tilesX_;
+  const int ty = index / tilesX_;
+  tile->rect.min = Vec2{worldBounds_.min.x + tx * tileSize_, worldBounds_.min.y + ty * tileSize_};
+  tile->rect.max = tile->rect.min + Vec2{tileSize_, tileSize_};
+  tile->bucketSize = tileSize_ / kBucketsPerSide;
+
+  std::vector<TileRecord> records(e.count);
+  if (!readAt(e.offset, records.data(), sizeof(TileRecord) * records.size())) {
+    // Truncated or unreadable since open(). An empty tile would let queries
+    // see through its walls.
+    throw std::runtime_error("cannot read tile " + std::to_string(index) + " of " + path_);
+  }
+
+  tile->boxes.reserve(records.size());
+  tile->ids.reserve(records.size());
+  for (const auto& r : records) {
+    tile->boxes.push_back(AABB{Vec2{r.minX, r.minY}, Vec2{r.maxX, r.maxY}});
+    tile->ids.push_back(r.id);
+  }
+  tile->buildIndex();
+  return tile;
+}
+
+std::shared_ptr<const TiledMap::Tile> TiledMap::tile(int tx, int ty) const {
+  const int index = ty * tilesX_ + tx;
+
+  std::shared_ptr<Slot> slot;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = resident_.find(index);
+    if (it != resident_.end()) slot = it->second;
+  }
+  if (slot) {
+    slot->lastUse.store(++clock_, std::memory_order_relaxed);
+    return slot->tile.get(); // waits if another thread is still reading it
+  }
+
+  // Miss: reserve the slot, evicting the least recently used tile if full.
+  // Threads holding an evicted slot keep its tile until they are done.
+  std::promise<std::shared_ptr<const Tile>> loaded;
+  std::shared_ptr<Slot> mine;
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto& entry = resident_[index];
+    if (entry) {
+      slot = entry;
+    } else {
+      entry = mine = std::make_shared<Slot>();
+      mine->tile = loaded.get_future().share();
+      mine->lastUse.store(++clock_, std::memory_order_relaxed);
+      while (static_cast<int>(resident_.size()) > maxResident_) {
+        auto oldest = resident_.end();
+        for (auto it = resident_.begin(); it != resident_.end(); ++it) {
+          if (it->first == index) continue;
+          if (oldest == resident_.end() || it->second->lastUse < oldest->second->lastUse) oldest = it;
+        }
+        resident_.erase(oldest);
+      }
+    }
+  }
+  if (slot) {
+    slot->lastUse.store(++clock_, std::memory_order_relaxed);
+    return slot->tile.get();
+  }
+
+  std::shared_ptr<const Tile> t;
+  try {
+    t = loadTile(index);
+  } catch (...) {
+    loaded.set_exception(std::current_exception());
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = resident_.find(index);
+    if (it != resident_.end() && it->second == mine) resident_.erase(it);
+    throw;
+  }
+  loads_++;
+  loaded.set_value(t);
+  return t;
+}
+
+bool TiledMap::hasLineOfSight(const Vec2& from, const Vec2& to) const {
+  ENGINE_STAT_ADD(losQueries, 1);
+
+  // Same convention as Map: out of bounds counts as blocked.
+  if (!inBounds(from) || !inBounds(to)) return false;
+
+  const bool blocked = anyCellAlong(from, to, worldBounds_.min, tileSize_, tilesX_, tilesY_, [&](int tx, int ty) {
+    const auto t = tile(tx, ty);
+    if (t->boxes.empty()) return false;
+
+    Vec2 a, b;
+    if (!clipSegment(from, to, t->rect.inflated(kEdgeEps * tileSize_), a, b)) return false;
+
+    return anyCellAlong(a, b, t->rect.min, t->bucketSize, kBucketsPerSide, kBucketsPerSide, [&](int bx, int by) {
+      for (std::uint32_t i : t->bucket(bx, by)) {
+        ENGINE_STAT_ADD(boxTests, 1);
+        if (segmentIntersectsAABB(from, to, t->boxes[i])) return true;
+      }
+      return false;
+    });
+  });
+  return !blocked;
+}
+
+bool TiledMap::collidesCircleAt(const Vec2& center, double radius) const {
+  ENGINE_STAT_ADD(collisionQueries, 1);
+
+  if (!inBounds(center)) return true;
+
+  // Any box whose inflated copy holds the centre overlaps this square.
+  const AABB square{center - Vec2{radius, radius}, center + Vec2{radius, radius}};
+  int tx0, tx1, ty0, ty1;
+  cellRange(square.min.x, square.max.x, worldBounds_.min.x, tileSize_, tilesX_, tx0, tx1);
+  cellRange(square.min.y, square.max.y, worldBounds_.min.y, tileSize_, tilesY_, ty0, ty1);
+
+  for (int ty = ty0; ty <= ty1; ++ty) {
+    for (int tx = tx0; tx <= tx1; ++tx) {
+      const auto t = tile(tx, ty);
+      if (t->boxes.empty()) continue;
+
+      int bx0, bx1, by0, by1;
+      cellRange(square.min.x, square.max.x, t->rect.min.x, t->bucketSize, kBucketsPerSide, bx0, bx1);
+      cellRange(square.min.y, square.max.y, t->rect.min.y, t->bucketSize, kBucketsPerSide, by0, by1);
+      for (int by = by0; by <= by1; ++by) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+          for (std::uint32_t i : t->bucket(bx, by)) {
+            ENGINE_STAT_ADD(boxTests, 1);
+            if (t->boxes[i].inflated(radius).contains(center)) return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+Map TiledMap::extract(const AABB& area, double padding) const {
+  const AABB bounds{Vec2{std::max(area.min.x, worldBounds_.min.x), std::max(area.min.y, worldBounds_.min.y)},
+                    Vec2{std::min(area.max.x, worldBounds_.max.x), std::min(area.max.y, worldBounds_.max.y)}};
+  const AABB reach = area.inflated(padding);
+
+  std::vector<std::pair<std::uint32_t, AABB>> found;
+  int tx0, tx1, ty0, ty1;
+  cellRange(reach.min.x, reach.max.x, worldBounds_.min.x, tileSize_, tilesX_, tx0, tx1);
+  cellRange(reach.min.y, reach.max.y, worldBounds_.min.y, tileSize_, tilesY_, ty0, ty1);
+  for (int ty = ty0; ty <= ty1; ++ty) {
+    for (int tx = tx0; tx <= tx1; ++tx) {
+      const auto t = tile(tx, ty);
+      for (size_t i = 0; i < t->boxes.size(); ++i) {
+        if (overlaps(t->boxes[i], reach)) found.emplace_back(t->ids[i], t->boxes[i]);
+      }
+    }
+  }
+
+  // Boxes spanning several tiles were seen once per tile; keep source order.
+  std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  found.erase(std::unique(found.begin(), found.end(),
+                          [](const auto& a, const auto& b) { return a.first == b.first; }),
+              found.end());
+
+  Map out;
+  out.setWorldBounds(bounds);
+  for (const auto& f : found) out.addObstacle(f.second);
+  return out;
+}
+
+int TiledMap::residentTiles() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return static_cast<int>(resident_.size());
+}
+
+std::uint64_t TiledMap::tileLoads() const {
+  return loads_.load();
+}
@@ -0,0 +1,460 @@
+#include "core/TraceRecorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// File layout: 8-byte magic, u32 version, then chunks of
+// [u32 thread][u32 byteCount][records...]. Each thread writes a map
+// definition into its own stream before its first call on that map, under a
+// thread-local id; the record also carries a session-wide key so the reader
+// can merge copies written by different threads. Records start with a
+// one-byte kind; all fields are native byte order.
+//
+// Recording threads never lock and never touch the file: full buffers are
+// pushed onto a lock-free stack that a writer thread drains.
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'P', 'S', 'T', 'R', 'A', 'C', 'E'};
+constexpr std::uint32_t kVersion = 3; // 2: Analyze records carry fovDegrees; 3: per-thread map ids
+constexpr std::uint32_t kStopThread = 0xffffffffu; // writer sentinel, never in the file
+constexpr std::uint8_t kMapRecord = 4;
+constexpr std::size_t kFlushBytes = 1 << 20;
+
+// One recording thread's state. Slots are never freed: a thread that exits
+// releases its slot and a later thread may take it over.
+struct ThreadBuffer {
+  std::atomic<bool> claimed{true};
+  std::atomic<bool> busy{false}; // inside a record call; stop() waits for it to clear
+  ThreadBuffer* next = nullptr;  // slot list; fixed once published
+
+  // Touched only by the owning thread while busy, or by stop() once idle.
+  std::uint64_t generation = 0;
+  std::uint32_t thread = 0;
+  std::vector<unsigned char> data;
+  std::unordered_map<const MapSnapshot*, std::uint32_t> mapIds; // this thread's ids
+  std::vector<std::shared_ptr<const MapSnapshot>> pinned;       // keeps keys unambiguous
+  const MapSnapshot* lastSnap = nullptr;
+  std::uint32_t lastMap = 0;
+};
+
+struct Chunk {
+  std::uint32_t thread = 0;
+  std::vector<unsigned char> data;
+  Chunk* next = nullptr;
+};
+
+std::atomic<ThreadBuffer*> gSlots{nullptr};
+std::atomic<Chunk*> gPending{nullptr};
+std::atomic<std::uint64_t> gGeneration{0};
+std::atomic<std::uint64_t> gOrigin{0};
+std::atomic<std::uint32_t> gThreads{0};
+
+void push(std::unique_ptr<Chunk> chunk) {
+  Chunk* c = chunk.release();
+  c->next = gPending.load(std::memory_order_relaxed);
+  while (!gPending.compare_exchange_weak(c->next, c, std::memory_order_release, std::memory_order_relaxed)) {}
+  gPending.notify_one();
+}
+
+void pushData(std::uint32_t thread, std::vector<unsigned char>& data) {
+  if (data.empty()) return;
+  auto chunk = std::make_unique<Chunk>();
+  chunk->thread = thread;
+  chunk->data.swap(data);
+  push(std::move(chunk));
+}
+
+void writeChunk(std::ofstream& file, std::uint32_t thread, const std::vector<unsigned char>& data) {
+  const auto bytes = static_cast<std::uint32_t>(data.size());
+  file.write(reinterpret_cast<const char*>(&thread), sizeof(thread));
+  file.write(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+  file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+// Writer thread: drains the stack in push order until the stop sentinel.
+void drain(std::ofstream& file) {
+  for (;;) {
+    Chunk* head = gPending.exchange(nullptr, std::memory_order_acquire);
+    if (!head) {
+      gPending.wait(nullptr, std::memory_order_acquire);
+      continue;
+    }
+    Chunk* ordered = nullptr;
+    while (head) {
+      Chunk* next = head->next;
+      head->next = ordered;
+      ordered = head;
+      head = next;
+    }
+    bool last = false;
+    while (ordered) {
+      std::unique_ptr<Chunk> c(ordered);
+      ordered = c->next;
+      if (c->thread == kStopThread) last = true;
+      else writeChunk(file, c->thread, c->data);
+    }
+    if (last) return;
+  }
+}
+
+struct Session {
+  std::mutex mutex; // serializes start() and stop(); never taken on the record path
+  std::ofstream file;
+  std::thread writer;
+  std::uint64_t generation = 0;
+
+  void joinWriter() {
+    auto stop = std::make_unique<Chunk>();
+    stop->thread = kStopThread;
+    push(std::move(stop));
+    writer.join();
+  }
+
+  ~Session() {
+    if (writer.joinable()) joinWriter();
+  }
+};
+
+Session& session() {
+  static Session s;
+  return s;
+}
+
+thread_local int tDepth = 0;
+
+template <class T>
+void put(std::vector<unsigned char>& out, const T& v) {
+  const auto* p = reinterpret_cast<const unsigned char*>(&v);
+  out.insert(out.end(), p, p + sizeof(T));
+}
+
+// The calling thread's slot: a released one if any, else a new one.
+ThreadBuffer& threadSlot() {
+  struct Owner {
+    ThreadBuffer* slot = nullptr;
+    ~Owner() {
+      if (slot) slot->claimed.store(false, std::memory_order_release);
+    }
+  };
+  thread_local Owner owner;
+  if (owner.slot) return *owner.slot;
+
+  for (ThreadBuffer* b = gSlots.load(std::memory_order_acquire); b; b = b->next) {
+    bool expected = false;
+    if (b->claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) return *(owner.slot = b);
+  }
+  auto* b = new ThreadBuffer;
+  b->next = gSlots.load(std::memory_order_relaxed);
+  while (!gSlots.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed)) {}
+  return *(owner.slot = b);
+}
+
+void resetSlot(ThreadBuffer& buf) {
+  buf.data.clear();
+  buf.mapIds.clear();
+  buf.pinned.clear();
+  buf.lastSnap = nullptr;
+}
+
+// Marks the calling thread's slot busy for one record call. Holds only while
+// recording; stop() clears the flag first and then waits for busy slots, so
+// either this sees the flag down or stop() sees the slot busy.
+class Entry {
+public:
+  explicit Entry(const std::atomic<bool>& recording) : buf_(threadSlot()) {
+    buf_.busy.store(true, std::memory_order_seq_cst);
+    if (!recording.load(std::memory_order_seq_cst)) return;
+    const std::uint64_t gen = gGeneration.load(std::memory_order_acquire);
+    if (buf_.generation != gen) {
+      resetSlot(buf_);
+      buf_.generation = gen;
+      buf_.thread = gThreads.fetch_add(1, std::memory_order_relaxed);
+    }
+    active_ = true;
+  }
+  ~Entry() { buf_.busy.store(false, std::memory_order_release); }
+
+  explicit operator bool() const { return active_; }
+  ThreadBuffer& buffer() { return buf_; }
+
+private:
+  ThreadBuffer& buf_;
+  bool active_ = false;
+};
+
+// The thread-local id of the map's snapshot, writing its definition into the
+// thread's stream the first time this thread sees it.
+std::uint32_t mapId(ThreadBuffer& buf, const Map& map) {
+  const MapSnapshot* snap = map.snapshot().get();
+  if (snap == buf.lastSnap) return buf.lastMap;
+
+  const auto [it, inserted] = buf.mapIds.try_emplace(snap, static_cast<std::uint32_t>(buf.pinned.size()));
+  if (inserted) {
+    buf.pinned.push_back(map.snapshot());
+    put(buf.data, kMapRecord);
+    put(buf.data, it->second);
+    put(buf.data, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(snap)));
+    const AABB& b = snap->worldBounds();
+    put(buf.data, b.min.x); put(buf.data, b.min.y); put(buf.data, b.max.x); put(buf.data, b.max.y);
+    put(buf.data, static_cast<std::uint32_t>(snap->obstacles().size()));
+    for (const auto& o : snap->obstacles()) {
+      put(buf.data, o.min.x); put(buf.data, o.min.y); put(buf.data, o.max.x); put(buf.data, o.max.y);
+    }
+  }
+  buf.lastSnap = snap;
+  buf.lastMap = it->second;
+  return it->second;
+}
+
+void flushIfFull(ThreadBuffer& buf) {
+  if (buf.data.size() >= kFlushBytes) pushData(buf.thread, buf.data);
+}
+
+void putHead(std::vector<unsigned char>& out, TraceCall::Kind kind, std::uint32_t map,
+             std::uint64_t startNs, std::uint64_t endNs) {
+  const std::uint64_t origin = gOrigin.load(std::memory_order_relaxed);
+  put(out, static_cast<std::uint8_t>(kind));
+  put(out, map);
+  put(out, startNs - origin);
+  put(out, static_cast<std::uint32_t>(std::min<std::uint64_t>(endNs - startNs, 0xffffffffu)));
+}
+
+void putAgent(std::vector<unsigned char>& out, const Agent& a) {
+  put(out, a.pos.x); put(out, a.pos.y);
+  put(out, a.facing.x); put(out, a.facing.y);
+  put(out, a.radius); put(out, a.speed);
+}
+
+} // anonymous namespace
+
+std::uint64_t TraceRecorder::nowNs() {
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool TraceRecorder::start(const std::string& path) {
+  Session& s = session();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (recording_) return false;
+
+  s.file.open(path, std::ios::binary | std::ios::trunc);
+  if (!s.file) return false;
+  s.file.write(kMagic, sizeof(kMagic));
+  s.file.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+
+  gOrigin.store(nowNs(), std::memory_order_relaxed);
+  gThreads.store(0, std::memory_order_relaxed);
+  gGeneration.store(++s.generation, std::memory_order_release);
+  s.writer = std::thread(drain, std::ref(s.file));
+  recording_.store(true, std::memory_order_seq_cst);
+  return true;
+}
+
+bool TraceRecorder::stop() {
+  Session& s = session();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  if (!s.file.is_open()) return false;
+  recording_.store(false, std::memory_order_seq_cst);
+
+  // No record call can start touching a slot from here on; let the ones in
+  // flight finish, then hand over what they buffered.
+  for (ThreadBuffer* b = gSlots.load(std::memory_order_acquire); b; b = b->next) {
+    while (b->busy.load(std::memory_order_seq_cst)) std::this_thread::yield();
+    if (b->generation == s.generation) pushData(b->thread, b->data);
+    resetSlot(*b);
+  }
+  s.joinWriter();
+
+  const bool ok = static_cast<bool>(s.file);
+  s.file.close();
+  return ok;
+}
+
+void TraceRecorder::lineOfSight(const Map& map, const Vec2& from, const Vec2& to, bool visible,
+                                std::uint64_t startNs, std::uint64_t endNs) {
+  if (tDepth > 0) return;
+  Entry entry(recording_);
+  if (!entry) return;
+  ThreadBuffer& buf = entry.buffer();
+  const std::uint32_t id = mapId(buf, map);
+  putHead(buf.data, TraceCall::LineOfSight, id, startNs, endNs);
+  put(buf.data, from.x); put(buf.data, from.y);
+  put(buf.data, to.x); put(buf.data, to.y);
+  put(buf.data, static_cast<std::uint8_t>(visible));
+  flushIfFull(buf);
+}
+
+void TraceRecorder::collision(const Map& map, const Vec2& center, double radius, bool hit,
+                              std::uint64_t startNs, std::uint64_t endNs) {
+  if (tDepth > 0) return;
+  Entry entry(recording_);
+  if (!entry) return;
+  ThreadBuffer& buf = entry.buffer();
+  const std::uint32_t id = mapId(buf, map);
+  putHead(buf.data, TraceCall::Collision, id, startNs, endNs);
+  put(buf.data, center.x); put(buf.data, center.y);
+  put(buf.data, radius);
+  put(buf.data, static_cast<std::uint8_t>(hit));
+  flushIfFull(buf);
+}
+
+TraceRecorder::AnalyzeScope::AnalyzeScope(const Scene& scene) {
+  if (!recording()) return;
+  counted_ = true;
+  if (tDepth++ == 0) {
+    scene_ = &scene;
+    start_ = nowNs();
+  }
+}
+
+void TraceRecorder::AnalyzeScope::finish(double areaRatio, double exposureWidth, double visibleFraction) {
+  metrics_[0] = areaRatio;
+  metrics_[1] = exposureWidth;
+  metrics_[2] = visibleFraction;
+  finished_ = true;
+}
+
+TraceRecorder::AnalyzeScope::~AnalyzeScope() {
+  if (!counted_) return;
+  --tDepth;
+  if (!scene_ || !finished_ || !recording()) return;
+
+  const std::uint64_t end = nowNs();
+  Entry entry(recording_);
+  if (!entry) return;
+  ThreadBuffer& buf = entry.buffer();
+  const std::uint32_t id = mapId(buf, scene_->map);
+  putHead(buf.data, TraceCall::Analyze, id, start_, end);
+  put(buf.data, scene_->T);
+  put(buf.data, scene_->cellSize);
+  put(buf.data, static_cast<std::int32_t>(scene_->visibilitySamples));
+  put(buf.data, scene_->fovDegrees);
+  putAgent(buf.data, scene_->self);
+  putAgent(buf.data, scene_->enemy);
+  for (double m : metrics_) put(buf.data, m);
+  flushIfFull(buf);
+}
+
+// ---- Reader ----
+
+namespace {
+
+class Cursor {
+public:
+  Cursor(const unsigned char* p, std::size_t n) : p_(p), end_(p + n) {}
+
+  template <class T>
+  bool get(T& v) {
+    if (static_cast<std::size_t>(end_ - p_) < sizeof(T)) return false;
+    std::memcpy(&v, p_, sizeof(T));
+    p_ += sizeof(T);
+    return true;
+  }
+  bool done() const { return p_ == end_; }
+
+private:
+  const unsigned char* p_;
+  const unsigned char* end_;
+};
+
+bool getVec(Cursor& c, Vec2& v) { return c.get(v.x) && c.get(v.y); }
+
+bool getAgent(Cursor& c, Agent& a) {
+  return getVec(c, a.pos) && getVec(c, a.facing) && c.get(a.radius) && c.get(a.speed);
+}
+
+} // anonymous namespace
+
+bool TraceFile::load(const std::string& path) {
+  maps.clear();
+  scenes.clear();
+  calls.clear();
+
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  Cursor file(bytes.data(), bytes.size());
+  char magic[8];
+  std::uint32_t version = 0;
+  for (char& m : magic) if (!file.get(m)) return false;
+  if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !file.get(version) || version != kVersion) return false;
+
+  const unsigned char* base = bytes.data() + sizeof(kMagic) + sizeof(version);
+  std::size_t offset = 0;
+  const std::size_t total = bytes.size() - sizeof(kMagic) - sizeof(version);
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> localMaps; // per thread: id -> maps index
+  std::unordered_map<std::uint64_t, std::uint32_t> mapKeys;                 // snapshot key -> maps index
+
+  while (offset < total) {
+    Cursor head(base + offset, total - offset);
+    std::uint32_t thread = 0, count = 0;
+    if (!head.get(thread) || !head.get(count)) return false;
+    offset += sizeof(thread) + sizeof(count);
+    if (count > total - offset) return false;
+
+    Cursor c(base + offset, count);
+    offset += count;
+
+    while (!c.done()) {
+      std::uint8_t kind = 0;
+      if (!c.get(kind)) return false;
+
+      std::vector<std::uint32_t>& local = localMaps[thread];
+      if (kind == kMapRecord) {
+        std::uint32_t id = 0, n = 0;
+        std::uint64_t key = 0;
+        AABB bounds;
+        if (!c.get(id) || !c.get(key) || !getVec(c, bounds.min) || !getVec(c, bounds.max) || !c.get(n)) return false;
+        if (id != local.size()) return false;
+        std::vector<AABB> boxes(n);
+        for (auto& b : boxes) if (!getVec(c, b.min) || !getVec(c, b.max)) return false;
+        const auto [it, inserted] = mapKeys.try_emplace(key, static_cast<std::uint32_t>(maps.size()));
+        if (inserted) {
+          Map map;
+          map.setWorldBounds(bounds);
+          map.setObstacles(std::move(boxes));
+          maps.push_back(std::move(map));
+        }
+        local.push_back(it->second);
+        continue;
+      }
+
+      TraceCall call;
+      call.kind = static_cast<TraceCall::Kind>(kind);
+      call.thread = thread;
+      if (!c.get(call.map) || !c.get(call.startNs) || !c.get(call.durationNs)) return false;
+      if (call.map >= local.size()) return false;
+      call.map = local[call.map];
+
+      std::uint8_t result = 0;
+      if (kind == TraceCall::LineOfSight) {
+        if (!getVec(c, call.a) || !getVec(c, call.b) || !c.get(result)) return false;
+      } else if (kind == TraceCall::Collision) {
+        if (!getVec(c, call.a) || !c.get(call.radius) || !c.get(result)) return false;
+      } else if (kind == TraceCall::Analyze) {
+        Scene scene;
+        std::int32_t samples = 0;
+        if (!c.get(scene.T) || !c.get(scene.cellSize) || !c.get(samples) ||
+            !c.get(scene.fovDegrees) || !getAgent(c, scene.self) || !getAgent(c, scene.enemy)) return false;
+        for (double& m : call.metrics) if (!c.get(m)) return false;
+        scene.visibilitySamples = samples;
+        scene.map = maps[call.map];
+        call.scene = static_cast<std::uint32_t>(scenes.size());
+        scenes.push_back(std::move(scene));
+      } else {
+        return false;
+      }
+      call.result = result != 0;
+      calls.push_back(call);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,359 @@
+#include "core/VisibilityMatrix.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#include "core/Map.hpp"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// On-disk and in-memory layout, in order:
+//   PvsHeader
+//   int32  cellToFree[cols * rows]   (-1 for blocked cells)
+//   uint32 freeToCell[freeCount]
+//   uint32 rowOffsets[freeCount + 1] (indices into spans)
+//   Span   spans[spanCount]
+struct PvsHeader {
+  char magic[8];
+  double originX; // world min corner
+  double originY;
+  double worldMaxX;
+  double worldMaxY;
+  double cellSize;
+  std::uint64_t geometryHash; // of the map it was built for
+  std::uint32_t cols;
+  std::uint32_t rows;
+  std::uint32_t freeCount;
+  std::uint32_t spanCount;
+};
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'P', 'S', 'P', 'V', 'S', '0', '2'}; // 02: world extent and geometry hash
+
+// FNV-1a over the world bounds and every obstacle, cached on the snapshot.
+std::uint64_t geometryHash(const Map& map) {
+  return *map.derived<std::uint64_t>("GeometryHash", [&] {
+    std::uint64_t h = 14695981039346656037ull;
+    const auto mix = [&](double v) {
+      unsigned char bytes[sizeof(v)];
+      std::memcpy(bytes, &v, sizeof(v));
+      for (unsigned char b : bytes) h = (h ^ b) * 1099511628211ull;
+    };
+    const auto mixBox = [&](const AABB& b) {
+      mix(b.min.x); mix(b.min.y); mix(b.max.x); mix(b.max.y);
+    };
+    mixBox(map.worldBounds());
+    for (const auto& o : map.obstacles()) mixBox(o);
+    return std::make_shared<std::uint64_t>(h);
+  });
+}
+
+std::size_t layoutSize(std::size_t cells, std::size_t freeCount, std::size_t spanCount) {
+  return sizeof(PvsHeader)
+       + cells * sizeof(std::int32_t)
+       + freeCount * sizeof(std::uint32_t)
+       + (freeCount + 1) * sizeof(std::uint32_t)
+       + spanCount * sizeof(VisibilityMatrix::Span);
+}
+
+template <typename T>
+void append(std::vector<unsigned char>& buf, const T* src, std::size_t count) {
+  const auto* bytes = reinterpret_cast<const unsigned char*>(src);
+  buf.insert(buf.end(), bytes, bytes + count * sizeof(T));
+}
+
+} // anonymous namespace
+
+VisibilityMatrix::VisibilityMatrix(std::shared_ptr<const void> storage,
+                                   const unsigned char* data,
+                                   std::size_t size)
+  : storage_(std::move(storage)), data_(data), size_(size) {}
+
+bool VisibilityMatrix::bind() {
+  if (size_ < sizeof(PvsHeader)) return false;
+
+  header_ = reinterpret_cast<const PvsHeader*>(data_);
+  if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0) return false;
+
+  if (!std::isfinite(header_->cellSize) || header_->cellSize <= 0.0) return false;
+
+  // Guard the product before layoutSize: every cell takes four bytes.
+  const std::size_t cells = static_cast<std::size_t>(header_->cols) * header_->rows;
+  if (header_->cols != 0 && cells / header_->cols != header_->rows) return false;
+  if (cells > size_ / sizeof(std::int32_t)) return false;
+  if (layoutSize(cells, header_->freeCount, header_->spanCount) != size_) return false;
+
+  const unsigned char* p = data_ + sizeof(PvsHeader);
+  cellToFree_ = reinterpret_cast<const std::int32_t*>(p);
+  p += cells * sizeof(std::int32_t);
+  freeToCell_ = reinterpret_cast<const std::uint32_t*>(p);
+  p += header_->freeCount * sizeof(std::uint32_t);
+  rowOffsets_ = reinterpret_cast<const std::uint32_t*>(p);
+  p += (header_->freeCount + 1) * sizeof(std::uint32_t);
+  spans_ = reinterpret_cast<const Span*>(p);
+  return validate(cells);
+}
+
+bool VisibilityMatrix::validate(std::size_t cells) const {
+  // One pass over each table, so a corrupt or truncated file is refused here
+  // instead of sending a later lookup out of bounds.
+  const std::uint32_t freeCount = header_->freeCount;
+  for (std::size_t c = 0; c < cells; ++c) {
+    const std::int32_t f = cellToFree_[c];
+    if (f == -1) continue;
+    if (f < 0 || static_cast<std::uint32_t>(f) >= freeCount) return false;
+    if (freeToCell_[f] != c) return false;
+  }
+  for (std::uint32_t i = 0; i < freeCount; ++i) {
+    const std::uint32_t c = freeToCell_[i];
+    if (c >= cells || cellToFree_[c] != static_cast<std::int32_t>(i)) return false;
+  }
+
+  if (rowOffsets_[0] != 0 || rowOffsets_[freeCount] != header_->spanCount) return false;
+  for (std::uint32_t i = 0; i < freeCount; ++i) {
+    const std::uint32_t first = rowOffsets_[i];
+    const std::uint32_t last = rowOffsets_[i + 1];
+    if (last < first) return false;
+
+    // Spans in a row are non-empty, sorted and disjoint (visible() bisects them).
+    std::uint64_t end = 0;
+    for (std::uint32_t k = first; k < last; ++k) {
+      const Span& s = spans_[k];
+      const std::uint64_t stop = static_cast<std::uint64_t>(s.start) + s.length;
+      if (s.length == 0 || s.start < end || stop > freeCount) return false;
+      end = stop;
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<const VisibilityMatrix> VisibilityMatrix::build(const Map& map,
+                                                                double cellSize,
+                                                                double agentRadius) {
+  const AABB& world = map.worldBounds();
+  const int cols = std::max(1, static_cast<int>(std::floor((world.max.x - world.min.x) / cellSize)));
+  const int rows = std::max(1, static_cast<int>(std::floor((world.max.y - world.min.y) / cellSize)));
+
+  PvsHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.originX = world.min.x;
+  header.originY = world.min.y;
+  header.worldMaxX = world.max.x;
+  header.worldMaxY = world.max.y;
+  header.cellSize = cellSize;
+  header.geometryHash = geometryHash(map);
+  header.cols = static_cast<std::uint32_t>(cols);
+  header.rows = static_cast<std::uint32_t>(rows);
+
+  std::vector<std::int32_t> cellToFree(static_cast<std::size_t>(cols) * rows, -1);
+  std::vector<std::uint32_t> freeToCell;
+  std::vector<Vec2> centers;
+
+  for (int iy = 0; iy < rows; ++iy) {
+    for (int ix = 0; ix < cols; ++ix) {
+      const Vec2 c{world.min.x + (ix + 0.5) * cellSize, world.min.y + (iy + 0.5) * cellSize};
+      if (map.collidesCircleAt(c, agentRadius)) continue;
+
+      const std::uint32_t cell = static_cast<std::uint32_t>(iy * cols + ix);
+      cellToFree[cell] = static_cast<std::int32_t>(freeToCell.size());
+      freeToCell.push_back(cell);
+      centers.push_back(c);
+    }
+  }
+
+  const std::size_t n = centers.size();
+  const std::size_t words = (n + 63) / 64;
+
+  // Upper triangle of a dense bit matrix in parallel (rows are disjoint),
+  // then mirror. LoS is symmetric, so each pair is traced once.
+  std::vector<std::uint64_t> bits(n * words, 0);
+  {
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+      pool.emplace_back([&, t] {
+        for (std::size_t i = t; i < n; i += threads) {
+          std::uint64_t* row = &bits[i * words];
+          row[i / 64] |= (1ULL << (i % 64));
+          for (std::size_t j = i + 1; j < n; ++j) {
+            if (map.hasLineOfSight(centers[i], centers[j])) row[j / 64] |= (1ULL << (j % 64));
+          }
+        }
+      });
+    }
+    for (auto& th : pool) th.join();
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = i + 1; j < n; ++j) {
+      if (bits[i * words + j / 64] & (1ULL << (j % 64))) {
+        bits[j * words + i / 64] |= (1ULL << (i % 64));
+      }
+    }
+  }
+
+  // Compress each row into runs of set bits.
+  std::vector<std::uint32_t> rowOffsets;
+  std::vector<Span> spans;
+  rowOffsets.reserve(n + 1);
+  for (std::size_t i = 0; i < n; ++i) {
+    rowOffsets.push_back(static_cast<std::uint32_t>(spans.size()));
+    const std::uint64_t* row = &bits[i * words];
+
+    std::size_t j = 0;
+    while (j < n) {
+      if (!(row[j / 64] & (1ULL << (j % 64)))) { ++j; continue; }
+      const std::size_t start = j;
+      while (j < n && (row[j / 64] & (1ULL << (j % 64)))) ++j;
+      spans.push_back(Span{static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(j - start)});
+    }
+  }
+  rowOffsets.push_back(static_cast<std::uint32_t>(spans.size()));
+
+  header.freeCount = static_cast<std::uint32_t>(n);
+  header.spanCount = static_cast<std::uint32_t>(spans.size());
+
+  auto buf = std::make_shared<std::vector<unsigned char>>();
+  buf->reserve(layoutSize(cellToFree.size(), n, spans.size()));
+  append(*buf, &header, 1);
+  append(*buf, cellToFree.data(), cellToFree.size());
+  append(*buf, freeToCell.data(), freeToCell.size());
+  append(*buf, rowOffsets.data(), rowOffsets.size());
+  append(*buf, spans.data(), spans.size());
+
+  const unsigned char* data = buf->data();
+  const std::size_t size = buf->size();
+  std::shared_ptr<VisibilityMatrix> pvs(new VisibilityMatrix(std::move(buf), data, size));
+  if (!pvs->bind()) return nullptr;
+  return pvs;
+}
+
+std::shared_ptr<const VisibilityMatrix> VisibilityMatrix::load(const std::string& path) {
+#if defined(_WIN32)
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return nullptr;
+  auto buf = std::make_shared<std::vector<unsigned char>>(
+    std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  const unsigned char* data = buf->data();
+  const std::size_t size = buf->size();
+  std::shared_ptr<VisibilityMatrix> pvs(new VisibilityMatrix(std::move(buf), data, size));
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return nullptr;
+  }
+  const std::size_t size = static_cast<std::size_t>(st.st_size);
+  void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) return nullptr;
+
+  std::shared_ptr<const void> mapping(addr, [size](const void* p) {
+    ::munmap(const_cast<void*>(p), size);
+  });
+  const auto* data = static_cast<const unsigned char*>(addr);
+  std::shared_ptr<VisibilityMatrix> pvs(new VisibilityMatrix(std::move(mapping), data, size));
+#endif
+  if (!pvs->bind()) return nullptr;
+  return pvs;
+}
+
+bool VisibilityMatrix::save(const std::string& path) const {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) return false;
+  out.write(reinterpret_cast<const char*>(data_), static_cast<std::streamsize>(size_));
+  return static_cast<bool>(out);
+}
+
+bool VisibilityMatrix::builtFor(const Map& map) const {
+  const AABB& world = map.worldBounds();
+  return header_->originX == world.min.x && header_->originY == world.min.y &&
+         header_->worldMaxX == world.max.x && header_->worldMaxY == world.max.y &&
+         header_->geometryHash == geometryHash(map);
+}
+
+double VisibilityMatrix::cellSize() const { return header_->cellSize; }
+int VisibilityMatrix::cols() const { return static_cast<int>(header_->cols); }
+int VisibilityMatrix::rows() const { return static_cast<int>(header_->rows); }
+int VisibilityMatrix::freeCount() const { return static_cast<int>(header_->freeCount); }
+std::size_t VisibilityMatrix::spanCount() const { return header_->spanCount; }
+
+Vec2 VisibilityMatrix::cellCenter(int freeCell) const {
+  const std::uint32_t cell = freeToCell_[freeCell];
+  const int ix = static_cast<int>(cell % header_->cols);
+  const int iy = static_cast<int>(cell / header_->cols);
+  return Vec2{header_->originX + (ix + 0.5) * header_->cellSize,
+              header_->originY + (iy + 0.5) * header_->cellSize};
+}
+
+int VisibilityMatrix::freeCellAt(const Vec2& p) const {
+  const double h = header_->cellSize;
+  const double fx = (p.x - header_->originX) / h - 0.5;
+  const double fy = (p.y - header_->originY) / h - 0.5;
+  const double rx = std::round(fx);
+  const double ry = std::round(fy);
+
+  // Only exact centres are answered from the table; anything else is off-grid.
+  const double tol = 1e-9;
+  if (std::abs(fx - rx) > tol || std::abs(fy - ry) > tol) return -1;
+  if (rx < 0 || ry < 0 || rx >= header_->cols || ry >= header_->rows) return -1;
+
+  const std::size_t cell = static_cast<std::size_t>(ry) * header_->cols + static_cast<std::size_t>(rx);
+  return cellToFree_[cell];
+}
+
+bool VisibilityMatrix::visible(int fromCell, int toCell) const {
+  const Span* first = spans_ + rowOffsets_[fromCell];
+  const Span* last = spans_ + rowOffsets_[fromCell + 1];
+  const auto target = static_cast<std::uint32_t>(toCell);
+
+  // Last span starting at or before the target
+  const Span* it = std::upper_bound(first, last, target,
+    [](std::uint32_t v, const Span& s) { return v < s.start; });
+  if (it == first) return false;
+  --it;
+  return target < it->start + it->length;
+}
+
+std::vector<std::uint64_t> VisibilityMatrix::rowMask(int fromCell) const {
+  std::vector<std::uint64_t> mask((header_->freeCount + 63) / 64, 0);
+  for (std::uint32_t k = rowOffsets_[fromCell]; k < rowOffsets_[fromCell + 1]; ++k) {
+    const Span& s = spans_[k];
+    for (std::uint32_t j = s.start; j < s.start + s.length; ++j) mask[j / 64] |= (1ULL << (j % 64));
+  }
+  return mask;
+}
+
+int VisibilityMatrix::countVisible(int fromCell, const std::vector<std::uint64_t>& targets) const {
+  int count = 0;
+  for (std::uint32_t k = rowOffsets_[fromCell]; k < rowOffsets_[fromCell + 1]; ++k) {
+    const Span& s = spans_[k];
+    std::uint32_t j = s.start;
+    const std::uint32_t end = s.start + s.length;
+
+    // Word-at-a-time AND + popcount over the span
+    while (j < end) {
+      const std::uint32_t word = j / 64;
+      if (word >= targets.size()) return count;
+      const std::uint32_t lo = j % 64;
+      const std::uint32_t hi = std::min<std::uint32_t>(64, lo + (end - j));
+      const std::uint64_t bitsInSpan = (hi == 64 ? ~0ULL : ((1ULL << hi) - 1)) & ~((1ULL << lo) - 1);
+      count += std::popcount(targets[word] & bitsInSpan);
+      j += hi - lo;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,164 @@
+#include "io/SceneIO.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace SceneIO {
+
+namespace {
+
+json boxToJson(const AABB& b) { return json::array({b.min.x, b.min.y, b.max.x, b.max.y}); }
+
+AABB boxFromJson(const json& j) {
+  if (!j.is_array() || j.size() != 4) {
+    throw json::type_error::create(302, "box must be [minX, minY, maxX, maxY]", &j);
+  }
+  return AABB{Vec2{j[0].get<double>(), j[1].get<double>()},
+              Vec2{j[2].get<double>(), j[3].get<double>()}};
+}
+
+json vecToJson(const Vec2& v) { return json::array({v.x, v.y}); }
+
+Vec2 vecFromJson(const json& j) {
+  if (!j.is_array() || j.size() != 2) {
+    throw json::type_error::create(302, "vector must be [x, y]", &j);
+  }
+  return Vec2{j[0].get<double>(), j[1].get<double>()};
+}
+
+json workToJson(const WorkCounters& w) {
+  return {{"los_queries", w.losQueries}, {"box_tests", w.boxTests}, {"collision_queries", w.collisionQueries}};
+}
+
+json allocToJson(const AllocationCounters& a) {
+  return {{"allocations", a.allocations}, {"bytes", a.bytes}, {"peak_bytes", a.peakBytes}};
+}
+
+} // anonymous namespace
+
+json mapToJson(const Map& map) {
+  json obstacles = json::array();
+  for (const auto& b : map.obstacles()) obstacles.push_back(boxToJson(b));
+  return {{"bounds", boxToJson(map.worldBounds())}, {"obstacles", std::move(obstacles)}};
+}
+
+Map mapFromJson(const json& j) {
+  std::vector<AABB> boxes;
+  if (j.contains("obstacles")) {
+    for (const auto& b : j.at("obstacles")) boxes.push_back(boxFromJson(b));
+  }
+  Map map;
+  if (j.contains("bounds")) map.setWorldBounds(boxFromJson(j.at("bounds")));
+  map.setObstacles(std::move(boxes));
+  return map;
+}
+
+json agentToJson(const Agent& agent) {
+  return {{"pos", vecToJson(agent.pos)}, {"facing", vecToJson(agent.facing)},
+          {"radius", agent.radius}, {"speed", agent.speed}};
+}
+
+Agent agentFromJson(const json& j) {
+  Agent a;
+  a.pos = vecFromJson(j.at("pos"));
+  if (j.contains("facing")) a.facing = vecFromJson(j.at("facing")).normalized();
+  a.radius = j.value("radius", a.radius);
+  a.speed = j.value("speed", a.speed);
+  return a;
+}
+
+json sceneToJson(const Scene& scene) {
+  return {{"map", mapToJson(scene.map)},
+          {"self", agentToJson(scene.self)},
+          {"enemy", agentToJson(scene.enemy)},
+          {"T", scene.T},
+          {"cell_size", scene.cellSize},
+          {"visibility_samples", scene.visibilitySamples},
+          {"fov_degrees", scene.fovDegrees}};
+}
+
+Scene sceneFromJson(const json& j, const Map* fallbackMap) {
+  Scene s;
+  if (j.contains("map")) s.map = mapFromJson(j.at("map"));
+  else if (fallbackMap) s.map = *fallbackMap;
+
+  s.self = agentFromJson(j.at("self"));
+  s.enemy = agentFromJson(j.at("enemy"));
+  s.T = j.value("T", s.T);
+  s.cellSize = j.value("cell_size", s.cellSize);
+  s.visibilitySamples = j.value("visibility_samples", s.visibilitySamples);
+  s.fovDegrees = j.value("fov_degrees", s.fovDegrees);
+  return s;
+}
+
+json resultToJson(const AnalysisResult& r) {
+  json out = {
+    {"area_ratio", r.reachability.areaRatio},
+    {"reachable_self", r.reachability.reachableSelf.size()},
+    {"reachable_enemy", r.reachability.reachableEnemy.size()},
+    {"exposure_width", r.exposure.width},
+    {"los_count", r.exposure.losCount},
+    {"visible_fraction", r.visibility.visibleFraction},
+    {"visible_count", r.visibility.visibleCount},
+    {"sample_count", r.visibility.sampleCount},
+    {"explanations", r.explanations},
+    {"cancelled", r.cancelled},
+  };
+  if (r.stats.enabled) {
+    auto stage = [](const StageStats& st) {
+      return json{{"wall_ms", st.wallMs}, {"work", workToJson(st.work)}, {"alloc", allocToJson(st.alloc)}};
+    };
+    out["stats"] = {{"reachability", stage(r.stats.reachability)},
+                    {"exposure", stage(r.stats.exposure)},
+                    {"visibility", stage(r.stats.visibility)},
+                    {"total_ms", r.stats.totalMs},
+                    {"reachable_cells", r.stats.reachableCells},
+                    {"alloc", allocToJson(r.stats.alloc)}};
+  }
+  return out;
+}
+
+json sketchToJson(const MetricSketch& s) {
+  return {
+    {"count", s.count()},
+    {"mean", s.mean()},
+    {"stddev", s.stddev()},
+    {"min", s.min()},
+    {"max", s.max()},
+    {"p50", s.quantile(0.5)},
+    {"p90", s.quantile(0.9)},
+    {"p99", s.quantile(0.99)},
+  };
+}
+
+json summaryToJson(const ResultSummary& summary) {
+  json out = {
+    {"area_ratio", sketchToJson(summary.areaRatio)},
+    {"exposure_width", sketchToJson(summary.exposureWidth)},
+    {"visible_fraction", sketchToJson(summary.visibleFraction)},
+    {"cancelled", summary.cancelled},
+  };
+  if (summary.totalMs.count() > 0) {
+    out["total_ms"] = sketchToJson(summary.totalMs);
+    out["peak_kb"] = sketchToJson(summary.peakKb);
+    out["allocations"] = summary.allocations;
+    out["allocated_bytes"] = summary.allocatedBytes;
+  }
+  return out;
+}
+
+Scene loadScene(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("cannot open scene file: " + path);
+  return sceneFromJson(json::parse(in));
+}
+
+bool saveScene(const std::string& path, const Scene& scene) {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) return false;
+  out << sceneToJson(scene).dump(2) << "\n";
+  return static_cast<bool>(out);
+}
+
+} // namespace SceneIO
@@ -1,3 +1,99 @@
-int main() {
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "io/SceneIO.hpp"
+#include "server/AnalysisServer.hpp"
+#include "server/BatchRunner.hpp"
+
+namespace {
+
+int usage() {
+  std::cerr << "usage: fps_engine SCENE.json                    analyze one scene, print the result\n"
+               "       fps_engine --serve SOCKET [--threads N]  NDJSON server on a Unix socket\n"
+               "       fps_engine --batch SCENES.ndjson --out RESULTS.ndjson [--map MAP.json]\n"
+               "                  [--procs N] [--pvs CELL_SIZE]  analyze a scene file with N processes\n";
+  return 2;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+  std::string socketPath;
+  std::string scenePath;
+  std::string batchPath;
+  std::string outPath;
+  std::string mapPath;
+  int threads = 0;
+  BatchOptions batch;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+      socketPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+      batchPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      outPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+      mapPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--procs") == 0 && i + 1 < argc) {
+      batch.processes = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--pvs") == 0 && i + 1 < argc) {
+      batch.pvsCellSize = std::atof(argv[++i]);
+    } else if (argv[i][0] != '-' && scenePath.empty()) {
+      scenePath = argv[i];
+    } else {
+      return usage();
+    }
+  }
+
+  if (!socketPath.empty()) {
+    AnalysisServer server(threads);
+    if (!server.serve(socketPath)) {
+      std::cerr << "fps_engine: cannot listen on " << socketPath << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  if (!batchPath.empty()) {
+    if (outPath.empty()) return usage();
+    try {
+      Map map;
+      if (!mapPath.empty()) {
+        std::ifstream in(mapPath);
+        if (!in) throw std::runtime_error("cannot open map file: " + mapPath);
+        map = SceneIO::mapFromJson(SceneIO::json::parse(in));
+      }
+      const BatchReport report = BatchRunner(map, batch).run(batchPath, outPath);
+      if (!report.ok()) throw std::runtime_error(report.error);
+      std::cout << SceneIO::json{{"scenes", report.scenes},
+                                 {"failed", report.failed},
+                                 {"processes", report.processes},
+                                 {"crashed_workers", report.crashedWorkers}}.dump() << "\n";
+      return report.crashedWorkers > 0 ? 1 : 0;
+    } catch (const std::exception& e) {
+      std::cerr << "fps_engine: " << e.what() << "\n";
+      return 1;
+    }
+  }
+
+  if (scenePath.empty()) return usage();
+
+  try {
+    const Scene scene = SceneIO::loadScene(scenePath);
+    SceneAnalyzer analyzer;
+    std::cout << SceneIO::resultToJson(analyzer.analyze(scene)).dump(2) << "\n";
+  } catch (const std::exception& e) {
+    std::cerr << "fps_engine: " << e.what() << "\n";
+    return 1;
+  }
   return 0;
 }
@@ -0,0 +1,309 @@
+#include "server/AnalysisServer.hpp"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "core/VisibilityMatrix.hpp"
+#include "io/SceneIO.hpp"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+AnalysisServer::AnalysisServer(int threads) : pool_(threads) {}
+
+AnalysisServer::~AnalysisServer() = default;
+
+int AnalysisServer::loadedMaps() const {
+  std::shared_lock<std::shared_mutex> lock(mapsMutex_);
+  return static_cast<int>(maps_.size());
+}
+
+std::string AnalysisServer::handle(const std::string& line) {
+  requests_++;
+
+  json reply;
+  try {
+    const json req = json::parse(line);
+    if (!req.is_object()) throw std::invalid_argument("request must be a JSON object");
+    if (req.contains("id")) reply["id"] = req["id"];
+
+    const std::string op = req.value("op", std::string("analyze"));
+
+    if (op == "analyze") {
+      Scene scene;
+      const json& sj = req.at("scene");
+      if (req.contains("map_id")) {
+        const std::string id = req["map_id"].get<std::string>();
+        Map map;
+        {
+          std::shared_lock<std::shared_mutex> lock(mapsMutex_);
+          auto it = maps_.find(id);
+          if (it == maps_.end()) throw std::invalid_argument("unknown map_id: " + id);
+          map = it->second; // shares the snapshot
+        }
+        scene = SceneIO::sceneFromJson(sj, &map);
+      } else {
+        scene = SceneIO::sceneFromJson(sj);
+      }
+
+      SceneAnalyzer analyzer;
+      reply["result"] = SceneIO::resultToJson(analyzer.analyze(scene));
+
+    } else if (op == "load_map") {
+      const std::string id = req.at("map_id").get<std::string>();
+      Map map = SceneIO::mapFromJson(req.at("map"));
+
+      // Build the optional acceleration structures now, once, outside the lock.
+      const double pvsCell = req.value("pvs_cell_size", 0.0);
+      if (pvsCell > 0.0) {
+        map.setVisibilityMatrix(VisibilityMatrix::build(map, pvsCell, req.value("pvs_radius", 0.0)));
+      }
+
+      reply["obstacles"] = map.obstacles().size();
+      reply["pvs"] = static_cast<bool>(map.visibilityMatrix());
+      std::unique_lock<std::shared_mutex> lock(mapsMutex_);
+      maps_[id] = std::move(map);
+
+    } else if (op == "drop_map") {
+      const std::string id = req.at("map_id").get<std::string>();
+      std::unique_lock<std::shared_mutex> lock(mapsMutex_);
+      reply["dropped"] = maps_.erase(id) > 0;
+
+    } else if (op == "stats") {
+      reply["maps"] = loadedMaps();
+      reply["requests"] = requests_.load();
+      reply["threads"] = pool_.size();
+
+    } else if (op == "shutdown") {
+      stop();
+
+    } else {
+      throw std::invalid_argument("unknown op: " + op);
+    }
+    reply["ok"] = true;
+
+  } catch (const std::exception& e) {
+    reply["ok"] = false;
+    reply["error"] = e.what();
+  }
+  return reply.dump();
+}
+
+#if defined(_WIN32)
+
+bool AnalysisServer::serve(const std::string&) {
+  return false; // no AF_UNIX listener on this platform
+}
+
+#else
+
+namespace {
+
+// Top-level "op" of a request line, read with a SAX pass that stops as soon
+// as it is found, so the scene is not parsed twice. "analyze" when absent or
+// when the line is not valid JSON (handle() then reports the error).
+class OpSniffer : public json::json_sax_t {
+public:
+  std::string op = "analyze";
+
+  bool null() override { return value(); }
+  bool boolean(bool) override { return value(); }
+  bool number_integer(json::number_integer_t) override { return value(); }
+  bool number_unsigned(json::number_unsigned_t) override { return value(); }
+  bool number_float(json::number_float_t, const std::string&) override { return value(); }
+  bool binary(json::binary_t&) override { return value(); }
+  bool string(std::string& s) override {
+    if (depth_ == 1 && opKey_) {
+      op = s;
+      return false; // found it; stop parsing
+    }
+    return value();
+  }
+  bool start_object(std::size_t) override { depth_++; opKey_ = false; return true; }
+  bool end_object() override { depth_--; return true; }
+  bool start_array(std::size_t) override { depth_++; opKey_ = false; return true; }
+  bool end_array() override { depth_--; return true; }
+  bool key(std::string& k) override {
+    opKey_ = depth_ == 1 && k == "op";
+    return true;
+  }
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+    return false; // handle() reports it
+  }
+
+private:
+  bool value() { opKey_ = false; return true; }
+
+  int depth_ = 0;
+  bool opKey_ = false;
+};
+
+std::string requestOp(const std::string& line) {
+  OpSniffer sniffer;
+  json::sax_parse(line, &sniffer);
+  return sniffer.op;
+}
+
+// One client socket. Closed when the reader and every in-flight request are
+// done with it.
+struct Connection {
+  explicit Connection(int f) : fd(f) {}
+  ~Connection() { ::close(fd); }
+
+  // Requests of this connection still on the pool.
+  void begin() {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    inFlight++;
+  }
+  void end() {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    if (--inFlight == 0) drained.notify_all();
+  }
+  void waitDrained() {
+    std::unique_lock<std::mutex> lock(orderMutex);
+    drained.wait(lock, [&] { return inFlight == 0; });
+  }
+
+  void send(const std::string& data) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::size_t off = 0;
+    while (off < data.size()) {
+#ifdef MSG_NOSIGNAL
+      const ssize_t n = ::send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+#else
+      const ssize_t n = ::send(fd, data.data() + off, data.size() - off, 0);
+#endif
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return; // client went away; drop the response
+      off += static_cast<std::size_t>(n);
+    }
+  }
+
+  const int fd;
+  std::mutex writeMutex;
+
+  std::mutex orderMutex;
+  std::condition_variable drained;
+  int inFlight = 0;
+};
+
+struct Session {
+  std::shared_ptr<Connection> conn;
+  std::shared_ptr<std::atomic<bool>> done;
+  std::thread reader;
+};
+
+} // anonymous namespace
+
+bool AnalysisServer::serve(const std::string& socketPath) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(addr.sun_path)) return false;
+  std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+  const int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0) return false;
+
+  ::unlink(socketPath.c_str()); // stale socket from an earlier run
+  if (::bind(listenFd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      ::listen(listenFd, 16) != 0) {
+    ::close(listenFd);
+    return false;
+  }
+
+  std::vector<Session> sessions;
+
+  auto reap = [&] {
+    for (auto it = sessions.begin(); it != sessions.end();) {
+      if (*it->done) {
+        it->reader.join();
+        it = sessions.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  };
+
+  while (!stopping_) {
+    pollfd pfd{listenFd, POLLIN, 0};
+    const int ready = ::poll(&pfd, 1, 100); // wake regularly to notice stop()
+    reap();
+    if (ready <= 0) continue;
+
+    const int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0) continue;
+
+    Session s;
+    s.conn = std::make_shared<Connection>(fd);
+    s.done = std::make_shared<std::atomic<bool>>(false);
+    s.reader = std::thread([this, conn = s.conn, done = s.done] {
+      std::string buffer;
+      char chunk[4096];
+      while (true) {
+        const ssize_t n = ::recv(conn->fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        buffer.append(chunk, static_cast<std::size_t>(n));
+
+        // Pipeline every complete line onto the pool right away. Analyze
+        // requests overlap; any other op waits for this connection's earlier
+        // requests and finishes before its later ones start, so a load_map
+        // is in place for the analyze lines sent after it.
+        std::size_t start = 0;
+        for (std::size_t nl; (nl = buffer.find('\n', start)) != std::string::npos; start = nl + 1) {
+          std::string line = buffer.substr(start, nl - start);
+          if (line.empty()) continue;
+          const bool barrier = requestOp(line) != "analyze";
+          if (barrier) conn->waitDrained();
+          conn->begin();
+          pool_.submit([this, conn, line = std::move(line)] {
+            conn->send(handle(line) + "\n");
+            conn->end();
+          });
+          if (barrier) conn->waitDrained();
+        }
+        buffer.erase(0, start);
+
+        // A client that never sends a newline must not grow this without
+        // bound: answer what came before, refuse the line and hang up.
+        if (buffer.size() > kMaxLineBytes) {
+          conn->waitDrained();
+          const json reply = {{"ok", false},
+                              {"error", "request line longer than " + std::to_string(kMaxLineBytes) + " bytes"}};
+          conn->send(reply.dump() + "\n");
+          ::shutdown(conn->fd, SHUT_RDWR);
+          break;
+        }
+      }
+      *done = true;
+    });
+    sessions.push_back(std::move(s));
+  }
+
+  // Stop accepting, stop reading, let every accepted request finish and send
+  // its reply (the shutdown request's own included), and only then close.
+  ::close(listenFd);
+  for (auto& s : sessions) ::shutdown(s.conn->fd, SHUT_RD); // unblocks recv()
+  for (auto& s : sessions) s.reader.join();
+  pool_.waitIdle();
+  sessions.clear();
+  ::unlink(socketPath.c_str());
+  return true;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#include "server/BatchRunner.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "core/VisibilityMatrix.hpp"
+#include "io/SceneIO.hpp"
+
+#if !defined(_WIN32)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+
+bool blank(const std::string& line) {
+  return line.find_first_not_of(" \t\r") == std::string::npos;
+}
+
+std::string partPath(const std::string& outPath, int worker) {
+  return outPath + ".part" + std::to_string(worker);
+}
+
+std::string analyzeLine(const std::string& line, const Map& map) {
+  json reply;
+  try {
+    const json j = json::parse(line);
+    if (!j.is_object()) throw std::invalid_argument("scene must be a JSON object");
+    if (j.contains("id")) reply["id"] = j["id"];
+
+    const Scene scene = SceneIO::sceneFromJson(j, &map);
+    SceneAnalyzer analyzer;
+    reply["result"] = SceneIO::resultToJson(analyzer.analyze(scene));
+    reply["ok"] = true;
+  } catch (const std::exception& e) {
+    reply["ok"] = false;
+    reply["error"] = e.what();
+  }
+  return reply.dump();
+}
+
+// Replies for the `count` scene lines starting at byte `begin`. Each line is
+// flushed as it is written, so a crash keeps the finished ones.
+bool runWorker(const std::string& scenesPath, const std::string& outPath, const Map& map,
+               int worker, std::streamoff begin, int count) {
+  std::ifstream in(scenesPath, std::ios::binary);
+  std::ofstream out(partPath(outPath, worker), std::ios::trunc);
+  if (!in || !out || !in.seekg(begin)) return false;
+
+  std::string line;
+  while (count > 0 && std::getline(in, line)) {
+    if (blank(line)) continue;
+    out << analyzeLine(line, map) << '\n' << std::flush;
+    count--;
+  }
+  out.close();
+  return static_cast<bool>(out);
+}
+
+// Reply for a scene whose worker never wrote one, with the scene's id when
+// its line has one.
+std::string unfinishedLine(std::ifstream& scenes, std::streamoff offset, int worker) {
+  json reply{{"ok", false}, {"error", "worker " + std::to_string(worker) + " did not finish"}};
+  std::string line;
+  scenes.clear();
+  if (scenes.seekg(offset) && std::getline(scenes, line)) {
+    const json j = json::parse(line, nullptr, false);
+    if (j.is_object() && j.contains("id")) reply["id"] = j["id"];
+  }
+  return reply.dump();
+}
+
+} // anonymous namespace
+
+BatchRunner::BatchRunner(Map map, BatchOptions options)
+  : map_(std::move(map)), options_(std::move(options)) {}
+
+BatchReport BatchRunner::run(const std::string& scenesPath, const std::string& outPath) const {
+  BatchReport report;
+
+  // Byte offset of every scene line, so workers can seek to their shard.
+  std::vector<std::streamoff> offsets;
+  {
+    std::ifstream in(scenesPath, std::ios::binary);
+    if (!in) {
+      report.error = "cannot read " + scenesPath;
+      return report;
+    }
+    std::string line;
+    std::streamoff pos = 0;
+    while (std::getline(in, line)) {
+      if (!blank(line)) offsets.push_back(pos);
+      pos += static_cast<std::streamoff>(line.size()) + 1;
+    }
+    report.scenes = static_cast<int>(offsets.size());
+  }
+
+  // Built once here; workers map the saved file instead of rebuilding it.
+  std::string pvsFile = options_.pvsPath;
+  bool ownsPvsFile = false;
+  if (pvsFile.empty() && options_.pvsCellSize > 0.0) {
+    pvsFile = outPath + ".pvs";
+    ownsPvsFile = true;
+    if (!VisibilityMatrix::build(map_, options_.pvsCellSize, options_.pvsRadius)->save(pvsFile)) {
+      report.error = "cannot write " + pvsFile;
+      return report;
+    }
+  }
+  if (!pvsFile.empty()) {
+    const auto pvs = VisibilityMatrix::load(pvsFile);
+    if (!pvs || !pvs->builtFor(map_)) {
+      report.error = pvs ? "visibility matrix " + pvsFile + " was built for a different map"
+                         : "cannot load visibility matrix " + pvsFile;
+      if (ownsPvsFile) std::remove(pvsFile.c_str());
+      return report;
+    }
+  }
+
+  // Each worker attaches the mapped matrix to its own handle on the map.
+  auto workerMap = [&] {
+    Map map = map_;
+    if (!pvsFile.empty()) map.setVisibilityMatrix(VisibilityMatrix::load(pvsFile));
+    return map;
+  };
+
+  int workers = options_.processes > 0
+      ? options_.processes
+      : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  workers = std::max(1, std::min(workers, report.scenes));
+
+  // Worker w takes scenes [first(w), first(w + 1)).
+  auto first = [&](int w) {
+    return static_cast<int>(static_cast<long long>(report.scenes) * w / workers);
+  };
+  auto shardOffset = [&](int w) {
+    return first(w) < report.scenes ? offsets[first(w)] : std::streamoff(0);
+  };
+
+#if defined(_WIN32)
+  workers = 1;
+  report.processes = 0;
+  if (!runWorker(scenesPath, outPath, workerMap(), 0, shardOffset(0), report.scenes)) report.crashedWorkers = 1;
+#else
+  std::cout.flush();
+  std::cerr.flush();
+  std::vector<pid_t> pids;
+  for (int w = 0; w < workers; ++w) {
+    const pid_t pid = fork();
+    if (pid == 0) {
+      bool ok = false;
+      try {
+        ok = runWorker(scenesPath, outPath, workerMap(), w, shardOffset(w), first(w + 1) - first(w));
+      } catch (...) {
+      }
+      _exit(ok ? 0 : 1);
+    }
+    pids.push_back(pid); // -1 when fork failed; that worker's scenes are reported missing
+  }
+  report.processes = static_cast<int>(std::count_if(pids.begin(), pids.end(),
+                                                    [](pid_t p) { return p > 0; }));
+  for (pid_t pid : pids) {
+    int status = 0;
+    if (pid <= 0 || waitpid(pid, &status, 0) != pid ||
+        !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      report.crashedWorkers++;
+    }
+  }
+#endif
+
+  // Concatenate the parts in worker order, which is input order.
+  std::ifstream scenes(scenesPath, std::ios::binary);
+  std::ofstream out(outPath, std::ios::trunc);
+  if (!out) report.error = "cannot write " + outPath;
+
+  for (int w = 0; w < workers && out; ++w) {
+    std::ifstream part(partPath(outPath, w));
+    bool exhausted = false;
+    for (int i = first(w); i < first(w + 1) && out; ++i) {
+      std::string line;
+      bool ok = false;
+      if (!exhausted && std::getline(part, line)) {
+        // A crash mid-write can leave a truncated last line.
+        const json reply = json::parse(line, nullptr, false);
+        ok = reply.is_object() && reply.contains("ok");
+        if (ok && !reply["ok"].get<bool>()) report.failed++;
+      }
+      if (!ok) {
+        exhausted = true;
+        line = unfinishedLine(scenes, offsets[i], w);
+        report.failed++;
+      }
+      out << line << '\n';
+    }
+  }
+
+  for (int w = 0; w < workers; ++w) std::remove(partPath(outPath, w).c_str());
+  if (ownsPvsFile) std::remove(pvsFile.c_str());
+  return report;
+}
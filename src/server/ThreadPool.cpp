@@ -0,0 +1,54 @@
+#include "server/ThreadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(int threads) {
+  const int n = (threads > 0) ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  workers_.reserve(n);
+  for (int i = 0; i < n; ++i) workers_.emplace_back([this] { run(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& t : workers_) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return tasks_.empty() && running_ == 0; });
+}
+
+void ThreadPool::run() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) return; // stop_ and drained
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      running_++;
+    }
+
+    task();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_--;
+    }
+    idle_.notify_all();
+  }
+}
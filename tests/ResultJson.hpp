@@ -0,0 +1,10 @@
+#pragma once
+#include <nlohmann/json.hpp>
+
+// Result JSON minus its "stats" block, for comparing two analyses of the same
+// scene: stage timings (and, with ENGINE_STATS, allocation peaks) differ
+// from run to run.
+inline nlohmann::json metrics(nlohmann::json result) {
+  result.erase("stats");
+  return result;
+}
@@ -0,0 +1,143 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+
+#include "analysis/AcquisitionAnalyzer.hpp"
+#include "analysis/ExposureAnalyzer.hpp"
+#include "analysis/ReachabilityAnalyzer.hpp"
+#include "geom/AABB.hpp"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+Scene wallScene() {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  scene.map.addObstacle(AABB{Vec2{9,4}, Vec2{10,8}});
+  scene.self.pos = Vec2{6,7};
+  scene.self.facing = Vec2{1,0.4};
+  scene.enemy.pos = Vec2{12,7};
+  scene.enemy.speed = 8.0;
+  scene.T = 0.5;
+  return scene;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Acquisition field matches atan2 angles to visible points", "[acquisition]") {
+  const Scene scene = wallScene();
+  const auto reach = ReachabilityAnalyzer().analyze(scene).reachableEnemy;
+
+  AcquisitionOptions options;
+  options.turnRateDegPerSec = 540.0;
+  const AcquisitionResult res = AcquisitionAnalyzer().analyze(scene, reach, options);
+  REQUIRE(res.turnTime.size() == reach.size());
+  REQUIRE(res.totalEnemyReachable == static_cast<int>(reach.size()));
+
+  const double rate = 540.0 * M_PI / 180.0;
+  const double facing = std::atan2(scene.self.facing.y, scene.self.facing.x);
+  int visible = 0;
+  double worst = 0.0;
+  for (std::size_t i = 0; i < reach.size(); ++i) {
+    if (!scene.map.hasLineOfSight(scene.self.pos, reach[i])) {
+      REQUIRE(res.turnTime[i] == -1.0);
+      continue;
+    }
+    visible++;
+    const Vec2 d = reach[i] - scene.self.pos;
+    const double angle = std::abs(std::remainder(std::atan2(d.y, d.x) - facing, 2.0 * M_PI));
+    REQUIRE_THAT(res.turnTime[i], WithinAbs(angle / rate, 1e-9));
+    worst = std::max(worst, angle);
+  }
+
+  REQUIRE(visible > 0);
+  REQUIRE(visible < static_cast<int>(reach.size())); // the wall hides some
+  REQUIRE(res.visibleCount == visible);
+  REQUIRE(res.times.count() == static_cast<std::uint64_t>(visible));
+  REQUIRE_THAT(res.worstAngle, WithinAbs(worst, 1e-9));
+  REQUIRE_THAT(res.worstTime, WithinAbs(worst / rate, 1e-9));
+  REQUIRE_THAT(res.times.max(), WithinAbs(res.worstTime, 1e-12));
+
+  const Vec2 d = res.worstPoint - scene.self.pos;
+  REQUIRE_THAT(std::abs(std::remainder(std::atan2(d.y, d.x) - facing, 2.0 * M_PI)), WithinAbs(worst, 1e-9));
+}
+
+TEST_CASE("Acquisition time scales with the turn rate", "[acquisition]") {
+  const Scene scene = wallScene();
+  const auto reach = ReachabilityAnalyzer().analyze(scene).reachableEnemy;
+
+  AcquisitionOptions slow, fast;
+  slow.turnRateDegPerSec = 180.0;
+  fast.turnRateDegPerSec = 720.0;
+  AcquisitionAnalyzer a;
+  const AcquisitionResult rs = a.analyze(scene, reach, slow);
+  const AcquisitionResult rf = a.analyze(scene, reach, fast);
+
+  REQUIRE(rs.worstAngle == rf.worstAngle);
+  REQUIRE_THAT(rs.worstTime, WithinAbs(4.0 * rf.worstTime, 1e-12));
+  REQUIRE_THAT(rs.times.mean(), WithinAbs(4.0 * rf.times.mean(), 1e-12));
+
+  // Facing straight at a lone visible point needs no turn.
+  Scene facing = scene;
+  facing.self.facing = Vec2{1, 0};
+  const AcquisitionResult r0 = a.analyze(facing, {Vec2{8, 7}});
+  REQUIRE(r0.visibleCount == 1);
+  REQUIRE(r0.worstTime == 0.0);
+
+  REQUIRE(a.analyze(scene, {}).visibleCount == 0);
+}
+
+TEST_CASE("Acquisition reuses the exposure pass's LoS mask", "[acquisition]") {
+  Scene scene = wallScene();
+  scene.fovDegrees = 90.0; // the mask must still cover points behind self
+  const auto reach = ReachabilityAnalyzer().analyze(scene).reachableEnemy;
+
+  ExposureAnalyzer exposure;
+  std::vector<unsigned char> mask;
+  const ExposureResult withMask = exposure.analyze(scene, reach, nullptr, &mask);
+  const ExposureResult plain = exposure.analyze(scene, reach);
+  REQUIRE(withMask.losCount == plain.losCount);
+  REQUIRE(withMask.width == plain.width);
+  REQUIRE(mask.size() == reach.size());
+
+  int masked = 0;
+  for (std::size_t i = 0; i < reach.size(); ++i) {
+    REQUIRE(mask[i] == (scene.map.hasLineOfSight(scene.self.pos, reach[i]) ? 1 : 0));
+    masked += mask[i];
+  }
+  REQUIRE(masked > plain.losCount); // some visible points fall outside the FOV
+
+  AcquisitionAnalyzer a;
+  const AcquisitionResult own = a.analyze(scene, reach);
+  const AcquisitionResult reused = a.analyze(scene, reach, {}, nullptr, &mask);
+  REQUIRE(reused.visibleCount == masked);
+  REQUIRE(reused.turnTime == own.turnTime);
+  REQUIRE(reused.worstTime == own.worstTime);
+
+  const std::vector<unsigned char> wrongSize(3, 1);
+  REQUIRE(a.analyze(scene, reach, {}, nullptr, &wrongSize).turnTime == own.turnTime);
+}
+
+TEST_CASE("A mask from a cancelled exposure run is not reused", "[acquisition]") {
+  const Scene scene = wallScene();
+  const auto reach = ReachabilityAnalyzer().analyze(scene).reachableEnemy;
+
+  CancellationToken cancelled;
+  cancelled.cancel();
+  std::vector<unsigned char> mask(reach.size(), 1); // stale contents from an earlier run
+  REQUIRE(ExposureAnalyzer().analyze(scene, reach, &cancelled, &mask).cancelled);
+  REQUIRE(mask.empty());
+
+  AcquisitionAnalyzer a;
+  const AcquisitionResult own = a.analyze(scene, reach);
+  const AcquisitionResult fromMask = a.analyze(scene, reach, {}, nullptr, &mask);
+  REQUIRE(fromMask.visibleCount == own.visibleCount);
+  REQUIRE(fromMask.turnTime == own.turnTime);
+  REQUIRE(fromMask.worstTime == own.worstTime);
+}
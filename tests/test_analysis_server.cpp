@@ -0,0 +1,211 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "io/SceneIO.hpp"
+#include "server/AnalysisServer.hpp"
+
+#include "ResultJson.hpp"
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+
+const char* kMap = R"({"bounds": [0, 0, 10, 10], "obstacles": [[4.5, 0, 5.5, 4], [4.5, 6, 5.5, 10]]})";
+
+std::string analyzeRequest(int id, double selfX, const std::string& mapId = "wall") {
+  json req = {{"id", id}, {"op", "analyze"}, {"map_id", mapId},
+              {"scene", {{"self", {{"pos", {selfX, 5.0}}, {"facing", {1, 0}}}},
+                         {"enemy", {{"pos", {8.0, 5.0}}, {"facing", {-1, 0}}}}}}};
+  return req.dump();
+}
+
+// Minimal blocking client for the NDJSON socket protocol.
+#if !defined(_WIN32)
+class ClientStub {
+public:
+  explicit ClientStub(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    // The server may still be binding; retry briefly.
+    for (int attempt = 0; attempt < 200 && fd_ < 0; ++attempt) {
+      const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+        fd_ = fd;
+      } else {
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+  }
+  ~ClientStub() { if (fd_ >= 0) ::close(fd_); }
+
+  bool connected() const { return fd_ >= 0; }
+
+  void send(const std::string& data) {
+    std::size_t off = 0;
+    while (off < data.size()) {
+      const ssize_t n = ::write(fd_, data.data() + off, data.size() - off);
+      if (n <= 0) return;
+      off += static_cast<std::size_t>(n);
+    }
+  }
+
+  std::string readLine() {
+    while (true) {
+      const auto nl = buffer_.find('\n');
+      if (nl != std::string::npos) {
+        std::string line = buffer_.substr(0, nl);
+        buffer_.erase(0, nl + 1);
+        return line;
+      }
+      char chunk[4096];
+      const ssize_t n = ::read(fd_, chunk, sizeof(chunk));
+      if (n <= 0) return {};
+      buffer_.append(chunk, static_cast<std::size_t>(n));
+    }
+  }
+
+private:
+  int fd_ = -1;
+  std::string buffer_;
+};
+#endif
+
+} // anonymous namespace
+
+TEST_CASE("Server answers requests against warm maps", "[server]") {
+  AnalysisServer server(2);
+
+  auto loaded = json::parse(server.handle(
+    std::string(R"({"id": "a", "op": "load_map", "map_id": "wall", "pvs_cell_size": 0.5, "map": )") + kMap + "}"));
+  REQUIRE(loaded["ok"] == true);
+  REQUIRE(loaded["id"] == "a");
+  REQUIRE(loaded["obstacles"] == 2);
+  REQUIRE(loaded["pvs"] == true);
+  REQUIRE(server.loadedMaps() == 1);
+
+  auto reply = json::parse(server.handle(analyzeRequest(7, 2.0)));
+  REQUIRE(reply["ok"] == true);
+  REQUIRE(reply["id"] == 7);
+
+  // Same numbers as analyzing the scene directly
+  Scene scene = SceneIO::sceneFromJson(json::parse(analyzeRequest(7, 2.0))["scene"]);
+  scene.map = SceneIO::mapFromJson(json::parse(kMap));
+  SceneAnalyzer analyzer;
+  REQUIRE(metrics(reply["result"]) == metrics(SceneIO::resultToJson(analyzer.analyze(scene))));
+
+  auto stats = json::parse(server.handle(R"({"id": 8, "op": "stats"})"));
+  REQUIRE(stats["maps"] == 1);
+  REQUIRE(stats["requests"] == 3);
+}
+
+TEST_CASE("Server reports bad requests without failing", "[server]") {
+  AnalysisServer server(1);
+
+  auto bad = json::parse(server.handle("{not json"));
+  REQUIRE(bad["ok"] == false);
+  REQUIRE_FALSE(bad.contains("id"));
+
+  auto unknownMap = json::parse(server.handle(analyzeRequest(3, 2.0)));
+  REQUIRE(unknownMap["ok"] == false);
+  REQUIRE(unknownMap["id"] == 3);
+  REQUIRE(unknownMap["error"].get<std::string>().find("wall") != std::string::npos);
+
+  auto unknownOp = json::parse(server.handle(R"({"id": 4, "op": "frobnicate"})"));
+  REQUIRE(unknownOp["ok"] == false);
+
+  auto dropped = json::parse(server.handle(R"({"id": 5, "op": "drop_map", "map_id": "wall"})"));
+  REQUIRE(dropped["ok"] == true);
+  REQUIRE(dropped["dropped"] == false);
+}
+
+#if !defined(_WIN32)
+TEST_CASE("Pipelined requests over the Unix socket", "[server]") {
+  const auto path = (std::filesystem::temp_directory_path() / "fps_engine_test.sock").string();
+  AnalysisServer server(4);
+  bool served = false;
+  std::thread serving([&] { served = server.serve(path); });
+
+  {
+    ClientStub client(path);
+    REQUIRE(client.connected());
+
+    // Load, then send a burst without waiting for replies
+    client.send(std::string(R"({"id": 0, "op": "load_map", "map_id": "wall", "map": )") + kMap + "}\n");
+    REQUIRE(json::parse(client.readLine())["ok"] == true);
+
+    std::string burst;
+    for (int id = 1; id <= 16; ++id) burst += analyzeRequest(id, 1.0 + 0.2 * id) + "\n";
+    client.send(burst);
+
+    std::set<int> ids;
+    for (int i = 0; i < 16; ++i) {
+      auto reply = json::parse(client.readLine());
+      REQUIRE(reply["ok"] == true);
+      ids.insert(reply["id"].get<int>());
+    }
+    REQUIRE(ids.size() == 16);
+    REQUIRE(*ids.begin() == 1);
+    REQUIRE(*ids.rbegin() == 16);
+
+    // Map changes keep their place among a connection's requests: the
+    // analyze after load_map sees the map, the one after drop_map does not.
+    client.send(std::string(R"({"id": 20, "op": "load_map", "map_id": "late", "map": )") + kMap + "}\n" +
+                analyzeRequest(21, 2.0, "late") + "\n" +
+                R"({"id": 22, "op": "drop_map", "map_id": "late"})" + "\n" +
+                analyzeRequest(23, 2.0, "late") + "\n");
+    for (int id = 20; id <= 23; ++id) {
+      auto reply = json::parse(client.readLine());
+      REQUIRE(reply["id"] == id);
+      REQUIRE(reply["ok"] == (id != 23));
+    }
+
+    client.send("{\"id\": 99, \"op\": \"shutdown\"}\n");
+    REQUIRE(json::parse(client.readLine())["id"] == 99);
+  }
+
+  serving.join();
+  REQUIRE(served);
+  REQUIRE_FALSE(std::filesystem::exists(path));
+}
+
+TEST_CASE("Server drops a connection whose line never ends", "[server]") {
+  const auto path = (std::filesystem::temp_directory_path() / "fps_engine_test_long.sock").string();
+  AnalysisServer server(2);
+  std::thread serving([&] { server.serve(path); });
+
+  {
+    ClientStub client(path);
+    REQUIRE(client.connected());
+    client.send(std::string(R"({"id": 1, "op": "stats"})") + "\n" +
+                std::string(AnalysisServer::kMaxLineBytes + 1, 'x'));
+    REQUIRE(json::parse(client.readLine())["id"] == 1); // earlier requests still answered
+
+    const auto refused = json::parse(client.readLine());
+    REQUIRE(refused["ok"] == false);
+    REQUIRE(refused["error"].get<std::string>().find("longer than") != std::string::npos);
+    REQUIRE(client.readLine().empty()); // closed
+  }
+
+  // The server itself keeps going.
+  ClientStub other(path);
+  REQUIRE(other.connected());
+  other.send("{\"id\": 2, \"op\": \"shutdown\"}\n");
+  REQUIRE(json::parse(other.readLine())["id"] == 2);
+  serving.join();
+}
+#endif
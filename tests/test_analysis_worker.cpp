@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "analysis/AnalysisWorker.hpp"
+#include "analysis/SceneAnalyzer.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Scene baseScene() {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  scene.map.addObstacle(AABB{Vec2{4.5, 3.0}, Vec2{5.5, 7.0}});
+  scene.self.pos = Vec2{2,5};
+  scene.self.facing = Vec2{1,0};
+  scene.enemy.pos = Vec2{8,5};
+  scene.enemy.facing = Vec2{-1,0};
+  return scene;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Cancelled token stops SceneAnalyzer early", "[worker]") {
+  Scene scene = baseScene();
+  CancellationToken token;
+  token.cancel();
+
+  SceneAnalyzer analyzer;
+  auto res = analyzer.analyze(scene, &token);
+
+  REQUIRE(res.cancelled);
+  REQUIRE(res.explanations.empty());
+}
+
+TEST_CASE("AnalysisWorker publishes the same result as a direct call", "[worker]") {
+  Scene scene = baseScene();
+  SceneAnalyzer analyzer;
+  const auto expected = analyzer.analyze(scene);
+
+  AnalysisWorker worker;
+  worker.submit(scene);
+  worker.waitIdle();
+
+  auto res = worker.poll();
+  REQUIRE(res.has_value());
+  REQUIRE_FALSE(res->cancelled);
+  REQUIRE(res->reachability.reachableSelf.size() == expected.reachability.reachableSelf.size());
+  REQUIRE(res->exposure.losCount == expected.exposure.losCount);
+  REQUIRE(res->visibility.visibleCount == expected.visibility.visibleCount);
+  REQUIRE(res->explanations == expected.explanations);
+
+  // Nothing new until the next submit
+  REQUIRE_FALSE(worker.poll().has_value());
+  REQUIRE_FALSE(worker.pending());
+}
+
+TEST_CASE("AnalysisWorker only publishes the newest snapshot", "[worker]") {
+  AnalysisWorker worker;
+
+  Scene scene = baseScene();
+  scene.T = 2.0;
+  scene.cellSize = 0.1;
+  for (int i = 0; i < 20; ++i) {
+    scene.self.pos = Vec2{1.0 + 0.1 * i, 5.0};
+    worker.submit(scene);
+  }
+  worker.waitIdle();
+
+  SceneAnalyzer analyzer;
+  const auto expected = analyzer.analyze(scene);
+
+  auto res = worker.poll();
+  REQUIRE(res.has_value());
+  REQUIRE(res->explanations == expected.explanations);
+}
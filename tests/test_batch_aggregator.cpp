@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "analysis/BatchAggregator.hpp"
+
+using Catch::Matchers::WithinAbs;
+using Catch::Matchers::WithinRel;
+
+TEST_CASE("Sketch moments and quantiles track the exact values", "[sketch]") {
+  std::mt19937 rng(3);
+  std::normal_distribution<double> dist(0.5, 0.15);
+  std::vector<double> values(20000);
+  for (auto& v : values) v = dist(rng); // a few fall outside [0, 1)
+
+  MetricSketch sketch(0.0, 1.0, 200);
+  for (double v : values) sketch.add(v);
+
+  double mean = 0.0;
+  for (double v : values) mean += v;
+  mean /= values.size();
+  double var = 0.0;
+  for (double v : values) var += (v - mean) * (v - mean);
+  var /= values.size();
+
+  REQUIRE(sketch.count() == values.size());
+  REQUIRE_THAT(sketch.mean(), WithinRel(mean, 1e-12));
+  REQUIRE_THAT(sketch.variance(), WithinRel(var, 1e-9));
+  REQUIRE(sketch.min() == *std::min_element(values.begin(), values.end()));
+  REQUIRE(sketch.max() == *std::max_element(values.begin(), values.end()));
+
+  std::sort(values.begin(), values.end());
+  for (double q : {0.01, 0.1, 0.5, 0.9, 0.99}) {
+    const double exact = values[static_cast<std::size_t>(q * (values.size() - 1))];
+    REQUIRE_THAT(sketch.quantile(q), WithinAbs(exact, 1.0 / 200 + 1e-3));
+  }
+  REQUIRE(sketch.quantile(0.0) == values.front());
+  REQUIRE(sketch.quantile(1.0) == values.back());
+}
+
+TEST_CASE("Merged sketches equal one sketch over all values", "[sketch]") {
+  MetricSketch a(0.0, 10.0, 64), b(0.0, 10.0, 64), all(0.0, 10.0, 64);
+  for (int i = 0; i < 1000; ++i) {
+    const double v = (i * 37 % 1000) / 100.0;
+    (i % 3 ? a : b).add(v);
+    all.add(v);
+  }
+  REQUIRE(a.merge(b));
+  REQUIRE(a.count() == all.count());
+  REQUIRE_THAT(a.mean(), WithinRel(all.mean(), 1e-12));
+  REQUIRE_THAT(a.variance(), WithinRel(all.variance(), 1e-9));
+  for (double q : {0.25, 0.5, 0.75}) REQUIRE(a.quantile(q) == all.quantile(q));
+
+  REQUIRE_FALSE(a.merge(MetricSketch(0.0, 5.0, 64)));
+  MetricSketch empty(0.0, 10.0, 64);
+  REQUIRE(empty.quantile(0.5) == 0.0);
+  REQUIRE(empty.merge(all));
+  REQUIRE(empty.count() == all.count());
+}
+
+TEST_CASE("Aggregator shards merge per map", "[sketch]") {
+  BatchAggregator agg(4);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; ++t) {
+    workers.emplace_back([&agg, t] {
+      for (int i = 0; i < 2500; ++i) {
+        AnalysisResult r;
+        r.reachability.areaRatio = 1.0 + t;
+        r.exposure.width = 0.01 * i;
+        r.visibility.visibleFraction = (i % 2) ? 1.0 : 0.0;
+        r.cancelled = (i == 0);
+        agg.shard(t).add(r, t % 2 ? "odd" : "even");
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+
+  const ResultSummary total = agg.total();
+  REQUIRE(total.cancelled == 4);
+  REQUIRE(total.areaRatio.count() == 4 * 2499);
+  REQUIRE_THAT(total.areaRatio.mean(), WithinRel(2.5, 1e-12));
+  REQUIRE_THAT(total.visibleFraction.mean(), WithinRel(1250.0 / 2499, 1e-12));
+  REQUIRE(total.totalMs.count() == 0);
+
+  const auto byMap = agg.byMap();
+  REQUIRE(byMap.size() == 2);
+  REQUIRE_THAT(byMap.at("even").areaRatio.mean(), WithinRel(2.0, 1e-12)); // shards 0 and 2
+  REQUIRE_THAT(byMap.at("odd").areaRatio.mean(), WithinRel(3.0, 1e-12));
+  REQUIRE(byMap.at("odd").cancelled == 2);
+}
+
+TEST_CASE("Summaries total the allocations of results with stats", "[sketch]") {
+  ResultSummary a, b;
+  for (int i = 0; i < 10; ++i) {
+    AnalysisResult r;
+    r.stats.enabled = (i % 2 == 0);
+    r.stats.alloc.allocations = 100;
+    r.stats.alloc.bytes = 4096;
+    r.stats.alloc.peakBytes = 2048 * static_cast<std::uint64_t>(i + 1);
+    (i < 5 ? a : b).add(r);
+  }
+  a.merge(b);
+  REQUIRE(a.allocations == 500);
+  REQUIRE(a.allocatedBytes == 5 * 4096);
+  REQUIRE(a.peakKb.count() == 5);
+  REQUIRE_THAT(a.peakKb.max(), WithinAbs(18.0, 1e-12));
+}
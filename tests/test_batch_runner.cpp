@@ -0,0 +1,181 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "core/VisibilityMatrix.hpp"
+#include "io/SceneIO.hpp"
+#include "server/BatchRunner.hpp"
+
+#include "ResultJson.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+Map wallMap() {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  map.addObstacle(AABB{Vec2{4.5,0}, Vec2{5.5,4}});
+  map.addObstacle(AABB{Vec2{4.5,6}, Vec2{5.5,10}});
+  return map;
+}
+
+json sceneLine(int id, double selfX, double selfY) {
+  return {{"id", id},
+          {"self", {{"pos", {selfX, selfY}}, {"facing", {1, 0}}}},
+          {"enemy", {{"pos", {8.0, 5.0}}, {"facing", {-1, 0}}}}};
+}
+
+std::vector<json> readLines(const std::filesystem::path& path) {
+  std::vector<json> out;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) out.push_back(json::parse(line));
+  return out;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Batch runner output matches in-process analysis in input order", "[batch_runner]") {
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto scenesPath = dir / "fps_engine_test_batch.ndjson";
+  const auto outPath = dir / "fps_engine_test_batch.out";
+
+  const Map map = wallMap();
+  std::vector<json> scenes;
+  {
+    std::ofstream f(scenesPath);
+    for (int i = 0; i < 23; ++i) {
+      scenes.push_back(sceneLine(i, 1.0 + 0.15 * i, 2.0 + 0.2 * i));
+      f << scenes.back().dump() << "\n";
+      if (i == 5) f << "\n";                        // blank lines are skipped
+      if (i == 9) f << "{\"self\": not json\n";     // reported, not fatal
+    }
+  }
+
+  BatchOptions options;
+  options.processes = 4;
+  const BatchReport report = BatchRunner(map, options).run(scenesPath.string(), outPath.string());
+  REQUIRE(report.ok());
+  REQUIRE(report.scenes == 24);
+  REQUIRE(report.failed == 1);
+  REQUIRE(report.crashedWorkers == 0);
+#if !defined(_WIN32)
+  REQUIRE(report.processes == 4);
+#endif
+
+  const std::vector<json> lines = readLines(outPath);
+  REQUIRE(lines.size() == 24);
+
+  SceneAnalyzer analyzer;
+  std::size_t next = 0;
+  for (const json& reply : lines) {
+    if (!reply["ok"].get<bool>()) {
+      REQUIRE(reply.contains("error"));
+      REQUIRE(next == 10); // the malformed line followed scene 9
+      continue;
+    }
+    const Scene scene = SceneIO::sceneFromJson(scenes[next], &map);
+    REQUIRE(reply["id"] == scenes[next]["id"]);
+    REQUIRE(metrics(reply["result"]) == metrics(SceneIO::resultToJson(analyzer.analyze(scene))));
+    next++;
+  }
+  REQUIRE(next == scenes.size());
+
+  // Parts are merged and removed.
+  REQUIRE_FALSE(std::filesystem::exists(outPath.string() + ".part0"));
+
+  std::filesystem::remove(scenesPath);
+  std::filesystem::remove(outPath);
+}
+
+TEST_CASE("Batch workers share a mapped visibility matrix", "[batch_runner]") {
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto scenesPath = dir / "fps_engine_test_batch_pvs.ndjson";
+  const auto outPath = dir / "fps_engine_test_batch_pvs.out";
+
+  const Map map = wallMap();
+  {
+    std::ofstream f(scenesPath);
+    for (int i = 0; i < 6; ++i) f << sceneLine(i, 1.0 + 0.5 * i, 5.0).dump() << "\n";
+  }
+
+  Map reference = map;
+  reference.setVisibilityMatrix(VisibilityMatrix::build(map, 0.5));
+
+  BatchOptions options;
+  options.processes = 3;
+  options.pvsCellSize = 0.5;
+  const BatchReport report = BatchRunner(map, options).run(scenesPath.string(), outPath.string());
+  REQUIRE(report.ok());
+  REQUIRE(report.failed == 0);
+  REQUIRE_FALSE(std::filesystem::exists(outPath.string() + ".pvs"));
+
+  SceneAnalyzer analyzer;
+  const std::vector<json> lines = readLines(outPath);
+  REQUIRE(lines.size() == 6);
+  for (int i = 0; i < 6; ++i) {
+    const Scene scene = SceneIO::sceneFromJson(sceneLine(i, 1.0 + 0.5 * i, 5.0), &reference);
+    REQUIRE(metrics(lines[i]["result"]) == metrics(SceneIO::resultToJson(analyzer.analyze(scene))));
+  }
+
+  BatchOptions missing;
+  missing.pvsPath = (dir / "fps_engine_no_such.pvs").string();
+  REQUIRE_FALSE(BatchRunner(map, missing).run(scenesPath.string(), outPath.string()).ok());
+
+  // A matrix saved for another map is refused rather than used.
+  Map otherMap = map;
+  otherMap.addObstacle(AABB{Vec2{1,1}, Vec2{2,2}});
+  BatchOptions foreign;
+  foreign.pvsPath = (dir / "fps_engine_test_batch_foreign.pvs").string();
+  REQUIRE(VisibilityMatrix::build(otherMap, 0.5)->save(foreign.pvsPath));
+  const BatchReport refused = BatchRunner(map, foreign).run(scenesPath.string(), outPath.string());
+  REQUIRE_FALSE(refused.ok());
+  REQUIRE(refused.error.find("different map") != std::string::npos);
+  std::filesystem::remove(foreign.pvsPath);
+
+  std::filesystem::remove(scenesPath);
+  std::filesystem::remove(outPath);
+}
+
+#if !defined(_WIN32)
+TEST_CASE("Batch scenes of a failed worker come back with their ids", "[batch_runner]") {
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto scenesPath = dir / "fps_engine_test_batch_lost.ndjson";
+  const auto outPath = dir / "fps_engine_test_batch_lost.out";
+
+  {
+    std::ofstream f(scenesPath);
+    for (int i = 0; i < 7; ++i) {
+      f << sceneLine(100 + i, 1.0 + 0.5 * i, 5.0).dump() << "\n";
+      if (i == 3) f << "  \n";
+    }
+  }
+  // Worker 1 (scenes 2 and 3 of 0..6) cannot create its part file.
+  std::filesystem::create_directory(outPath.string() + ".part1");
+
+  BatchOptions options;
+  options.processes = 3;
+  const BatchReport report = BatchRunner(wallMap(), options).run(scenesPath.string(), outPath.string());
+  REQUIRE(report.ok());
+  REQUIRE(report.scenes == 7);
+  REQUIRE(report.crashedWorkers == 1);
+  REQUIRE(report.failed == 2);
+
+  const std::vector<json> lines = readLines(outPath);
+  REQUIRE(lines.size() == 7);
+  for (int i = 0; i < 7; ++i) {
+    REQUIRE(lines[i]["id"] == 100 + i);
+    REQUIRE(lines[i]["ok"].get<bool>() == (i != 2 && i != 3));
+  }
+  REQUIRE(lines[2]["error"] == "worker 1 did not finish");
+  REQUIRE_FALSE(std::filesystem::exists(outPath.string() + ".part1"));
+
+  std::filesystem::remove(scenesPath);
+  std::filesystem::remove(outPath);
+}
+#endif
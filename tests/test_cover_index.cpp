@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include "core/CoverIndex.hpp"
+#include "core/Scene.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Map clutterMap() {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{40,40}});
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<double> pos(2.0, 38.0);
+  std::uniform_real_distribution<double> ext(0.5, 3.0);
+  for (int i = 0; i < 40; ++i) {
+    const Vec2 c{pos(rng), pos(rng)};
+    const Vec2 h{ext(rng), ext(rng)};
+    map.addObstacle(AABB{c - h, c + h});
+  }
+  return map;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Cover points hug obstacles without colliding", "[cover]") {
+  const Map map = clutterMap();
+  auto index = CoverIndex::build(map, 0.25, 0.5);
+  REQUIRE(index->points().size() > 100);
+
+  for (const auto& p : index->points()) {
+    REQUIRE_FALSE(map.collidesCircleAt(p.pos, 0.25));
+    // Touching distance to its own box
+    REQUIRE(map.obstacles()[p.obstacle].inflated(0.25 + 1e-3).contains(p.pos));
+  }
+}
+
+TEST_CASE("Indexed nearest-hidden query matches a brute-force scan", "[cover]") {
+  const Map map = clutterMap();
+  auto index = CoverIndex::build(map, 0.25, 0.5);
+
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> coord(0.0, 40.0);
+  for (int q = 0; q < 50; ++q) {
+    const Vec2 from{coord(rng), coord(rng)};
+    const Vec2 view{coord(rng), coord(rng)};
+    const double range = 6.0;
+    const int k = 4;
+
+    std::vector<double> expected;
+    for (const auto& p : index->points()) {
+      const double d = dist(from, p.pos);
+      if (d <= range && !map.hasLineOfSight(view, p.pos)) expected.push_back(d);
+    }
+    std::sort(expected.begin(), expected.end());
+    if (expected.size() > static_cast<size_t>(k)) expected.resize(k);
+
+    const auto got = index->nearestHidden(map, from, view, range, k);
+    REQUIRE(got.size() == expected.size());
+    for (size_t i = 0; i < got.size(); ++i) {
+      REQUIRE(got[i].distance == expected[i]);
+      REQUIRE_FALSE(map.hasLineOfSight(view, got[i].pos));
+    }
+  }
+}
+
+TEST_CASE("Scene query uses the fight window and caches per map", "[cover]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,10}});
+  scene.map.addObstacle(AABB{Vec2{9,2}, Vec2{10,8}});
+  scene.self.pos = Vec2{7.5, 5.0};
+  scene.enemy.pos = Vec2{2.0, 5.0};
+  scene.T = 0.6; // 3 units at speed 5
+
+  auto index = CoverIndex::cached(scene.map, scene.self.radius);
+  REQUIRE(CoverIndex::cached(scene.map, scene.self.radius) == index);
+
+  const auto cover = index->nearestHidden(scene, 3);
+  REQUIRE(cover.size() == 3);
+  for (const auto& c : cover) {
+    REQUIRE(c.pos.x > 10.0); // behind the pillar
+    REQUIRE(c.distance <= 3.0);
+  }
+
+  scene.T = 0.1; // pillar's far side is out of reach
+  REQUIRE(index->nearestHidden(scene, 3).empty());
+}
@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "core/DistanceField.hpp"
+#include "core/Map.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Map testMap() {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  map.addObstacle(AABB{Vec2{4.5, 0.0}, Vec2{5.5, 4.0}});
+  map.addObstacle(AABB{Vec2{4.5, 6.0}, Vec2{5.5, 10.0}});
+  map.addObstacle(AABB{Vec2{1.0, 7.0}, Vec2{3.0, 8.0}});
+  map.addObstacle(AABB{Vec2{7.0, 2.0}, Vec2{7.5, 2.5}});
+  return map;
+}
+
+// Exact unsigned distance to the nearest obstacle (0 when inside one).
+double exactDistance(const Map& map, const Vec2& p) {
+  double best = std::numeric_limits<double>::infinity();
+  for (const auto& b : map.obstacles()) {
+    const double dx = std::max({b.min.x - p.x, 0.0, p.x - b.max.x});
+    const double dy = std::max({b.min.y - p.y, 0.0, p.y - b.max.y});
+    best = std::min(best, std::sqrt(dx * dx + dy * dy));
+  }
+  return best;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Distance field is a tight lower bound on the true distance", "[sdf]") {
+  const Map map = testMap();
+  const double h = 0.1;
+  auto sdf = DistanceField::build(map, h);
+  REQUIRE(sdf->nodesX() == 101);
+  REQUIRE(sdf->nodesY() == 101);
+
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<double> coord(0.0, 10.0);
+  for (int i = 0; i < 5000; ++i) {
+    const Vec2 p{coord(rng), coord(rng)};
+    const double exact = exactDistance(map, p);
+    const double bound = sdf->distance(p);
+
+    REQUIRE(bound <= exact + 1e-6);
+    if (exact > 0.0) REQUIRE(bound >= exact - h * std::sqrt(2.0) - 1e-6);
+  }
+
+  // Deep inside a wall the field is negative
+  REQUIRE(sdf->distance(Vec2{5.0, 2.0}) < 0.0);
+  // Out of bounds is blocked, as in Map
+  REQUIRE(sdf->collidesCircle(Vec2{-1.0, 5.0}, 0.0));
+}
+
+TEST_CASE("Distance field collision never misses an overlap for any radius", "[sdf]") {
+  const Map map = testMap();
+  auto sdf = DistanceField::build(map, 0.1);
+
+  std::mt19937 rng(21);
+  std::uniform_real_distribution<double> coord(0.0, 10.0);
+  const double radii[] = {0.1, 0.25, 0.5, 1.0};
+  for (int i = 0; i < 3000; ++i) {
+    const Vec2 p{coord(rng), coord(rng)};
+    const double exact = exactDistance(map, p);
+    for (double r : radii) {
+      if (exact < r) REQUIRE(sdf->collidesCircle(p, r));
+      // A circle well clear of every box is reported free
+      if (exact > r + 0.15) REQUIRE_FALSE(sdf->collidesCircle(p, r));
+    }
+  }
+}
+
+TEST_CASE("Sphere-traced rays stop at the first obstacle", "[sdf]") {
+  const Map map = testMap();
+  auto sdf = DistanceField::build(map, 0.05);
+
+  // Straight at the wall face at x = 4.5
+  const double hit = sdf->raycast(Vec2{1.0, 2.0}, Vec2{1.0, 0.0}, 8.0);
+  REQUIRE_THAT(hit, Catch::Matchers::WithinAbs(3.5, 0.08));
+  REQUIRE(hit <= 3.5);
+
+  // Through the doorway between the two walls: nothing within range
+  REQUIRE(sdf->raycast(Vec2{1.0, 5.0}, Vec2{1.0, 0.0}, 8.0) == 8.0);
+
+  // Short range ends before the wall
+  REQUIRE(sdf->raycast(Vec2{1.0, 2.0}, Vec2{1.0, 0.0}, 2.0) == 2.0);
+}
@@ -0,0 +1,135 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <random>
+
+#include "analysis/DuelSimulator.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Scene openScene() {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  scene.T = 0.30;
+  scene.cellSize = 0.25;
+  scene.self.pos = Vec2{2,5};
+  scene.self.facing = Vec2{1,0};
+  scene.enemy.pos = Vec2{8,5};
+  scene.enemy.facing = Vec2{-1,0};
+  return scene;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Batched LoS matches scalar hasLineOfSight", "[duel]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  map.addObstacle(AABB{Vec2{4,4}, Vec2{6,6}});
+  map.addObstacle(AABB{Vec2{1,7}, Vec2{3,7.5}});
+
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> coord(-1.0, 11.0);
+  const int n = 512;
+  std::vector<double> ax(n), ay(n), bx(n), by(n);
+  for (int i = 0; i < n; ++i) {
+    ax[i] = coord(rng); ay[i] = coord(rng);
+    // Every fourth segment is axis-parallel to exercise the parallel-slab path
+    bx[i] = (i % 4 == 0) ? ax[i] : coord(rng);
+    by[i] = coord(rng);
+  }
+  std::vector<unsigned char> visible(n);
+  map.hasLineOfSightBatch(ax.data(), ay.data(), bx.data(), by.data(), n, visible.data());
+
+  for (int i = 0; i < n; ++i) {
+    REQUIRE((visible[i] != 0) == map.hasLineOfSight(Vec2{ax[i], ay[i]}, Vec2{bx[i], by[i]}));
+  }
+}
+
+TEST_CASE("Open map duel is symmetric and always makes contact", "[duel]") {
+  DuelOptions opt;
+  opt.rollouts = 20000;
+
+  DuelSimulator sim;
+  auto res = sim.simulate(openScene(), opt);
+
+  REQUIRE(res.rollouts == 20000);
+  REQUIRE(res.selfWins + res.enemyWins + res.trades + res.noContact + res.unresolved == res.rollouts);
+  REQUIRE(res.noContact == 0);
+  REQUIRE(res.unresolved == 0);
+  REQUIRE(res.meanContactTime == 0.0); // visible from the first sub-step
+  REQUIRE_THAT(res.selfWinRate, Catch::Matchers::WithinAbs(res.enemyWinRate, 0.03));
+}
+
+TEST_CASE("Faster reaction wins more duels", "[duel]") {
+  DuelOptions opt;
+  opt.rollouts = 5000;
+  opt.selfReaction = 0.15;
+  opt.enemyReaction = 0.25;
+  opt.reactionJitter = 0.02;
+
+  DuelSimulator sim;
+  auto res = sim.simulate(openScene(), opt);
+  REQUIRE(res.selfWinRate == 1.0);
+}
+
+TEST_CASE("Shots need time and sight when they are fired", "[duel]") {
+  DuelSimulator sim;
+  DuelOptions opt;
+  opt.rollouts = 4000;
+
+  // Both reactions outlast the window.
+  Scene late = openScene();
+  late.T = 0.1;
+  const DuelResult timedOut = sim.simulate(late, opt);
+  REQUIRE(timedOut.noContact == 0);
+  REQUIRE(timedOut.unresolvedRate == 1.0);
+
+  // The enemy starts in a narrow slot and almost any move out of it breaks
+  // sight before either side fires.
+  Scene slot = openScene();
+  slot.T = 1.0;
+  slot.self.speed = 0.0;
+  slot.enemy.speed = 4.0;
+  slot.map.addObstacle(AABB{Vec2{7.0, 0.0}, Vec2{7.5, 4.95}});
+  slot.map.addObstacle(AABB{Vec2{7.0, 5.05}, Vec2{7.5, 10.0}});
+  const DuelResult broken = sim.simulate(slot, opt);
+  REQUIRE(broken.noContact == 0);
+  REQUIRE(broken.unresolvedRate > 0.5);
+  REQUIRE(broken.selfWins + broken.enemyWins + broken.trades + broken.unresolved == broken.rollouts);
+}
+
+TEST_CASE("Solid wall prevents contact", "[duel]") {
+  Scene scene = openScene();
+  scene.map.addObstacle(AABB{Vec2{4.5, 0.0}, Vec2{5.5, 10.0}});
+
+  DuelOptions opt;
+  opt.rollouts = 2000;
+  DuelSimulator sim;
+  REQUIRE(sim.simulate(scene, opt).noContactRate == 1.0);
+}
+
+TEST_CASE("Duel results do not depend on thread count", "[duel]") {
+  Scene scene = openScene();
+  scene.T = 1.0;
+  scene.map.addObstacle(AABB{Vec2{4.5, 3.5}, Vec2{5.5, 6.5}});
+
+  DuelOptions opt;
+  opt.rollouts = 10000;
+  opt.seed = 77;
+
+  DuelSimulator sim;
+  opt.threads = 1;
+  auto a = sim.simulate(scene, opt);
+  opt.threads = 4;
+  auto b = sim.simulate(scene, opt);
+
+  REQUIRE(a.noContact > 0);
+  REQUIRE(a.noContact < a.rollouts);
+  REQUIRE(a.selfWins == b.selfWins);
+  REQUIRE(a.enemyWins == b.enemyWins);
+  REQUIRE(a.trades == b.trades);
+  REQUIRE(a.noContact == b.noContact);
+  REQUIRE(a.unresolved == b.unresolved);
+  REQUIRE(a.meanContactTime == b.meanContactTime);
+}
@@ -0,0 +1,117 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+
+#include "analysis/EnemyBelief.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Agent enemyAgent() {
+  Agent a;
+  a.radius = 0.25;
+  a.speed = 5.0;
+  return a;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Belief spreads no faster than the enemy and conserves mass", "[belief]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  // Self is boxed in, so nothing is ever pruned.
+  map.addObstacle(AABB{Vec2{0.0, 0.0}, Vec2{1.0, 1.0}});
+  const Vec2 self{0.5, 0.5};
+
+  EnemyBelief belief(map, enemyAgent(), 0.5);
+  belief.observe(Vec2{10.2, 10.2});
+  REQUIRE(belief.probabilityAt(Vec2{10.2, 10.2}) == 1.0);
+
+  double travelled = 0.0;
+  for (int t = 0; t < 10; ++t) {
+    auto tick = belief.tick(1.0 / 64.0, self);
+    travelled += 5.0 / 64.0;
+    REQUIRE(tick.prunedMass == 0.0);
+    REQUIRE_THAT(belief.totalMass(), Catch::Matchers::WithinAbs(1.0, 1e-5));
+  }
+
+  // No mass further than the distance the enemy could have covered
+  const Vec2 start = belief.cellCenter(20, 20);
+  for (int iy = 0; iy < belief.rows(); ++iy) {
+    for (int ix = 0; ix < belief.cols(); ++ix) {
+      if (belief.probability(ix, iy) == 0.0) continue;
+      const Vec2 c = belief.cellCenter(ix, iy);
+      REQUIRE(std::abs(c.x - start.x) + std::abs(c.y - start.y) <= travelled + 1e-9);
+    }
+  }
+  // Symmetric spread keeps the mean in place
+  REQUIRE_THAT(belief.mean().x, Catch::Matchers::WithinAbs(start.x, 1e-4));
+}
+
+TEST_CASE("Cells visible from self are pruned", "[belief]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,10}});
+  map.addObstacle(AABB{Vec2{9.0, 0.0}, Vec2{10.0, 7.0}}); // wall with a gap at the top
+  const Vec2 self{2.0, 2.0};
+
+  EnemyBelief belief(map, enemyAgent(), 0.5);
+  auto tick = belief.tick(0.1, self);
+
+  REQUIRE(tick.prunedMass > 0.4); // nearly all of the left half is visible
+  REQUIRE(tick.losChecks > 0);
+  REQUIRE_FALSE(tick.contradiction);
+  REQUIRE_THAT(belief.totalMass(), Catch::Matchers::WithinAbs(1.0, 1e-5));
+
+  for (int iy = 0; iy < belief.rows(); ++iy) {
+    for (int ix = 0; ix < belief.cols(); ++ix) {
+      if (belief.probability(ix, iy) > 0.0) {
+        REQUIRE_FALSE(map.hasLineOfSight(self, belief.cellCenter(ix, iy)));
+      }
+    }
+  }
+  // The enemy must be behind the wall
+  REQUIRE(belief.mean().x > 10.0);
+
+  // Standing still: visibility comes from the cache
+  auto again = belief.tick(0.1, self);
+  REQUIRE(again.losChecks < tick.losChecks);
+}
+
+TEST_CASE("Belief does not leak through walls", "[belief]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  // Sealed room around (5, 5)
+  map.addObstacle(AABB{Vec2{3,3}, Vec2{7,3.5}});
+  map.addObstacle(AABB{Vec2{3,6.5}, Vec2{7,7}});
+  map.addObstacle(AABB{Vec2{3,3}, Vec2{3.5,7}});
+  map.addObstacle(AABB{Vec2{6.5,3}, Vec2{7,7}});
+  const Vec2 self{1.0, 1.0};
+
+  EnemyBelief belief(map, enemyAgent(), 0.25);
+  belief.observe(Vec2{5, 5});
+  for (int t = 0; t < 64; ++t) belief.tick(1.0 / 64.0, self);
+
+  for (int iy = 0; iy < belief.rows(); ++iy) {
+    for (int ix = 0; ix < belief.cols(); ++ix) {
+      const Vec2 c = belief.cellCenter(ix, iy);
+      if (c.x < 3.5 || c.x > 6.5 || c.y < 3.5 || c.y > 6.5) REQUIRE(belief.probability(ix, iy) == 0.0);
+    }
+  }
+  REQUIRE_THAT(belief.totalMass(), Catch::Matchers::WithinAbs(1.0, 1e-5));
+}
+
+TEST_CASE("Seeing every candidate cell resets the belief", "[belief]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  map.addObstacle(AABB{Vec2{5,0}, Vec2{6,9}});
+
+  EnemyBelief belief(map, enemyAgent(), 0.5);
+  belief.observe(Vec2{2, 5}); // on self's side, in plain view
+  auto tick = belief.tick(0.01, Vec2{1, 1});
+
+  REQUIRE(tick.contradiction);
+  REQUIRE(tick.prunedMass == 1.0);
+  REQUIRE(belief.mean().x > 6.0);
+  REQUIRE_THAT(belief.totalMass(), Catch::Matchers::WithinAbs(1.0, 1e-5));
+}
@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "core/AllocationStats.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Scene wallScene() {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  scene.map.addObstacle(AABB{Vec2{4.5, 0.0}, Vec2{5.5, 4.0}});
+  scene.map.addObstacle(AABB{Vec2{4.5, 6.0}, Vec2{5.5, 10.0}});
+  scene.visibilitySamples = 32;
+
+  scene.self.pos = Vec2{2,5};
+  scene.self.facing = Vec2{1,0};
+  scene.enemy.pos = Vec2{8,5};
+  scene.enemy.facing = Vec2{-1,0};
+  return scene;
+}
+
+} // anonymous namespace
+
+TEST_CASE("AnalysisStats reflects the compile-time switch", "[stats]") {
+  const Scene scene = wallScene();
+  SceneAnalyzer analyzer;
+  auto res = analyzer.analyze(scene);
+
+#if FPS_ENGINE_STATS
+  REQUIRE(res.stats.enabled);
+
+  // One LoS query per enemy reachable cell, one per visibility sample
+  REQUIRE(res.stats.exposure.work.losQueries ==
+          static_cast<std::uint64_t>(res.exposure.totalEnemyReachable));
+  REQUIRE(res.stats.visibility.work.losQueries ==
+          static_cast<std::uint64_t>(res.visibility.sampleCount));
+
+  // Reachability only asks collision queries, at least one per reachable cell
+  REQUIRE(res.stats.reachability.work.losQueries == 0);
+  REQUIRE(res.stats.reachability.work.collisionQueries >=
+          static_cast<std::uint64_t>(res.stats.reachableCells));
+  REQUIRE(res.stats.reachableCells == static_cast<int>(
+          res.reachability.reachableSelf.size() + res.reachability.reachableEnemy.size()));
+
+  REQUIRE(res.stats.totalWork().boxTests > 0);
+  REQUIRE(res.stats.totalMs >= res.stats.exposure.wallMs);
+#else
+  REQUIRE_FALSE(res.stats.enabled);
+  REQUIRE(res.stats.totalWork().losQueries == 0);
+  REQUIRE(res.stats.totalMs == 0.0);
+#endif
+}
+
+TEST_CASE("Allocation scopes count the calling thread's heap use", "[stats]") {
+  AllocationScope outer;
+  {
+    AllocationScope inner;
+    std::vector<int> v(1000);
+    const AllocationCounters c = inner.counters();
+#if FPS_ENGINE_STATS
+    REQUIRE(c.allocations >= 1);
+    REQUIRE(c.bytes >= 1000 * sizeof(int));
+    REQUIRE(c.peakBytes >= 1000 * sizeof(int));
+#else
+    REQUIRE(c.allocations == 0);
+    REQUIRE(c.peakBytes == 0);
+#endif
+  }
+  // Freed by now, but the inner peak still counts for the outer scope.
+  const AllocationCounters c = outer.counters();
+#if FPS_ENGINE_STATS
+  REQUIRE(c.peakBytes >= 1000 * sizeof(int));
+#else
+  REQUIRE(c.bytes == 0);
+#endif
+}
+
+TEST_CASE("AnalysisStats reports per-stage allocations", "[stats]") {
+  const Scene scene = wallScene();
+  SceneAnalyzer analyzer;
+  auto res = analyzer.analyze(scene);
+
+#if FPS_ENGINE_STATS
+  // The reachable point lists are still live when the stage ends.
+  const std::uint64_t pointBytes = sizeof(Vec2) *
+      (res.reachability.reachableSelf.size() + res.reachability.reachableEnemy.size());
+  REQUIRE(res.stats.reachability.alloc.allocations >= 2);
+  REQUIRE(res.stats.reachability.alloc.peakBytes >= pointBytes);
+
+  // The whole call also covers the explanation strings.
+  const std::uint64_t stageAllocations = res.stats.reachability.alloc.allocations +
+      res.stats.exposure.alloc.allocations + res.stats.visibility.alloc.allocations;
+  REQUIRE(res.stats.alloc.allocations > stageAllocations);
+  REQUIRE(res.stats.alloc.peakBytes >= res.stats.reachability.alloc.peakBytes);
+  REQUIRE(res.stats.alloc.bytes >= res.stats.alloc.peakBytes);
+#else
+  REQUIRE(res.stats.alloc.allocations == 0);
+  REQUIRE(res.stats.reachability.alloc.bytes == 0);
+#endif
+}
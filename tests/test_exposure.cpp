@@ -1,6 +1,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 #include "analysis/ReachabilityAnalyzer.hpp"
 #include "analysis/ExposureAnalyzer.hpp"
 #include "core/Scene.hpp"
@@ -31,3 +34,103 @@ TEST_CASE("Exposure width ~ diameter in empty map", "[exposure]") {
   // Width should be close to 2 * v*T = 3.0 (grid tolerance).
   REQUIRE_THAT(ex.width, Catch::Matchers::WithinAbs(3.0, 0.75));
 }
+
+TEST_CASE("Field of view limits exposure to points self faces", "[exposure]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  scene.map.addObstacle(AABB{Vec2{9,6}, Vec2{10,8}});
+  scene.self.pos = Vec2{5,7};
+  scene.self.facing = Vec2{1,0.2};
+  scene.enemy.pos = Vec2{12,8};
+  scene.enemy.speed = 8.0;
+
+  ReachabilityAnalyzer r;
+  const auto reach = r.analyze(scene).reachableEnemy;
+  ExposureAnalyzer e;
+  const ExposureResult full = e.analyze(scene, reach);
+
+  Scene wide = scene;
+  wide.fovDegrees = 360.0;
+  const ExposureResult same = e.analyze(wide, reach);
+  REQUIRE(same.losCount == full.losCount);
+  REQUIRE(same.width == full.width);
+
+  // Brute force: visible points within half the FOV of the facing.
+  const Vec2 f = scene.self.facing.normalized();
+  const Vec2 axis = perp(f);
+  for (double fov : {20.0, 45.0, 90.0, 180.0, 300.0}) {
+    Scene s = scene;
+    s.fovDegrees = fov;
+    const ExposureResult ex = e.analyze(s, reach);
+
+    const double half = fov * 3.14159265358979323846 / 360.0;
+    int count = 0;
+    double lo = 1e300, hi = -1e300;
+    for (const auto& p : reach) {
+      const Vec2 d = p - scene.self.pos;
+      if (std::acos(std::clamp(f.dot(d.normalized()), -1.0, 1.0)) > half + 1e-9) continue;
+      if (!scene.map.hasLineOfSight(scene.self.pos, p)) continue;
+      count++;
+      lo = std::min(lo, d.dot(axis));
+      hi = std::max(hi, d.dot(axis));
+    }
+    REQUIRE(ex.losCount == count);
+    REQUIRE(ex.losCount <= full.losCount);
+    REQUIRE(ex.width <= full.width);
+    if (count > 0) REQUIRE_THAT(ex.width, Catch::Matchers::WithinAbs(hi - lo, 1e-9));
+  }
+}
+
+TEST_CASE("Exposure profile matches per-facing analysis at every angle", "[exposure]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  scene.map.addObstacle(AABB{Vec2{9,8}, Vec2{10,14}});
+  scene.map.addObstacle(AABB{Vec2{12,3}, Vec2{13,7}});
+  scene.T = 0.8;
+  scene.cellSize = 0.25;
+  scene.self.pos = Vec2{4,10};
+  scene.enemy.pos = Vec2{14,9};
+  scene.enemy.speed = 5.0;
+
+  ReachabilityAnalyzer r;
+  const auto reach = r.analyze(scene);
+
+  ExposureAnalyzer e;
+  const auto profile = e.profile(scene, reach.reachableEnemy);
+  REQUIRE(profile.losCount > 0);
+  REQUIRE(profile.losCount < profile.totalEnemyReachable);
+  REQUIRE(profile.pieces.size() <= profile.hull.size());
+
+  double lowest = 1e9, highest = 0.0;
+  for (int deg = 0; deg < 360; ++deg) {
+    const double a = deg * 3.14159265358979323846 / 180.0;
+    scene.self.facing = Vec2{std::cos(a), std::sin(a)};
+    const auto ex = e.analyze(scene, reach.reachableEnemy);
+    REQUIRE(ex.losCount == profile.losCount);
+    REQUIRE_THAT(profile.widthAt(a), Catch::Matchers::WithinAbs(ex.width, 1e-9));
+    lowest = std::min(lowest, ex.width);
+    highest = std::max(highest, ex.width);
+  }
+
+  const auto narrow = profile.narrowest();
+  const auto wide = profile.widest();
+  REQUIRE(narrow.width <= lowest + 1e-9);
+  REQUIRE(wide.width >= highest - 1e-9);
+  REQUIRE_THAT(profile.widthAt(narrow.angle), Catch::Matchers::WithinAbs(narrow.width, 1e-9));
+  REQUIRE_THAT(profile.widthAt(wide.angle), Catch::Matchers::WithinAbs(wide.width, 1e-9));
+}
+
+TEST_CASE("Exposure profile of a single visible point is flat", "[exposure]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  scene.self.pos = Vec2{2,2};
+
+  ExposureAnalyzer e;
+  const auto one = e.profile(scene, {Vec2{7,7}});
+  REQUIRE(one.pieces.size() == 1);
+  REQUIRE(one.widthAt(1.0) == 0.0);
+
+  const auto none = e.profile(scene, {});
+  REQUIRE(none.pieces.empty());
+  REQUIRE(none.widest().width == 0.0);
+}
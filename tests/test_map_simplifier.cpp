@@ -0,0 +1,66 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+
+#include "core/Map.hpp"
+#include "core/MapSimplifier.hpp"
+#include "geom/AABB.hpp"
+
+TEST_CASE("Tiled wall and contained crates collapse to one box", "[simplify]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+
+  // 2 rows x 8 tiles of 0.5 units, touching edge to edge
+  for (int row = 0; row < 2; ++row) {
+    for (int i = 0; i < 8; ++i) {
+      map.addObstacle(AABB{Vec2{1.0 + i * 0.5, 4.0 + row * 0.5},
+                           Vec2{1.5 + i * 0.5, 4.5 + row * 0.5}});
+    }
+  }
+  // Crate fully inside the wall
+  map.addObstacle(AABB{Vec2{2.0, 4.2}, Vec2{2.4, 4.6}});
+
+  MapSimplifier simplifier;
+  auto report = simplifier.simplify(map);
+
+  REQUIRE(report.obstaclesBefore == 17);
+  REQUIRE(report.obstaclesAfter == 1);
+  REQUIRE(report.containedRemoved >= 1);
+  REQUIRE(map.obstacles().size() == 1);
+
+  const AABB& b = map.obstacles().front();
+  REQUIRE(b.min.x == 1.0);
+  REQUIRE(b.max.x == 5.0);
+  REQUIRE(b.min.y == 4.0);
+  REQUIRE(b.max.y == 5.0);
+}
+
+TEST_CASE("Simplified map answers LoS and collision identically", "[simplify]") {
+  Map original;
+  original.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+
+  // Grid-aligned tiles so many of them touch or overlap
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> cell(0, 38);
+  std::uniform_int_distribution<int> span(1, 3);
+  for (int i = 0; i < 300; ++i) {
+    const double x = cell(rng) * 0.5;
+    const double y = cell(rng) * 0.5;
+    original.addObstacle(AABB{Vec2{x, y}, Vec2{x + span(rng) * 0.5, y + span(rng) * 0.5}});
+  }
+
+  Map simplified = original;
+  MapSimplifier simplifier;
+  auto report = simplifier.simplify(simplified);
+
+  REQUIRE(report.obstaclesAfter < report.obstaclesBefore);
+  REQUIRE(report.reductionFactor() > 1.0);
+
+  std::uniform_real_distribution<double> coord(0.0, 20.0);
+  for (int i = 0; i < 2000; ++i) {
+    const Vec2 a{coord(rng), coord(rng)};
+    const Vec2 b{coord(rng), coord(rng)};
+    REQUIRE(original.hasLineOfSight(a, b) == simplified.hasLineOfSight(a, b));
+    REQUIRE(original.collidesCircleAt(a, 0.25) == simplified.collidesCircleAt(a, 0.25));
+  }
+}
@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "core/DistanceField.hpp"
+#include "core/Map.hpp"
+#include "core/Scene.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Map testMap() {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  map.addObstacle(AABB{Vec2{4,4}, Vec2{6,6}});
+  map.addObstacle(AABB{Vec2{1,7}, Vec2{3,8}});
+  return map;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Copied scenes share one snapshot until edited", "[map_snapshot]") {
+  Scene a;
+  a.map = testMap();
+  const Scene b = a;
+  Scene c = a;
+
+  REQUIRE(a.map.snapshot() == b.map.snapshot());
+  REQUIRE(&a.map.obstacles() == &b.map.obstacles());
+
+  // Editing one copy leaves the others untouched
+  c.map.addObstacle(AABB{Vec2{8,1}, Vec2{9,2}});
+  REQUIRE(c.map.snapshot() != a.map.snapshot());
+  REQUIRE(c.map.obstacles().size() == 3);
+  REQUIRE(a.map.obstacles().size() == 2);
+  REQUIRE(b.map.obstacles().size() == 2);
+  REQUIRE(a.map.snapshot() == b.map.snapshot());
+
+  c.map.setObstacle(0, AABB{Vec2{0,0}, Vec2{1,1}});
+  c.map.removeObstacle(1);
+  REQUIRE(a.map.obstacles()[0].min.x == 4.0);
+  REQUIRE(c.map.obstacles().size() == 2);
+}
+
+TEST_CASE("A sole owner edits in place", "[map_snapshot]") {
+  Map map = testMap();
+  const MapSnapshot* before = map.snapshot().get();
+  map.setObstacle(0, AABB{Vec2{4,4}, Vec2{5,5}});
+  REQUIRE(map.snapshot().get() == before);
+
+  // A snapshot handed in from outside is never modified
+  auto shared = map.snapshot();
+  Map adopted(shared);
+  adopted.addObstacle(AABB{Vec2{8,8}, Vec2{9,9}});
+  REQUIRE(shared->obstacles().size() == 2);
+  REQUIRE(adopted.obstacles().size() == 3);
+}
+
+TEST_CASE("Derived structures are built once per snapshot", "[map_snapshot]") {
+  Map map = testMap();
+  const Map copy = map;
+
+  auto sdf = DistanceField::cached(map, 0.1);
+  REQUIRE(DistanceField::cached(copy, 0.1) == sdf);
+  REQUIRE(DistanceField::cached(copy, 0.2) != sdf);
+  REQUIRE(map.snapshot()->derivedCount() == 2);
+
+  // The edited copy gets its own, matching its new geometry
+  map.addObstacle(AABB{Vec2{8,1}, Vec2{9,2}});
+  REQUIRE(map.snapshot()->derivedCount() == 0);
+  auto edited = DistanceField::cached(map, 0.1);
+  REQUIRE(edited != sdf);
+  REQUIRE(edited->distance(Vec2{8.5, 1.5}) < 0.0);
+  REQUIRE(sdf->distance(Vec2{8.5, 1.5}) > 0.0);
+  REQUIRE(DistanceField::cached(copy, 0.1) == sdf);
+}
+
+TEST_CASE("Concurrent requests share one build", "[map_snapshot]") {
+  const Map map = testMap();
+  std::atomic<int> builds{0};
+
+  std::vector<std::shared_ptr<const int>> got(8);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t] {
+      const Map local = map; // each thread holds its own handle
+      got[t] = local.derived<int>("answer", [&] {
+        builds++;
+        return std::make_shared<const int>(42);
+      });
+    });
+  }
+  for (auto& th : threads) th.join();
+
+  REQUIRE(builds == 1);
+  for (const auto& p : got) REQUIRE(p == got[0]);
+}
+
+TEST_CASE("Builds may request other keys and do not block unrelated ones", "[map_snapshot]") {
+  const Map map = testMap();
+
+  // Nested request from inside a build
+  auto outer = map.derived<int>("outer", [&] {
+    auto inner = map.derived<int>("inner", [] { return std::make_shared<const int>(1); });
+    return std::make_shared<const int>(*inner + 1);
+  });
+  REQUIRE(*outer == 2);
+  REQUIRE(map.snapshot()->derivedCount() == 2);
+
+  // A slow build for one key leaves another key free
+  std::atomic<bool> release{false};
+  std::atomic<bool> started{false};
+  std::thread slow([&] {
+    map.derived<int>("slow", [&] {
+      started = true;
+      while (!release) std::this_thread::yield();
+      return std::make_shared<const int>(3);
+    });
+  });
+  while (!started) std::this_thread::yield();
+  REQUIRE(*map.derived<int>("fast", [] { return std::make_shared<const int>(4); }) == 4);
+  release = true;
+  slow.join();
+  REQUIRE(*map.derived<int>("slow", [] { return std::make_shared<const int>(0); }) == 3);
+
+  // A failed build is retried by the next request
+  REQUIRE_THROWS(map.derived<int>("flaky", []() -> std::shared_ptr<const int> { throw std::runtime_error("no"); }));
+  REQUIRE(*map.derived<int>("flaky", [] { return std::make_shared<const int>(5); }) == 5);
+}
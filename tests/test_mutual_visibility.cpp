@@ -0,0 +1,93 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include "analysis/MutualVisibilityAnalyzer.hpp"
+#include "analysis/ReachabilityAnalyzer.hpp"
+#include "core/Scene.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Scene clutterScene() {
+  Scene s;
+  s.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{30,30}});
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> pos(3.0, 27.0);
+  std::uniform_real_distribution<double> ext(0.3, 1.5);
+  for (int i = 0; i < 25; ++i) {
+    const Vec2 c{pos(rng), pos(rng)};
+    const Vec2 h{ext(rng), ext(rng)};
+    s.map.addObstacle(AABB{c - h, c + h});
+  }
+  s.self.pos = Vec2{8,15};
+  s.enemy.pos = Vec2{22,15};
+  s.self.speed = s.enemy.speed = 5.0;
+  s.T = 0.8;
+  s.cellSize = 0.4;
+  return s;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Mutual visibility matches the brute-force pair count", "[mutual]") {
+  const Scene scene = clutterScene();
+  const auto reach = ReachabilityAnalyzer().analyze(scene);
+  REQUIRE(reach.reachableSelf.size() > 100);
+  REQUIRE(reach.reachableEnemy.size() > 100);
+
+  std::uint64_t visible = 0;
+  double weighted = 0.0, total = 0.0;
+  const double rs = scene.self.speed * scene.T, re = scene.enemy.speed * scene.T;
+  for (const auto& a : reach.reachableSelf) {
+    const double wa = std::max(0.0, 1.0 - dist(a, scene.self.pos) / rs);
+    for (const auto& b : reach.reachableEnemy) {
+      const double w = wa * std::max(0.0, 1.0 - dist(b, scene.enemy.pos) / re);
+      total += w;
+      if (scene.map.hasLineOfSight(a, b)) {
+        visible++;
+        weighted += w;
+      }
+    }
+  }
+
+  MutualVisibilityAnalyzer mv;
+  MutualVisibilityOptions opt;
+  opt.threads = 1;
+  const auto serial = mv.analyze(scene, reach, opt);
+  REQUIRE(serial.pairs == reach.reachableSelf.size() * reach.reachableEnemy.size());
+  REQUIRE(serial.visiblePairs == visible);
+  REQUIRE(serial.losTests + serial.culledVisible + serial.culledBlocked == serial.pairs);
+  REQUIRE(serial.losTests < serial.pairs);
+  REQUIRE_THAT(serial.fraction, Catch::Matchers::WithinAbs(double(visible) / serial.pairs, 1e-12));
+
+  opt.threads = 4;
+  opt.weightByArrival = true;
+  const auto parallel = mv.analyze(scene, reach, opt);
+  REQUIRE(parallel.visiblePairs == visible);
+  REQUIRE_THAT(parallel.fraction, Catch::Matchers::WithinRel(weighted / total, 1e-9));
+}
+
+TEST_CASE("A full wall settles every pair without exact tests", "[mutual]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  scene.map.addObstacle(AABB{Vec2{9.5,0}, Vec2{10.5,20}});
+  scene.self.pos = Vec2{5,10};
+  scene.enemy.pos = Vec2{15,10};
+  scene.T = 0.6;
+
+  const auto reach = ReachabilityAnalyzer().analyze(scene);
+  const auto blocked = MutualVisibilityAnalyzer().analyze(scene, reach);
+  REQUIRE(blocked.pairs > 0);
+  REQUIRE(blocked.visiblePairs == 0);
+  REQUIRE(blocked.fraction == 0.0);
+  REQUIRE(blocked.culledBlocked == blocked.pairs);
+
+  scene.map.setObstacles({});
+  const auto open = MutualVisibilityAnalyzer().analyze(scene, reach);
+  REQUIRE(open.visiblePairs == open.pairs);
+  REQUIRE(open.fraction == 1.0);
+  REQUIRE(open.losTests == 0);
+}
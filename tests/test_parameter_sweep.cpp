@@ -0,0 +1,95 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "analysis/ParameterSweep.hpp"
+#include "analysis/SceneAnalyzer.hpp"
+#include "geom/AABB.hpp"
+
+TEST_CASE("Sweep cells equal individual SceneAnalyzer runs", "[sweep]") {
+  Scene base;
+  base.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  base.map.addObstacle(AABB{Vec2{8,8}, Vec2{9,10.5}});
+  base.map.addObstacle(AABB{Vec2{12,12}, Vec2{15,13}});
+  base.self.pos = Vec2{5,9};
+  base.self.facing = Vec2{1,0.3};
+  base.enemy.pos = Vec2{14,9};
+
+  SweepAxes axes;
+  axes.T = {0.2, 0.45, 0.7};
+  axes.cellSize = {0.5, 0.3};
+  axes.selfSpeed = {3.0, 5.5};
+  axes.enemySpeed = {4.0, 6.0};
+  axes.visibilitySamples = {16, 48};
+
+  const SweepResult sweep = ParameterSweep().run(base, axes);
+  REQUIRE(sweep.cells.size() == 3 * 2 * 2 * 2 * 2);
+
+  SceneAnalyzer analyzer;
+  int exposed = 0;
+  for (std::size_t a = 0; a < 3; ++a)
+  for (std::size_t b = 0; b < 2; ++b)
+  for (std::size_t c = 0; c < 2; ++c)
+  for (std::size_t d = 0; d < 2; ++d)
+  for (std::size_t e = 0; e < 2; ++e) {
+    Scene s = base;
+    s.T = axes.T[a];
+    s.cellSize = axes.cellSize[b];
+    s.self.speed = axes.selfSpeed[c];
+    s.enemy.speed = axes.enemySpeed[d];
+    s.visibilitySamples = axes.visibilitySamples[e];
+    const AnalysisResult r = analyzer.analyze(s);
+    const SweepCell& cell = sweep.at(a, b, c, d, e);
+
+    REQUIRE(cell.reachableSelf == static_cast<int>(r.reachability.reachableSelf.size()));
+    REQUIRE(cell.reachableEnemy == static_cast<int>(r.reachability.reachableEnemy.size()));
+    REQUIRE(cell.areaRatio == r.reachability.areaRatio);
+    REQUIRE(cell.losCount == r.exposure.losCount);
+    REQUIRE(cell.exposureWidth == r.exposure.width);
+    REQUIRE(cell.visibleFraction == r.visibility.visibleFraction);
+    REQUIRE(cell.visibleCount == r.visibility.visibleCount);
+    if (cell.losCount > 0) exposed++;
+  }
+  REQUIRE(exposed > 0);
+}
+
+TEST_CASE("Sweep applies the field of view as SceneAnalyzer does", "[sweep]") {
+  Scene base;
+  base.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  base.map.addObstacle(AABB{Vec2{8,8}, Vec2{9,10.5}});
+  base.self.pos = Vec2{5,9};
+  base.self.facing = Vec2{1,0.6};
+  base.enemy.pos = Vec2{14,9};
+  base.fovDegrees = 50.0;
+
+  SweepAxes axes;
+  axes.T = {0.3, 0.8};
+  axes.enemySpeed = {4.0, 7.0};
+
+  const SweepResult sweep = ParameterSweep().run(base, axes);
+  SceneAnalyzer analyzer;
+  for (std::size_t a = 0; a < 2; ++a)
+  for (std::size_t d = 0; d < 2; ++d) {
+    Scene s = base;
+    s.T = axes.T[a];
+    s.enemy.speed = axes.enemySpeed[d];
+    const AnalysisResult r = analyzer.analyze(s);
+    const SweepCell& cell = sweep.at(a, 0, 0, d, 0);
+
+    REQUIRE(cell.losCount == r.exposure.losCount);
+    REQUIRE(cell.exposureWidth == r.exposure.width);
+  }
+}
+
+TEST_CASE("Empty axes fall back to the base scene", "[sweep]") {
+  Scene base;
+  base.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  base.self.pos = Vec2{2,2};
+  base.enemy.pos = Vec2{8,8};
+
+  const SweepResult sweep = ParameterSweep().run(base, SweepAxes{});
+  REQUIRE(sweep.cells.size() == 1);
+  REQUIRE(sweep.T == std::vector<double>{base.T});
+
+  const AnalysisResult r = SceneAnalyzer().analyze(base);
+  REQUIRE(sweep.cells[0].areaRatio == r.reachability.areaRatio);
+  REQUIRE(sweep.cells[0].exposureWidth == r.exposure.width);
+}
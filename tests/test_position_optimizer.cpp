@@ -0,0 +1,145 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "analysis/PositionOptimizer.hpp"
+#include "analysis/SceneAnalyzer.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Scene wallScene() {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  scene.map.addObstacle(AABB{Vec2{9.0, 0.0}, Vec2{10.0, 8.0}});
+  scene.map.addObstacle(AABB{Vec2{9.0, 11.0}, Vec2{10.0, 20.0}});
+  scene.map.addObstacle(AABB{Vec2{3.0, 3.0}, Vec2{6.0, 4.0}});
+  scene.map.addObstacle(AABB{Vec2{3.0, 14.0}, Vec2{4.0, 17.0}});
+  scene.T = 0.30;
+  scene.cellSize = 0.5;
+  scene.visibilitySamples = 32;
+
+  scene.self.pos = Vec2{2,2};
+  scene.self.facing = Vec2{1,0};
+  scene.enemy.pos = Vec2{15,10};
+  scene.enemy.facing = Vec2{-1,0};
+  return scene;
+}
+
+// Scores of every candidate via SceneAnalyzer, best first.
+std::vector<double> bruteForce(const Scene& base, const PositionQuery& q, const std::vector<Vec2>& facings) {
+  SceneAnalyzer analyzer;
+  std::vector<double> scores;
+  const AABB& r = base.map.worldBounds();
+  const int nx = static_cast<int>(std::floor((r.max.x - r.min.x) / q.spacing)) + 1;
+  const int ny = static_cast<int>(std::floor((r.max.y - r.min.y) / q.spacing)) + 1;
+  for (int iy = 0; iy < ny; ++iy) {
+    for (int ix = 0; ix < nx; ++ix) {
+      Scene s = base;
+      s.self.pos = Vec2{r.min.x + ix * q.spacing, r.min.y + iy * q.spacing};
+      if (s.map.collidesCircleAt(s.self.pos, s.self.radius)) continue;
+
+      double best = -1e300;
+      for (const auto& f : facings) {
+        s.self.facing = f;
+        auto res = analyzer.analyze(s);
+        best = std::max(best, q.weights.area * res.reachability.areaRatio
+                            + q.weights.exposure * res.exposure.width
+                            + q.weights.visibility * res.visibility.visibleFraction);
+      }
+      scores.push_back(best);
+    }
+  }
+  std::sort(scores.rbegin(), scores.rend());
+  return scores;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Branch and bound returns the brute-force top-k", "[position_optimizer]") {
+  const Scene scene = wallScene();
+
+  PositionQuery q;
+  q.spacing = 0.5;
+  q.topK = 6;
+  q.weights = ScoreWeights{1.0, 0.0, 2.0};
+
+  PositionOptimizer opt;
+  auto res = opt.search(scene, q);
+  const auto expected = bruteForce(scene, q, {scene.self.facing});
+
+  REQUIRE(res.candidates == static_cast<int>(expected.size()));
+  REQUIRE(res.best.size() == 6);
+  for (size_t i = 0; i < res.best.size(); ++i) {
+    REQUIRE(res.best[i].score == expected[i]);
+  }
+  // The wall hides the enemy from most of the left half, which is pruned unscored.
+  REQUIRE(res.evaluated < res.candidates);
+  REQUIRE(res.nodesPruned > 0);
+}
+
+TEST_CASE("Candidate metrics match SceneAnalyzer at the returned position", "[position_optimizer]") {
+  Scene scene = wallScene();
+
+  PositionQuery q;
+  q.spacing = 1.0;
+  q.topK = 3;
+  q.weights = ScoreWeights{0.5, -0.2, 1.0};
+
+  PositionOptimizer opt;
+  auto res = opt.search(scene, q);
+  REQUIRE_FALSE(res.best.empty());
+
+  SceneAnalyzer analyzer;
+  for (const auto& c : res.best) {
+    scene.self.pos = c.pos;
+    auto full = analyzer.analyze(scene);
+    REQUIRE(c.areaRatio == full.reachability.areaRatio);
+    REQUIRE(c.exposureWidth == full.exposure.width);
+    REQUIRE(c.visibleFraction == full.visibility.visibleFraction);
+  }
+}
+
+TEST_CASE("Facing search maximises exposure over sampled facings", "[position_optimizer]") {
+  const Scene scene = wallScene();
+
+  PositionQuery q;
+  q.spacing = 1.0;
+  q.topK = 4;
+  q.facingSamples = 8;
+  q.weights = ScoreWeights{0.0, 1.0, 0.5};
+
+  std::vector<Vec2> facings;
+  for (int i = 0; i < 8; ++i) {
+    const double a = 2.0 * 3.14159265358979323846 * i / 8.0;
+    facings.push_back(Vec2{std::cos(a), std::sin(a)});
+  }
+
+  PositionOptimizer opt;
+  auto res = opt.search(scene, q);
+  const auto expected = bruteForce(scene, q, facings);
+
+  REQUIRE(res.best.size() == 4);
+  for (size_t i = 0; i < res.best.size(); ++i) {
+    REQUIRE(std::abs(res.best[i].score - expected[i]) < 1e-9);
+  }
+}
+
+TEST_CASE("Search respects region and cancellation", "[position_optimizer]") {
+  const Scene scene = wallScene();
+
+  PositionQuery q;
+  q.spacing = 0.5;
+  q.region = AABB{Vec2{11,2}, Vec2{14,6}};
+
+  PositionOptimizer opt;
+  auto res = opt.search(scene, q);
+  REQUIRE(res.candidates == 7 * 9);
+  for (const auto& c : res.best) REQUIRE(q.region.contains(c.pos));
+
+  CancellationToken token;
+  token.cancel();
+  REQUIRE(opt.search(scene, q, &token).cancelled);
+}
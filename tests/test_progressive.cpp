@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+#include "analysis/ProgressiveAnalyzer.hpp"
+#include "analysis/SceneAnalyzer.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Scene baseScene() {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  scene.map.addObstacle(AABB{Vec2{4.5, 3.0}, Vec2{5.5, 7.0}});
+  scene.T = 0.5;
+  scene.cellSize = 0.125;
+  scene.visibilitySamples = 64;
+
+  scene.self.pos = Vec2{2,5};
+  scene.self.facing = Vec2{1,0};
+  scene.enemy.pos = Vec2{8,5};
+  scene.enemy.facing = Vec2{-1,0};
+  return scene;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Progressive analysis refines to the scene resolution", "[progressive]") {
+  const Scene scene = baseScene();
+
+  std::vector<ProgressiveLevel> seen;
+  ProgressiveAnalyzer analyzer;
+  auto out = analyzer.analyze(
+    scene, ProgressiveAnalyzer::Clock::now() + std::chrono::seconds(30), {},
+    [&](const AnalysisResult& res, const ProgressiveLevel& level) {
+      REQUIRE_FALSE(res.cancelled);
+      seen.push_back(level);
+    });
+
+  REQUIRE(out.reachedTarget);
+  REQUIRE(seen.size() >= 2);
+  for (size_t i = 1; i < seen.size(); ++i) {
+    REQUIRE(seen[i].level == seen[i - 1].level + 1);
+    REQUIRE(seen[i].cellSize <= seen[i - 1].cellSize);
+    REQUIRE(seen[i].visibilitySamples >= seen[i - 1].visibilitySamples);
+  }
+  REQUIRE(out.level.cellSize == scene.cellSize);
+  REQUIRE(out.level.visibilitySamples == scene.visibilitySamples);
+
+  // Final level is exactly the full-resolution analysis
+  SceneAnalyzer direct;
+  REQUIRE(out.result.explanations == direct.analyze(scene).explanations);
+}
+
+TEST_CASE("Expired deadline returns no level", "[progressive]") {
+  ProgressiveAnalyzer analyzer;
+  auto out = analyzer.analyze(baseScene(), ProgressiveAnalyzer::Clock::now());
+
+  REQUIRE(out.level.level == -1);
+  REQUIRE_FALSE(out.reachedTarget);
+}
+
+TEST_CASE("Deadline token cancels a running analysis", "[progressive]") {
+  CancellationToken token;
+  token.setDeadline(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+
+  SceneAnalyzer analyzer;
+  REQUIRE(analyzer.analyze(baseScene(), &token).cancelled);
+}
+
+TEST_CASE("Deadline tokens read the clock once per stride and then latch", "[progressive]") {
+  CancellationToken token;
+  REQUIRE_FALSE(token.cancelled());
+  token.setDeadline(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+
+  unsigned polls = 1;
+  while (!token.cancelled()) {
+    polls++;
+    REQUIRE(polls <= CancellationToken::kDeadlineStride);
+  }
+  for (int i = 0; i < 10; ++i) REQUIRE(token.cancelled());
+}
+
+TEST_CASE("A token's first poll reads the clock whatever other tokens polled", "[progressive]") {
+  CancellationToken busy;
+  busy.setDeadline(CancellationToken::Clock::now() + std::chrono::hours(1));
+  for (int i = 0; i < 10; ++i) REQUIRE_FALSE(busy.cancelled()); // mid-stride
+
+  CancellationToken expired;
+  expired.setDeadline(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+  REQUIRE(expired.cancelled());
+
+  // Alternating with another token does not hide the deadline either.
+  CancellationToken later;
+  later.setDeadline(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+  REQUIRE_FALSE(busy.cancelled());
+  REQUIRE(later.cancelled());
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <random>
+
+#include "core/Map.hpp"
+#include "geom/AABB.hpp"
+#include "geom/Raycast.hpp"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+Map clutteredMap(std::mt19937& rng, int boxes) {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{40,40}});
+  std::uniform_real_distribution<double> pos(0.0, 38.0), size(0.3, 2.5);
+  for (int i = 0; i < boxes; ++i) {
+    const Vec2 lo{pos(rng), pos(rng)};
+    map.addObstacle(AABB{lo, Vec2{lo.x + size(rng), lo.y + size(rng)}});
+  }
+  return map;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Raycast stops at the nearest box face", "[raycast]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  map.addObstacle(AABB{Vec2{8,4}, Vec2{9,6}});
+  map.addObstacle(AABB{Vec2{5,4}, Vec2{6,6}});
+
+  const RayHit hit = map.raycast(Vec2{2,5}, Vec2{1,0}, 15.0);
+  REQUIRE(hit.obstacle == 1);
+  REQUIRE_THAT(hit.distance, Catch::Matchers::WithinAbs(3.0, 1e-12));
+  REQUIRE_THAT(hit.point.x, Catch::Matchers::WithinAbs(5.0, 1e-12));
+
+  const RayHit miss = map.raycast(Vec2{2,5}, Vec2{0,1}, 4.0);
+  REQUIRE(miss.obstacle == -1);
+  REQUIRE(miss.distance == 4.0);
+
+  const RayHit inside = map.raycast(Vec2{5.5,5}, Vec2{1,0}, 10.0);
+  REQUIRE(inside.obstacle == 1);
+  REQUIRE(inside.distance == 0.0);
+}
+
+TEST_CASE("Raycast matches a brute-force slab scan", "[raycast]") {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> pos(-2.0, 42.0), ang(-M_PI, M_PI);
+
+  // Few boxes are scanned, many walk the grid; some boxes poke past the
+  // world and some origins start outside it.
+  for (int boxes : {12, 60, 400}) {
+    const Map map = clutteredMap(rng, boxes);
+    for (int i = 0; i < 500; ++i) {
+      const Vec2 o{pos(rng), pos(rng)};
+      const double a = ang(rng);
+      const Vec2 axes[] = {Vec2{1,0}, Vec2{0,1}, Vec2{-1,0}, Vec2{0,-1}};
+      const Vec2 d = i % 10 == 0 ? axes[(i / 10) % 4] : Vec2{std::cos(a), std::sin(a)};
+      const RayHit hit = map.raycast(o, d, 12.0);
+
+      double best = 12.0;
+      int index = -1;
+      for (size_t b = 0; b < map.obstacles().size(); ++b) {
+        const double t = rayIntersectAABB(o, d, map.obstacles()[b]);
+        if (t < best) {
+          best = t;
+          index = static_cast<int>(b);
+        }
+      }
+      REQUIRE(hit.distance == best);
+      REQUIRE(hit.obstacle == index);
+    }
+  }
+}
+
+TEST_CASE("Fan casts equal one raycast per angle", "[raycast]") {
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> pos(0.0, 40.0), ang(-M_PI, M_PI), spread(0.05, 2.0 * M_PI);
+
+  for (int boxes : {20, 80}) {
+    const Map map = clutteredMap(rng, boxes);
+    int hits = 0;
+    for (int i = 0; i < 60; ++i) {
+      const Vec2 o{pos(rng), pos(rng)};
+      const double start = ang(rng);
+      const double end = start + (i % 2 ? spread(rng) : -spread(rng));
+      const int rays = 1 + i % 40;
+      const double range = 3.0 + (i % 5) * 4.0;
+
+      const auto fan = map.fanCast(o, start, end, rays, range);
+      REQUIRE(fan.size() == static_cast<size_t>(rays));
+      for (int r = 0; r < rays; ++r) {
+        const double a = rays == 1 ? start : start + (end - start) * r / (rays - 1);
+        const RayHit one = map.raycast(o, Vec2{std::cos(a), std::sin(a)}, range);
+        REQUIRE(fan[r].distance == one.distance);
+        REQUIRE(fan[r].obstacle == one.obstacle);
+        if (one.obstacle >= 0) hits++;
+      }
+    }
+    REQUIRE(hits > 0);
+  }
+}
@@ -70,3 +70,44 @@ TEST_CASE("Obstacle reduces reachable region", "[reachability]") {
   // Self should lose reachable points due to obstacle inflation by radius.
   REQUIRE(blocked.reachableSelf.size() < baseline.reachableSelf.size());
 }
+
+TEST_CASE("Area ratio estimate converges to the exact ratio", "[reachability]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0, 0}, Vec2{20, 20}});
+  scene.T = 0.6;
+  scene.cellSize = 0.25;
+  scene.self.pos = Vec2{5, 10};
+  scene.self.speed = scene.enemy.speed = 5.0;
+  scene.enemy.pos = Vec2{15, 10};
+  scene.map.addObstacle(AABB{Vec2{5.5, 7}, Vec2{7, 13}}); // eats part of self's disk
+
+  ReachabilityAnalyzer analyzer;
+  const auto exact = analyzer.analyze(scene);
+  REQUIRE(exact.areaRatio < 0.9);
+
+  SamplingTolerance tol;
+  tol.halfWidth = 0.0;
+  const auto full = analyzer.estimateAreaRatio(scene, tol);
+  REQUIRE(full.value == exact.areaRatio);
+  REQUIRE(full.errorBound == 0.0);
+
+  tol.halfWidth = 0.1;
+  const auto loose = analyzer.estimateAreaRatio(scene, tol);
+  REQUIRE(loose.samples < full.samples / 2);
+  REQUIRE(loose.errorBound <= 0.1);
+  REQUIRE(loose.lower <= exact.areaRatio);
+  REQUIRE(loose.upper >= exact.areaRatio);
+}
+
+TEST_CASE("Area ratio estimate is zero when the enemy cannot move", "[reachability]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0, 0}, Vec2{10, 10}});
+  scene.self.pos = Vec2{2, 2};
+  scene.enemy.pos = Vec2{8, 8};
+  scene.map.addObstacle(AABB{Vec2{6, 6}, Vec2{10, 10}});
+
+  ReachabilityAnalyzer analyzer;
+  const auto est = analyzer.estimateAreaRatio(scene, SamplingTolerance{});
+  REQUIRE(est.value == 0.0);
+  REQUIRE(analyzer.analyze(scene).areaRatio == 0.0);
+}
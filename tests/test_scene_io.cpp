@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "io/SceneIO.hpp"
+#include "geom/AABB.hpp"
+
+#include "ResultJson.hpp"
+
+TEST_CASE("Scenes round-trip through JSON", "[scene_io]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{-5,0}, Vec2{15,12}});
+  scene.map.addObstacle(AABB{Vec2{4,4}, Vec2{6,6}});
+  scene.map.addObstacle(AABB{Vec2{1,7}, Vec2{3,8}});
+  scene.T = 0.45;
+  scene.cellSize = 0.25;
+  scene.visibilitySamples = 48;
+  scene.fovDegrees = 110.0;
+  scene.self.pos = Vec2{2,2};
+  scene.self.facing = Vec2{0,1};
+  scene.self.speed = 4.0;
+  scene.enemy.pos = Vec2{8,8};
+  scene.enemy.facing = Vec2{-1,0};
+  scene.enemy.radius = 0.3;
+
+  const auto path = std::filesystem::temp_directory_path() / "fps_engine_test_scene.json";
+  REQUIRE(SceneIO::saveScene(path.string(), scene));
+  const Scene loaded = SceneIO::loadScene(path.string());
+  std::filesystem::remove(path);
+
+  REQUIRE(SceneIO::sceneToJson(loaded) == SceneIO::sceneToJson(scene));
+  REQUIRE(loaded.fovDegrees == 110.0);
+
+  SceneAnalyzer analyzer;
+  REQUIRE(metrics(SceneIO::resultToJson(analyzer.analyze(loaded))) ==
+          metrics(SceneIO::resultToJson(analyzer.analyze(scene))));
+}
+
+TEST_CASE("Scene JSON defaults, fallback map and errors", "[scene_io]") {
+  const auto j = SceneIO::json::parse(R"({
+    "self":  {"pos": [1, 1], "facing": [3, 4]},
+    "enemy": {"pos": [9, 9]}
+  })");
+
+  Map shared;
+  shared.addObstacle(AABB{Vec2{4,4}, Vec2{6,6}});
+  const Scene s = SceneIO::sceneFromJson(j, &shared);
+
+  REQUIRE(s.map.snapshot() == shared.snapshot());
+  REQUIRE(s.T == Scene{}.T);
+  REQUIRE(s.self.facing.x == 0.6);
+  REQUIRE(s.self.facing.y == 0.8);
+
+  REQUIRE_THROWS(SceneIO::sceneFromJson(SceneIO::json::parse(R"({"self": {"pos": [1]}, "enemy": {"pos": [0, 0]}})")));
+  REQUIRE_THROWS(SceneIO::loadScene("/nonexistent/scene.json"));
+}
+
+TEST_CASE("Result summaries serialise each metric sketch", "[scene_io]") {
+  ResultSummary summary;
+  AnalysisResult r;
+  r.reachability.areaRatio = 0.5;
+  r.exposure.width = 2.0;
+  r.visibility.visibleFraction = 0.25;
+  summary.add(r);
+  summary.add(r);
+
+  const auto j = SceneIO::summaryToJson(summary);
+  REQUIRE(j["area_ratio"]["count"] == 2);
+  REQUIRE(j["exposure_width"]["mean"] == 2.0);
+  REQUIRE(j["visible_fraction"]["max"] == 0.25);
+  REQUIRE(j["cancelled"] == 0);
+  REQUIRE_FALSE(j.contains("total_ms"));
+}
@@ -0,0 +1,187 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "core/Map.hpp"
+#include "core/TiledMap.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Map randomMap(int count, double size, unsigned seed) {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{size,size}});
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> pos(0.0, size);
+  std::uniform_real_distribution<double> ext(0.2, 6.0);
+  for (int i = 0; i < count; ++i) {
+    const Vec2 c{pos(rng), pos(rng)};
+    const Vec2 h{ext(rng) * 0.5, ext(rng) * 0.5};
+    map.addObstacle(AABB{c - h, c + h});
+  }
+  // Boxes on tile seams
+  map.addObstacle(AABB{Vec2{16.0, 3.0}, Vec2{17.0, 5.0}});
+  map.addObstacle(AABB{Vec2{30.0, 30.0}, Vec2{34.0, 34.0}});
+  return map;
+}
+
+std::filesystem::path tempPath(const char* name) {
+  return std::filesystem::temp_directory_path() / name;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Tiled map answers queries exactly like the flat map", "[tiled_map]") {
+  const Map map = randomMap(300, 64.0, 5);
+  const auto path = tempPath("fps_engine_test.tiles");
+  REQUIRE(TiledMap::write(path.string(), map, 16.0));
+
+  auto tiled = TiledMap::open(path.string(), 3);
+  REQUIRE(tiled != nullptr);
+  REQUIRE(tiled->tilesX() == 4);
+  REQUIRE(tiled->tilesY() == 4);
+  REQUIRE(tiled->residentTiles() == 0);
+
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> coord(-1.0, 65.0);
+  std::uniform_real_distribution<double> step(-12.0, 12.0);
+  std::uniform_real_distribution<double> radius(0.0, 1.5);
+  for (int i = 0; i < 4000; ++i) {
+    const Vec2 a{coord(rng), coord(rng)};
+    // Mix of long segments and short local ones, plus axis-aligned cases
+    Vec2 b = (i % 2 == 0) ? Vec2{coord(rng), coord(rng)} : a + Vec2{step(rng), step(rng)};
+    if (i % 7 == 0) b.x = a.x;
+    if (i % 11 == 0) b.y = a.y;
+
+    REQUIRE(tiled->hasLineOfSight(a, b) == map.hasLineOfSight(a, b));
+    const double r = radius(rng);
+    REQUIRE(tiled->collidesCircleAt(a, r) == map.collidesCircleAt(a, r));
+  }
+  REQUIRE(tiled->residentTiles() <= 3);
+
+  tiled.reset();
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Tiled map queries agree across threads under eviction", "[tiled_map]") {
+  const Map map = randomMap(300, 64.0, 21);
+  const auto path = tempPath("fps_engine_test_threads.tiles");
+  REQUIRE(TiledMap::write(path.string(), map, 8.0));
+  auto tiled = TiledMap::open(path.string(), 5);
+  REQUIRE(tiled != nullptr);
+
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(100 + t);
+      std::uniform_real_distribution<double> coord(0.0, 64.0);
+      std::uniform_real_distribution<double> step(-6.0, 6.0);
+      for (int i = 0; i < 1500; ++i) {
+        const Vec2 a{coord(rng), coord(rng)};
+        const Vec2 b = a + Vec2{step(rng), step(rng)};
+        if (tiled->hasLineOfSight(a, b) != map.hasLineOfSight(a, b)) mismatches++;
+        if (tiled->collidesCircleAt(b, 0.4) != map.collidesCircleAt(b, 0.4)) mismatches++;
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+
+  REQUIRE(mismatches == 0);
+  REQUIRE(tiled->residentTiles() <= 5);
+  REQUIRE(tiled->tileLoads() > 64); // tiles were evicted and read again
+
+  tiled.reset();
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Local queries load only the tiles they touch", "[tiled_map]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{64,64}});
+  map.addObstacle(AABB{Vec2{40, 40}, Vec2{60, 60}});
+  const auto path = tempPath("fps_engine_test_local.tiles");
+  REQUIRE(TiledMap::write(path.string(), map, 16.0));
+  auto tiled = TiledMap::open(path.string());
+  REQUIRE(tiled != nullptr);
+
+  // Inside one tile
+  tiled->hasLineOfSight(Vec2{2,2}, Vec2{10,12});
+  tiled->collidesCircleAt(Vec2{8,8}, 0.5);
+  REQUIRE(tiled->tileLoads() == 1);
+
+  // Along the bottom row only (nothing blocks it, so every tile is read)
+  REQUIRE(tiled->hasLineOfSight(Vec2{1,1}, Vec2{63,2}));
+  REQUIRE(tiled->tileLoads() == 4);
+  REQUIRE(tiled->residentTiles() == 4);
+
+  tiled.reset();
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Extracted window matches the flat map inside it", "[tiled_map]") {
+  const Map map = randomMap(300, 64.0, 13);
+  const auto path = tempPath("fps_engine_test_extract.tiles");
+  REQUIRE(TiledMap::write(path.string(), map, 16.0));
+  auto tiled = TiledMap::open(path.string(), 2);
+  REQUIRE(tiled != nullptr);
+
+  const AABB area{Vec2{12, 20}, Vec2{30, 36}};
+  const double agentRadius = 0.5;
+  const Map window = tiled->extract(area, agentRadius);
+  REQUIRE(window.worldBounds().min.x == 12.0);
+  REQUIRE(window.worldBounds().max.y == 36.0);
+  REQUIRE(window.obstacles().size() < map.obstacles().size());
+
+  std::mt19937 rng(4);
+  std::uniform_real_distribution<double> x(12.0, 30.0), y(20.0, 36.0);
+  for (int i = 0; i < 2000; ++i) {
+    const Vec2 a{x(rng), y(rng)}, b{x(rng), y(rng)};
+    REQUIRE(window.hasLineOfSight(a, b) == map.hasLineOfSight(a, b));
+    REQUIRE(window.collidesCircleAt(a, agentRadius) == map.collidesCircleAt(a, agentRadius));
+  }
+
+  tiled.reset();
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Malformed tile files are rejected", "[tiled_map]") {
+  const auto path = tempPath("fps_engine_test_bad.tiles");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "not a tile file at all, just some text padding it out";
+  }
+  REQUIRE(TiledMap::open(path.string()) == nullptr);
+  std::filesystem::remove(path);
+  REQUIRE(TiledMap::open(path.string()) == nullptr);
+}
+
+TEST_CASE("Unreadable tiles throw and are read again later", "[tiled_map]") {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{32,32}});
+  map.addObstacle(AABB{Vec2{20, 0}, Vec2{22, 32}}); // wall through the right-hand tiles
+  const auto path = tempPath("fps_engine_test_short.tiles");
+  REQUIRE(TiledMap::write(path.string(), map, 16.0));
+  const auto fullSize = std::filesystem::file_size(path);
+  auto tiled = TiledMap::open(path.string());
+  REQUIRE(tiled != nullptr);
+
+  // Cut into the last tile's records (top right) after open().
+  std::filesystem::resize_file(path, fullSize - 8);
+  const Vec2 a{18, 28}, b{26, 28};
+  REQUIRE_THROWS_AS(tiled->hasLineOfSight(a, b), std::runtime_error);
+  REQUIRE_THROWS_AS(tiled->collidesCircleAt(Vec2{21, 28}, 0.5), std::runtime_error);
+
+  // Same file, whole again: the failed tile was not kept.
+  REQUIRE(TiledMap::write(path.string(), map, 16.0));
+  REQUIRE_FALSE(tiled->hasLineOfSight(a, b));
+  REQUIRE(tiled->collidesCircleAt(Vec2{21, 28}, 0.5));
+
+  tiled.reset();
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "analysis/SceneAnalyzer.hpp"
+#include "core/TraceRecorder.hpp"
+
+namespace {
+
+std::filesystem::path tempPath(const char* name) {
+  return std::filesystem::temp_directory_path() / name;
+}
+
+Scene wallScene() {
+  Scene s;
+  s.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  s.map.addObstacle(AABB{Vec2{9,4}, Vec2{11,16}});
+  s.self.pos = Vec2{4,10};
+  s.enemy.pos = Vec2{16,10};
+  s.self.speed = s.enemy.speed = 4.0;
+  s.T = 0.4;
+  s.cellSize = 0.5;
+  s.visibilitySamples = 16;
+  return s;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Recorder captures calls from several threads", "[trace]") {
+  const auto path = tempPath("fps_engine_test.trace");
+  const Scene scene = wallScene();
+
+  REQUIRE(TraceRecorder::start(path.string()));
+  REQUIRE_FALSE(TraceRecorder::start(path.string()));
+
+  const AnalysisResult analyzed = SceneAnalyzer().analyze(scene);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 3; ++t) {
+    workers.emplace_back([&, t] {
+      for (int i = 0; i < 100; ++i) {
+        const Vec2 to{1.0 + 0.18 * i, 2.0 + 5.0 * t};
+        scene.map.hasLineOfSight(scene.self.pos, to);
+        scene.map.collidesCircleAt(to, 0.5);
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+  REQUIRE(TraceRecorder::stop());
+
+  // Not recording: these must not show up.
+  scene.map.hasLineOfSight(scene.self.pos, scene.enemy.pos);
+
+  TraceFile trace;
+  REQUIRE(trace.load(path.string()));
+  REQUIRE(trace.maps.size() == 1); // one shared snapshot
+  REQUIRE(trace.maps[0].obstacles().size() == 1);
+  REQUIRE(trace.scenes.size() == 1);
+
+  int los = 0, coll = 0, analyze = 0;
+  for (const auto& c : trace.calls) {
+    if (c.kind == TraceCall::LineOfSight) {
+      ++los;
+      REQUIRE(trace.maps[c.map].hasLineOfSight(c.a, c.b) == c.result);
+    } else if (c.kind == TraceCall::Collision) {
+      ++coll;
+      REQUIRE(trace.maps[c.map].collidesCircleAt(c.a, c.radius) == c.result);
+    } else {
+      ++analyze;
+      REQUIRE(c.metrics[0] == analyzed.reachability.areaRatio);
+      REQUIRE(c.metrics[2] == analyzed.visibility.visibleFraction);
+    }
+  }
+  // The analyzer's own LoS and collision queries are folded into its record.
+  REQUIRE(los == 300);
+  REQUIRE(coll == 300);
+  REQUIRE(analyze == 1);
+
+  const AnalysisResult replayed = SceneAnalyzer().analyze(trace.scenes[0]);
+  REQUIRE(replayed.reachability.areaRatio == analyzed.reachability.areaRatio);
+  REQUIRE(replayed.exposure.width == analyzed.exposure.width);
+  REQUIRE(replayed.visibility.visibleFraction == analyzed.visibility.visibleFraction);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Recorder stops while other threads keep calling", "[trace]") {
+  const auto path = tempPath("fps_engine_test_busy.trace");
+  const Scene scene = wallScene();
+  Map other = scene.map;
+  other.addObstacle(AABB{Vec2{2,2}, Vec2{3,3}});
+
+  // Enough calls to fill and hand off several buffers, alternating maps.
+  constexpr int kThreads = 3;
+  constexpr int kCalls = 30000;
+  std::atomic<int> warmedUp{0};
+  std::atomic<bool> done{false};
+
+  REQUIRE(TraceRecorder::start(path.string()));
+  std::vector<std::thread> workers;
+  for (int t = 0; t < kThreads; ++t) {
+    workers.emplace_back([&, t] {
+      for (int i = 0; !done.load(); ++i) {
+        const Map& map = (i & 1) ? other : scene.map;
+        map.hasLineOfSight(Vec2{1.0 + 0.001 * (i % 18000), 2.0 + 5.0 * t}, scene.enemy.pos);
+        if (i + 1 == kCalls) warmedUp.fetch_add(1);
+      }
+    });
+  }
+  while (warmedUp.load() < kThreads) std::this_thread::yield();
+  REQUIRE(TraceRecorder::stop()); // workers are still calling
+  done = true;
+  for (auto& w : workers) w.join();
+
+  TraceFile trace;
+  REQUIRE(trace.load(path.string()));
+  REQUIRE(trace.maps.size() == 2); // each thread's copies merged
+
+  std::vector<std::uint64_t> last(kThreads, 0);
+  std::vector<int> counts(kThreads, 0);
+  for (const auto& c : trace.calls) {
+    REQUIRE(c.kind == TraceCall::LineOfSight);
+    REQUIRE(trace.maps[c.map].hasLineOfSight(c.a, c.b) == c.result);
+    REQUIRE(c.thread < static_cast<std::uint32_t>(kThreads));
+    REQUIRE(c.startNs >= last[c.thread]); // chunks keep each thread's order
+    last[c.thread] = c.startNs;
+    counts[c.thread]++;
+  }
+  for (int n : counts) REQUIRE(n >= kCalls);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Trace loader rejects foreign and truncated files", "[trace]") {
+  const auto path = tempPath("fps_engine_test_bad.trace");
+  TraceFile trace;
+  REQUIRE_FALSE(trace.load(path.string() + ".missing"));
+
+  const Scene scene = wallScene();
+  REQUIRE(TraceRecorder::start(path.string()));
+  scene.map.hasLineOfSight(scene.self.pos, scene.enemy.pos);
+  REQUIRE(TraceRecorder::stop());
+  REQUIRE(trace.load(path.string()));
+  REQUIRE(trace.calls.size() == 1);
+
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+  REQUIRE_FALSE(trace.load(path.string()));
+
+  std::filesystem::remove(path);
+}
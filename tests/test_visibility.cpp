@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
+#include <cmath>
+
 #include "analysis/VisibilityAnalyzer.hpp"
 #include "core/Scene.hpp"
 #include "geom/AABB.hpp"
@@ -38,3 +40,124 @@ TEST_CASE("Obstacle reduces visibility fraction", "[visibility]") {
 
   REQUIRE(res.visibleFraction < 0.25); // should be near 0 because wall blocks all rays
 }
+
+TEST_CASE("Visibility estimate stops early on clear and blocked shots", "[visibility]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  scene.visibilitySamples = 256;
+  scene.self.pos = Vec2{2,5};
+  scene.enemy.pos = Vec2{8,5};
+  scene.enemy.radius = 0.5;
+
+  VisibilityAnalyzer v;
+  SamplingTolerance tol;
+  tol.halfWidth = 0.05;
+
+  auto open = v.estimate(scene, scene.self.pos, scene.enemy, tol);
+  REQUIRE(open.value == 1.0);
+  REQUIRE(open.errorBound <= 0.05);
+  REQUIRE(open.samples < 64);
+  REQUIRE(open.population == 256);
+
+  scene.map.addObstacle(AABB{Vec2{4.5, 0.0}, Vec2{5.5, 10.0}});
+  auto blocked = v.estimate(scene, scene.self.pos, scene.enemy, tol);
+  REQUIRE(blocked.value == 0.0);
+  REQUIRE(blocked.samples < 64);
+}
+
+TEST_CASE("Visibility estimate at zero tolerance matches the exact count", "[visibility]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  scene.visibilitySamples = 60;
+  scene.self.pos = Vec2{2,5};
+  scene.enemy.pos = Vec2{8,5};
+  scene.enemy.radius = 0.5;
+  scene.map.addObstacle(AABB{Vec2{4.5, 5.1}, Vec2{5.5, 10.0}}); // covers part of the target
+
+  VisibilityAnalyzer v;
+  const auto exact = v.analyze(scene, scene.self.pos, scene.enemy);
+  REQUIRE(exact.visibleFraction > 0.2);
+  REQUIRE(exact.visibleFraction < 0.8);
+
+  SamplingTolerance tol;
+  tol.halfWidth = 0.0;
+  const auto full = v.estimate(scene, scene.self.pos, scene.enemy, tol);
+  REQUIRE(full.samples == 60);
+  REQUIRE(full.value == exact.visibleFraction);
+  REQUIRE(full.errorBound == 0.0);
+
+  // A loose tolerance still brackets the exact answer.
+  tol.halfWidth = 0.15;
+  const auto loose = v.estimate(scene, scene.self.pos, scene.enemy, tol);
+  REQUIRE(loose.samples < 60);
+  REQUIRE(loose.lower <= exact.visibleFraction);
+  REQUIRE(loose.upper >= exact.visibleFraction);
+}
+
+TEST_CASE("Swept visibility matches point analysis along a peek path", "[visibility]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{20,20}});
+  scene.map.addObstacle(AABB{Vec2{6,4}, Vec2{8,12}});
+  scene.map.addObstacle(AABB{Vec2{11,13}, Vec2{12,14}});
+  scene.map.addObstacle(AABB{Vec2{2,14}, Vec2{3,15}});
+  scene.visibilitySamples = 32;
+  scene.enemy.pos = Vec2{15,8};
+  scene.enemy.radius = 0.6;
+
+  // Start behind the wall, step out past its top, then walk away.
+  const std::vector<Vec2> path{Vec2{4,6}, Vec2{4,15}, Vec2{1,18}};
+  const double speed = 5.0;
+
+  VisibilityAnalyzer v;
+  const auto swept = v.sweep(scene, path, speed, scene.enemy);
+  REQUIRE(swept.events.size() >= 3);
+  REQUIRE(swept.events.front().visibleFraction == 0.0);
+  REQUIRE(swept.firstVisibleTime > 0.0);
+  REQUIRE(swept.firstFullTime >= swept.firstVisibleTime);
+  REQUIRE(swept.visibleTime > 0.0);
+  REQUIRE(swept.visibleTime < swept.duration);
+
+  auto positionAt = [&](double time) {
+    double left = time * speed;
+    for (std::size_t i = 0; i + 1 < path.size(); ++i) {
+      const double len = dist(path[i], path[i + 1]);
+      if (left <= len) return path[i] + (path[i + 1] - path[i]) * (left / len);
+      left -= len;
+    }
+    return path.back();
+  };
+
+  int checked = 0;
+  for (int i = 0; i <= 400; ++i) {
+    const double time = swept.duration * i / 400.0;
+    bool nearEvent = false;
+    for (const auto& e : swept.events) nearEvent = nearEvent || std::abs(e.time - time) < 1e-6;
+    if (nearEvent) continue;
+    const auto point = v.analyze(scene, positionAt(time), scene.enemy);
+    REQUIRE_THAT(swept.fractionAt(time), Catch::Matchers::WithinAbs(point.visibleFraction, 1e-12));
+    checked++;
+  }
+  REQUIRE(checked > 390);
+
+  // Just before and after first sight.
+  REQUIRE(v.analyze(scene, positionAt(swept.firstVisibleTime - 1e-4), scene.enemy).visibleCount == 0);
+  REQUIRE(v.analyze(scene, positionAt(swept.firstVisibleTime + 1e-4), scene.enemy).visibleCount > 0);
+}
+
+TEST_CASE("Swept visibility of a path leaving the world", "[visibility]") {
+  Scene scene;
+  scene.map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  scene.enemy.pos = Vec2{5,5};
+  scene.enemy.radius = 0.5;
+
+  VisibilityAnalyzer v;
+  const auto swept = v.sweep(scene, {Vec2{2,2}, Vec2{-2,2}}, 1.0, scene.enemy);
+  REQUIRE(swept.duration == 4.0);
+  REQUIRE(swept.fractionAt(1.0) == 1.0);
+  REQUIRE(swept.fractionAt(3.0) == 0.0);
+  REQUIRE_THAT(swept.visibleTime, Catch::Matchers::WithinAbs(2.0, 1e-12));
+
+  const auto still = v.sweep(scene, {Vec2{2,2}}, 1.0, scene.enemy);
+  REQUIRE(still.events.size() == 1);
+  REQUIRE(still.events[0].visibleFraction == 1.0);
+}
@@ -0,0 +1,183 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "core/Map.hpp"
+#include "core/VisibilityMatrix.hpp"
+#include "geom/AABB.hpp"
+
+namespace {
+
+Map testMap() {
+  Map map;
+  map.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,10}});
+  map.addObstacle(AABB{Vec2{4.5, 0.0}, Vec2{5.5, 4.0}});
+  map.addObstacle(AABB{Vec2{4.5, 6.0}, Vec2{5.5, 10.0}});
+  map.addObstacle(AABB{Vec2{1.0, 7.0}, Vec2{3.0, 8.0}});
+  return map;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Visibility matrix matches exact raycasts between cell centres", "[pvs]") {
+  const Map map = testMap();
+  auto pvs = VisibilityMatrix::build(map, 0.5);
+  REQUIRE(pvs != nullptr);
+  REQUIRE(pvs->cols() == 20);
+  REQUIRE(pvs->rows() == 20);
+  REQUIRE(pvs->freeCount() > 0);
+  REQUIRE(pvs->freeCount() < 400);
+
+  // Runs compress: far fewer spans than visible pairs
+  std::size_t visiblePairs = 0;
+  for (int a = 0; a < pvs->freeCount(); ++a) {
+    for (auto word : pvs->rowMask(a)) visiblePairs += static_cast<std::size_t>(std::popcount(word));
+  }
+  REQUIRE(pvs->spanCount() * 4 < visiblePairs);
+
+  for (int a = 0; a < pvs->freeCount(); a += 7) {
+    for (int b = 0; b < pvs->freeCount(); b += 3) {
+      REQUIRE(pvs->visible(a, b) == map.hasLineOfSight(pvs->cellCenter(a), pvs->cellCenter(b)));
+    }
+  }
+}
+
+TEST_CASE("Row masks count visible targets with AND + popcount", "[pvs]") {
+  const Map map = testMap();
+  auto pvs = VisibilityMatrix::build(map, 0.5);
+
+  // Every third free cell is a target
+  std::vector<std::uint64_t> targets((pvs->freeCount() + 63) / 64, 0);
+  for (int i = 0; i < pvs->freeCount(); i += 3) targets[i / 64] |= (1ULL << (i % 64));
+
+  for (int a = 0; a < pvs->freeCount(); a += 11) {
+    int expected = 0;
+    for (int i = 0; i < pvs->freeCount(); i += 3) expected += pvs->visible(a, i) ? 1 : 0;
+    REQUIRE(pvs->countVisible(a, targets) == expected);
+
+    const auto row = pvs->rowMask(a);
+    for (int i = 0; i < pvs->freeCount(); i += 5) {
+      REQUIRE(((row[i / 64] >> (i % 64)) & 1ULL) == (pvs->visible(a, i) ? 1ULL : 0ULL));
+    }
+  }
+}
+
+TEST_CASE("Visibility matrix round-trips through a mapped file", "[pvs]") {
+  const Map map = testMap();
+  auto built = VisibilityMatrix::build(map, 0.5);
+
+  const auto path = std::filesystem::temp_directory_path() / "fps_engine_test.pvs";
+  REQUIRE(built->save(path.string()));
+
+  auto loaded = VisibilityMatrix::load(path.string());
+  REQUIRE(loaded != nullptr);
+  REQUIRE(loaded->byteSize() == built->byteSize());
+  REQUIRE(loaded->freeCount() == built->freeCount());
+  for (int a = 0; a < built->freeCount(); a += 13) {
+    for (int b = 0; b < built->freeCount(); b += 5) {
+      REQUIRE(loaded->visible(a, b) == built->visible(a, b));
+    }
+  }
+
+  loaded.reset();
+  std::filesystem::remove(path);
+  REQUIRE(VisibilityMatrix::load(path.string()) == nullptr);
+}
+
+TEST_CASE("Loading refuses files whose tables point out of range", "[pvs]") {
+  const Map map = testMap();
+  auto built = VisibilityMatrix::build(map, 0.5);
+  const auto path = std::filesystem::temp_directory_path() / "fps_engine_test_corrupt.pvs";
+  REQUIRE(built->save(path.string()));
+
+  std::vector<char> bytes;
+  {
+    std::ifstream in(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  REQUIRE(bytes.size() == built->byteSize());
+
+  // Same size and magic, one 32-bit field overwritten at a time.
+  const auto loadWith = [&](std::size_t offset, std::uint32_t value) {
+    std::vector<char> copy = bytes;
+    std::memcpy(copy.data() + offset, &value, sizeof(value));
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out.write(copy.data(), static_cast<std::streamsize>(copy.size()));
+    }
+    return VisibilityMatrix::load(path.string());
+  };
+  const std::size_t spans = bytes.size() - built->spanCount() * sizeof(VisibilityMatrix::Span);
+  const std::size_t lastOffset = spans - sizeof(std::uint32_t); // rowOffsets[freeCount]
+  const std::size_t cellTable = spans - (2 * built->freeCount() + 1) * sizeof(std::uint32_t)
+                              - static_cast<std::size_t>(built->cols()) * built->rows() * sizeof(std::int32_t);
+
+  REQUIRE(loadWith(spans, 0) != nullptr);                                  // row 0 sees cell 0: unchanged
+  REQUIRE(loadWith(spans, 0xFFFFFFu) == nullptr);                          // span start out of range
+  REQUIRE(loadWith(spans + sizeof(std::uint32_t), 0xFFFFFFu) == nullptr);  // span length out of range
+  REQUIRE(loadWith(spans + sizeof(std::uint32_t), 0) == nullptr);          // empty span
+  REQUIRE(loadWith(lastOffset, 0) == nullptr);                             // offsets end short of spanCount
+  REQUIRE(loadWith(lastOffset - sizeof(std::uint32_t), 0xFFFFFFu) == nullptr); // offsets not monotonic
+  REQUIRE(loadWith(cellTable, 0x7FFFFFFFu) == nullptr);                    // cellToFree out of range
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Map answers LoS from the matrix and falls back off-grid", "[pvs]") {
+  const Map reference = testMap();
+  Map map = testMap();
+  map.setVisibilityMatrix(VisibilityMatrix::build(map, 0.5));
+  REQUIRE(map.visibilityMatrix() != nullptr);
+
+  const auto& pvs = *map.visibilityMatrix();
+  REQUIRE(map.hasLineOfSight(pvs.cellCenter(0), pvs.cellCenter(pvs.freeCount() - 1)) ==
+          reference.hasLineOfSight(pvs.cellCenter(0), pvs.cellCenter(pvs.freeCount() - 1)));
+
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> coord(0.0, 10.0);
+  for (int i = 0; i < 500; ++i) {
+    const Vec2 a{coord(rng), coord(rng)};
+    const Vec2 b{coord(rng), coord(rng)};
+    REQUIRE(map.hasLineOfSight(a, b) == reference.hasLineOfSight(a, b));
+  }
+
+  // Editing geometry detaches the now-stale matrix
+  map.addObstacle(AABB{Vec2{7,7}, Vec2{8,8}});
+  REQUIRE(map.visibilityMatrix() == nullptr);
+}
+
+TEST_CASE("A matrix only attaches to the map it was built for", "[pvs]") {
+  const auto path = std::filesystem::temp_directory_path() / "fps_engine_test_foreign.pvs";
+  REQUIRE(VisibilityMatrix::build(testMap(), 0.5)->save(path.string()));
+  const auto loaded = VisibilityMatrix::load(path.string());
+  REQUIRE(loaded != nullptr);
+
+  Map same = testMap();
+  REQUIRE(loaded->builtFor(same));
+  REQUIRE(same.setVisibilityMatrix(loaded));
+  REQUIRE(same.visibilityMatrix() == loaded);
+
+  Map moved = testMap();
+  moved.setObstacle(2, AABB{Vec2{1.0, 7.5}, Vec2{3.0, 8.5}}); // same bounds and cell grid
+  REQUIRE_FALSE(moved.setVisibilityMatrix(loaded));
+  REQUIRE(moved.visibilityMatrix() == nullptr);
+
+  Map shifted = testMap();
+  shifted.setWorldBounds(AABB{Vec2{0,0}, Vec2{10,12}});
+  REQUIRE_FALSE(shifted.setVisibilityMatrix(loaded));
+
+  // A refused matrix leaves the attached one in place.
+  REQUIRE_FALSE(same.setVisibilityMatrix(VisibilityMatrix::build(moved, 0.5)));
+  REQUIRE(same.visibilityMatrix() == loaded);
+  REQUIRE(same.setVisibilityMatrix(nullptr));
+  REQUIRE(same.visibilityMatrix() == nullptr);
+
+  std::filesystem::remove(path);
+}
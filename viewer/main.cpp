@@ -7,7 +7,7 @@
 #include <vector>
 
 #include "core/Scene.hpp"
-#include "analysis/SceneAnalyzer.hpp"
+#include "analysis/AnalysisWorker.hpp"
 #include "geom/AABB.hpp"
 #include "geom/Vec2.hpp"
 
@@ -212,43 +212,7 @@ static void drawObstacleHandles(const Viewport& vp, const AABB& ob) {
 }
 
 
-// ====================== FOV occlusion raycasting + drawing ======================
-static double raycastRayToAABB(const Vec2& ro, const Vec2& rdUnit, const AABB& b) {
-  const double INF = std::numeric_limits<double>::infinity();
-
-  double tmin = 0.0;
-  double tmax = INF;
-
-  auto slab = [&](double roC, double rdC, double minC, double maxC) -> bool {
-    if (std::abs(rdC) < 1e-12) {
-      return (roC >= minC && roC <= maxC);
-    }
-    double t1 = (minC - roC) / rdC;
-    double t2 = (maxC - roC) / rdC;
-    if (t1 > t2) std::swap(t1, t2);
-    tmin = std::max(tmin, t1);
-    tmax = std::min(tmax, t2);
-    return tmin <= tmax;
-  };
-
-  if (!slab(ro.x, rdUnit.x, b.min.x, b.max.x)) return INF;
-  if (!slab(ro.y, rdUnit.y, b.min.y, b.max.y)) return INF;
-
-  if (tmax < 0.0) return INF;
-  if (tmin < 0.0) return 0.0;
-  return tmin;
-}
-
-static double raycastToObstacles(const Map& map, const Vec2& origin, const Vec2& dirUnit, double maxRange) {
-  double best = maxRange;
-
-  for (const auto& ob : map.obstacles()) {
-    double t = raycastRayToAABB(origin, dirUnit, ob);
-    if (t >= 0.0 && t < best) best = t;
-  }
-  return best;
-}
-
+// ====================== FOV occlusion drawing ======================
 static void drawFovConeOccluded(
     const Viewport& vp,
     const Scene& scene,
@@ -266,13 +230,8 @@ static void drawFovConeOccluded(
   std::vector<Vec2> ptsW;
   ptsW.reserve(segments + 1);
 
-  for (int i = 0; i <= segments; ++i) {
-    const double t = (double)i / (double)segments;
-    const double ang = base - half + (2.0 * half * t);
-
-    Vec2 dir{ std::cos(ang), std::sin(ang) };
-    double d = raycastToObstacles(scene.map, a.pos, dir, maxRange);
-    ptsW.push_back(a.pos + dir * d);
+  for (const RayHit& hit : scene.map.fanCast(a.pos, base - half, base + half, segments + 1, maxRange)) {
+    ptsW.push_back(hit.point);
   }
 
   Vector2 cS = vp.worldToScreen(a.pos);
@@ -384,6 +343,7 @@ int main() {
   scene.T = 0.30;
   scene.cellSize = 0.5;
   scene.visibilitySamples = 64;
+  scene.fovDegrees = 90.0;
 
   scene.self.pos = Vec2{2,2};
   scene.self.radius = 0.25;
@@ -403,8 +363,8 @@ int main() {
   vp.x0 = 0;
   vp.computeScale();
 
-  // --- Analyzer ---
-  SceneAnalyzer analyzer;
+  // --- Analyzer (background; last result stays on screen until a newer one lands) ---
+  AnalysisWorker worker;
   AnalysisResult result;
   bool dirty = true;
 
@@ -413,7 +373,6 @@ int main() {
   bool showReachEnemy = true;
 
   // --- UI state ---
-  double fovDeg = 90.0;
   bool draggingFov = false;
 
   // --- Obstacle creation ---
@@ -430,9 +389,12 @@ int main() {
   while (!WindowShouldClose()) {
     // ====================== Analyze (on demand) ======================
     if (dirty) {
-      result = analyzer.analyze(scene);
+      worker.submit(scene);
       dirty = false;
     }
+    if (auto fresh = worker.poll()) {
+      result = std::move(*fresh);
+    }
 
     // ====================== Input ======================
     Vector2 mouseS = GetMousePosition();
@@ -473,7 +435,7 @@ int main() {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON) && draggingFov) {
       float t = (mouseS.x - fovTrack.x) / fovTrack.width;
       t = std::clamp(t, 0.0f, 1.0f);
-      fovDeg = FOV_MIN + t * (FOV_MAX - FOV_MIN);
+      scene.fovDegrees = FOV_MIN + t * (FOV_MAX - FOV_MIN);
       dirty = true;
     }
     if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
@@ -638,8 +600,8 @@ int main() {
     }
 
     // FOV cones
-    drawFovConeOccluded(vp, scene, scene.self,  fovDeg, 8.0, Color{0,140,255,35},   Color{0,140,255,120});
-    drawFovConeOccluded(vp, scene, scene.enemy, fovDeg, 8.0, Color{255,80,80,30},   Color{255,80,80,120});
+    drawFovConeOccluded(vp, scene, scene.self,  scene.fovDegrees, 8.0, Color{0,140,255,35},   Color{0,140,255,120});
+    drawFovConeOccluded(vp, scene, scene.enemy, scene.fovDegrees, 8.0, Color{255,80,80,30},   Color{255,80,80,120});
 
     // Agents + facing handles
     drawAgent(vp, scene.self,  Color{0, 140, 255, 220}, BLUE);
@@ -669,11 +631,11 @@ int main() {
     DrawRectangleRec(fovTrack, LIGHTGRAY);
     DrawRectangleLinesEx(fovTrack, 1, DARKGRAY);
 
-    float knobT = (float)((fovDeg - FOV_MIN) / (FOV_MAX - FOV_MIN));
+    float knobT = (float)((scene.fovDegrees - FOV_MIN) / (FOV_MAX - FOV_MIN));
     float knobX = fovTrack.x + knobT * fovTrack.width;
     DrawCircle((int)knobX, (int)(fovTrack.y + fovTrack.height / 2), 7, DARKBLUE);
 
-    DrawText(TextFormat("%.0f°", fovDeg), VIEW_W + 16, FOV_SLIDER_Y + 24, 16, DARKGRAY);
+    DrawText(TextFormat("%.0f°", scene.fovDegrees), VIEW_W + 16, FOV_SLIDER_Y + 24, 16, DARKGRAY);
 
     // Analysis text
     {
@@ -682,6 +644,9 @@ int main() {
                          "  visSamples=" + std::to_string(scene.visibilitySamples);
       DrawText(line.c_str(), x, y, 18, BLACK); y += 24;
     }
+    if (worker.pending()) {
+      DrawText("Recomputing...", x, y, 16, ORANGE); y += 20;
+    }
     {
       std::string line = "Reachable Area Ratio: " + std::to_string(result.reachability.areaRatio);
       DrawText(line.c_str(), x, y, 18, BLACK); y += 22;